@@ -27,8 +27,27 @@ common:
 
 	# Source files
 	ADDON_SOURCES = src/ofxLlamaCpp.cpp
+	ADDON_SOURCES += src/AdmissionControlProvider.cpp
 	ADDON_SOURCES += src/IInferenceProvider.cpp
+	ADDON_SOURCES += src/InferenceLoadTest.cpp
+	ADDON_SOURCES += src/InferenceLog.cpp
+	ADDON_SOURCES += src/InferenceResponseCache.cpp
+	ADDON_SOURCES += src/InferenceWorkerProcess.cpp
+	ADDON_SOURCES += src/LlamaOpenAIServer.cpp
+	ADDON_SOURCES += src/LocalHttpServer.cpp
+	ADDON_SOURCES += src/MockOpenAIServer.cpp
+	ADDON_SOURCES += src/OutOfProcessProvider.cpp
+	ADDON_SOURCES += src/RecordingProvider.cpp
 	ADDON_SOURCES += src/RemoteAPIProvider.cpp
+	ADDON_SOURCES += src/RemoteHttpClient.cpp
+	ADDON_SOURCES += src/RemoteHttpConnectionPool.cpp
+	ADDON_SOURCES += src/RemoteModelCatalog.cpp
+	ADDON_SOURCES += src/RemoteRateLimiter.cpp
+	ADDON_SOURCES += src/ReplayProvider.cpp
+	ADDON_SOURCES += src/RoutingProvider.cpp
+	ADDON_SOURCES += src/SharedTokenRing.cpp
+	ADDON_SOURCES += src/TokenBroadcastReceiver.cpp
+	ADDON_SOURCES += src/TokenBroadcaster.cpp
 	ADDON_SOURCES += src/BackendSelector.cpp
 	ADDON_SOURCES += libs/llama.cpp/ggml/src/gguf.cpp
 	ADDON_SOURCES += libs/llama.cpp/ggml/src/ggml-opt.cpp
@@ -54,16 +73,20 @@ linux64:
 	OFX_LLAMACPP_CUDA_LIB_DIR_2 ?= $(OFX_LLAMACPP_CUDA_HOME)/lib64
 	OFX_LLAMACPP_CUDART_DIR ?= $(shell ldconfig -p 2>/dev/null | awk '/libcudart\.so/{print $$NF; exit}' | xargs -r dirname)
 	OFX_LLAMACPP_CUBLAS_DIR ?= $(shell ldconfig -p 2>/dev/null | awk '/libcublas\.so/{print $$NF; exit}' | xargs -r dirname)
+	# RPC workers are available when build_llama_static.sh ran with --rpc.
+	OFX_LLAMACPP_USE_RPC ?= $(if $(wildcard $(OF_ADDONS_PATH)/ofxLlamaCpp/libs/llama.cpp/lib/linux64/libggml-rpc.a),1,0)
 
 	# any special flag that should be passed to the linker when using this addon, also used for system libraries with -lname
-	ADDON_LDFLAGS = -lpthread -fopenmp
+	ADDON_LDFLAGS = -lpthread -lrt -fopenmp
 	ADDON_INCLUDES += libs/minja/include
 	ADDON_LIBS = libs/llama.cpp/lib/linux64/libllama.a
+	ADDON_LIBS += $(if $(filter 1,$(OFX_LLAMACPP_USE_RPC)),libs/llama.cpp/lib/linux64/libggml-rpc.a)
 	ADDON_LIBS += libs/llama.cpp/lib/linux64/libggml.a
 	ADDON_LIBS += libs/llama.cpp/lib/linux64/libggml-cpu.a
 	ADDON_LIBS += libs/llama.cpp/lib/linux64/libggml-base.a
 	ADDON_LIBS += libs/llama.cpp/lib/linux64/libmtmd.a
 	ADDON_CPPFLAGS += $(if $(filter 1,$(OFX_LLAMACPP_USE_CUDA)),-DOFX_LLAMACPP_USE_CUDA)
+	ADDON_CPPFLAGS += $(if $(filter 1,$(OFX_LLAMACPP_USE_RPC)),-DOFX_LLAMACPP_USE_RPC)
 	ADDON_LIBS += $(if $(filter 1,$(OFX_LLAMACPP_USE_CUDA)),libs/llama.cpp/lib/linux64/libggml-cuda.a)
 	ADDON_LIBS += $(if $(filter 1,$(OFX_LLAMACPP_USE_CUDA)),libs/llama.cpp/lib/linux64/libggml-blas.a)
 	ADDON_LDFLAGS += $(if $(filter 1,$(OFX_LLAMACPP_USE_CUDA)),-L$(OFX_LLAMACPP_CUDA_LIB_DIR_1) -L$(OFX_LLAMACPP_CUDA_LIB_DIR_2) -L$(OFX_LLAMACPP_CUDART_DIR) -L$(OFX_LLAMACPP_CUBLAS_DIR))
@@ -74,11 +97,14 @@ linuxaarch64:
 	LLAMA_LIB_PATH = libs/llama.cpp/lib/linuxaarch64
 
 	# aarch64 builds are CPU-first by default.
-	ADDON_LDFLAGS = -lpthread -fopenmp
+	ADDON_LDFLAGS = -lpthread -lrt -fopenmp
 	ADDON_INCLUDES += libs/minja/include
+	OFX_LLAMACPP_USE_RPC ?= $(if $(wildcard $(OF_ADDONS_PATH)/ofxLlamaCpp/$(LLAMA_LIB_PATH)/libggml-rpc.a),1,0)
+	ADDON_CPPFLAGS += $(if $(filter 1,$(OFX_LLAMACPP_USE_RPC)),-DOFX_LLAMACPP_USE_RPC)
 
 	# Static libraries for linuxaarch64 - ORDER MATTERS!
 	ADDON_LIBS = $(LLAMA_LIB_PATH)/libllama.a
+	ADDON_LIBS += $(if $(filter 1,$(OFX_LLAMACPP_USE_RPC)),$(LLAMA_LIB_PATH)/libggml-rpc.a)
 	ADDON_LIBS += $(LLAMA_LIB_PATH)/libggml-cpu.a
 	ADDON_LIBS += $(LLAMA_LIB_PATH)/libggml.a
 	ADDON_LIBS += $(LLAMA_LIB_PATH)/libggml-base.a
@@ -92,12 +118,15 @@ osx:
 	# Compiler flags for macOS to enable Metal and Accelerate
 	ADDON_INCLUDES += libs/minja/include
 	ADDON_CPPFLAGS += -DGGML_USE_METAL -DGGML_METAL_NDEBUG -DGGML_USE_ACCELERATE
+	OFX_LLAMACPP_USE_RPC ?= $(if $(wildcard $(OF_ADDONS_PATH)/ofxLlamaCpp/$(LLAMA_LIB_PATH)/libggml-rpc.a),1,0)
+	ADDON_CPPFLAGS += $(if $(filter 1,$(OFX_LLAMACPP_USE_RPC)),-DOFX_LLAMACPP_USE_RPC)
 
 	# Linker flags for macOS
 	ADDON_LDFLAGS += -ObjC
 
 	# Static libraries for macOS - ORDER MATTERS!
 	ADDON_LIBS += $(LLAMA_LIB_PATH)/libllama.a
+	ADDON_LIBS += $(if $(filter 1,$(OFX_LLAMACPP_USE_RPC)),$(LLAMA_LIB_PATH)/libggml-rpc.a)
 	ADDON_LIBS += $(LLAMA_LIB_PATH)/libggml-metal.a
 	ADDON_LIBS += $(LLAMA_LIB_PATH)/libggml-blas.a
 	ADDON_LIBS += $(LLAMA_LIB_PATH)/libggml-cpu.a
@@ -122,8 +151,27 @@ vs:
 
 	# On Windows we only compile the addon wrapper and link the prebuilt libs.
 	ADDON_SOURCES = src/ofxLlamaCpp.cpp
+	ADDON_SOURCES += src/AdmissionControlProvider.cpp
 	ADDON_SOURCES += src/IInferenceProvider.cpp
+	ADDON_SOURCES += src/InferenceLoadTest.cpp
+	ADDON_SOURCES += src/InferenceLog.cpp
+	ADDON_SOURCES += src/InferenceResponseCache.cpp
+	ADDON_SOURCES += src/InferenceWorkerProcess.cpp
+	ADDON_SOURCES += src/LlamaOpenAIServer.cpp
+	ADDON_SOURCES += src/LocalHttpServer.cpp
+	ADDON_SOURCES += src/MockOpenAIServer.cpp
+	ADDON_SOURCES += src/OutOfProcessProvider.cpp
+	ADDON_SOURCES += src/RecordingProvider.cpp
 	ADDON_SOURCES += src/RemoteAPIProvider.cpp
+	ADDON_SOURCES += src/RemoteHttpClient.cpp
+	ADDON_SOURCES += src/RemoteHttpConnectionPool.cpp
+	ADDON_SOURCES += src/RemoteModelCatalog.cpp
+	ADDON_SOURCES += src/RemoteRateLimiter.cpp
+	ADDON_SOURCES += src/ReplayProvider.cpp
+	ADDON_SOURCES += src/RoutingProvider.cpp
+	ADDON_SOURCES += src/SharedTokenRing.cpp
+	ADDON_SOURCES += src/TokenBroadcastReceiver.cpp
+	ADDON_SOURCES += src/TokenBroadcaster.cpp
 	ADDON_SOURCES += src/BackendSelector.cpp
 
 	ADDON_LIBS += libs/llama.cpp/lib/vs/$(Configuration)/llama.lib
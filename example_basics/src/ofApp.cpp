@@ -34,6 +34,13 @@ void ofApp::setup() {
 
 //--------------------------------------------------------------
 void ofApp::update() {
+    if (pendingRemoteReply.valid() &&
+        pendingRemoteReply.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        const std::string result = pendingRemoteReply.get();
+        setOutput(result);
+        setStatus(result.empty() ? "Generation finished with empty output." : "Generation finished.");
+        generating = false;
+    }
 }
 
 //--------------------------------------------------------------
@@ -508,13 +515,23 @@ void ofApp::startPrompt() {
     setStatus("Generating with " + getBackendName() + "...");
     generating = true;
 
-    worker = std::thread([this]() {
+    if (remoteProvider) {
+        pendingRemoteReply = remoteProvider->generateAsync(prompt);
+        return;
+    }
+
+    generationCancel = std::make_shared<InferenceCancellationToken>();
+    worker = std::thread([this, cancel = generationCancel]() {
         std::string requestPrompt = prompt;
         if (!provider->isRemote() && !remoteSystemPrompt.empty()) {
             requestPrompt = remoteSystemPrompt + "\n\n" + prompt;
         }
 
-        const std::string result = provider->generate(requestPrompt);
+        // Stream pieces into the output so the reply appears while it is generated.
+        const std::string result = provider->generateStream(requestPrompt, [this](const std::string& piece) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            output += piece;
+        }, cancel);
         setOutput(result);
         setStatus(result.empty() ? "Generation finished with empty output." : "Generation finished.");
         generating = false;
@@ -523,10 +540,16 @@ void ofApp::startPrompt() {
 
 //--------------------------------------------------------------
 void ofApp::stopWorker() {
+    if (generationCancel) {
+        generationCancel->cancel();
+        generationCancel.reset();
+    }
+
     if (worker.joinable()) {
         worker.join();
     }
 
+    pendingRemoteReply = std::future<std::string>();
     generating = false;
 }
 
@@ -15,6 +15,7 @@
 #include "RemoteAPIProvider.h"
 
 #include <atomic>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -110,6 +111,9 @@ private:
     bool remoteStripReasoning = true;
 
     // The generation worker keeps blocking inference off the main OF thread.
+    // Remote prompts use the provider's async API instead and are polled in update().
     std::thread worker;
+    std::shared_ptr<InferenceCancellationToken> generationCancel;
+    std::future<std::string> pendingRemoteReply;
     mutable std::mutex stateMutex;
 };
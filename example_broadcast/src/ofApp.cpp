@@ -0,0 +1,213 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "ofApp.h"
+
+//--------------------------------------------------------------
+ofApp::~ofApp() {
+    if (sender) {
+        llama.stopGeneration();
+        broadcaster.close();
+    } else {
+        receiver.stop();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+    ofBackground(0);
+    ofSetFrameRate(60);
+
+    loadConfigFromFile();
+
+    if (sender) {
+        setupSender();
+        return;
+    }
+
+    receiver.setReorderWindow(reorderWindowMs / 1000.0f);
+    if (!receiver.start(address, port, interfaceAddress)) {
+        ofLogError("example_broadcast") << "Cannot receive on " << address << ":" << port;
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::setupSender() {
+    ofDirectory modelsDir(ofToDataPath("models"));
+    modelsDir.allowExt("gguf");
+    modelsDir.listDir();
+    modelsDir.sort();
+    if (modelsDir.size() == 0) {
+        status = "No .gguf model found in data/models.";
+        return;
+    }
+
+    if (!llama.loadModel(modelsDir.getPath(0))) {
+        status = "Failed to load " + modelsDir.getName(0);
+        return;
+    }
+    llama.addStopWord("User:");
+
+    broadcaster.setRedundancy(static_cast<std::size_t>(std::max(0, redundancy)));
+    if (!broadcaster.open(address, port, ttl, interfaceAddress)) {
+        status = "Cannot send to " + address + ":" + ofToString(port);
+        return;
+    }
+    // Every token of every generation goes out from the generation thread.
+    broadcaster.attach(llama);
+    // The local view gets the same tokens on the main thread, within a
+    // small budget per frame.
+    llama.setEventDelivery(true);
+    ofAddListener(llama.tokenEvent, this, &ofApp::onToken);
+    ofAddListener(llama.finishEvent, this, &ofApp::onFinish);
+
+    status = "Type a prompt and press Enter.";
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+    if (sender) {
+        return; // The reply arrives through onToken().
+    }
+
+    // The receiver keeps the text itself, the events are only needed for
+    // effects that react to single tokens.
+    receiver.poll();
+    receivedText = receiver.getText();
+}
+
+//--------------------------------------------------------------
+void ofApp::onToken(std::string& piece) {
+    reply += piece;
+}
+
+//--------------------------------------------------------------
+void ofApp::onFinish() {
+    status = "Done. Type a prompt and press Enter.";
+}
+
+//--------------------------------------------------------------
+void ofApp::draw() {
+    if (sender) {
+        drawSender();
+    } else {
+        drawReceiver();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::drawSender() {
+    const float margin = 20.0f;
+
+    ofSetColor(170);
+    ofDrawBitmapString("Sender to " + address + ":" + ofToString(port) + ", "
+                       + ofToString(broadcaster.getPacketsSent()) + " packets, "
+                       + ofToString(ofGetFrameRate(), 0) + " fps", margin, 30);
+    ofDrawBitmapString("Enter: send   Tab: stop", margin, 50);
+    ofDrawBitmapString(status, margin, 70);
+
+    ofSetColor(255);
+    ofDrawBitmapString("> " + input, margin, 110);
+    ofDrawBitmapString(wrapText(reply, ofGetWidth() - margin * 2.0f), margin, 140);
+}
+
+//--------------------------------------------------------------
+void ofApp::drawReceiver() {
+    const float margin = 20.0f;
+    const TokenBroadcastStats stats = receiver.getStats();
+
+    ofSetColor(170);
+    ofDrawBitmapString("Receiver on " + address + ":" + ofToString(port)
+                       + (receiver.isGenerating() ? ", generating" : ", idle"), margin, 30);
+    ofDrawBitmapString("packets " + ofToString(stats.packets)
+                       + "  duplicates " + ofToString(stats.duplicates)
+                       + "  reordered " + ofToString(stats.reordered)
+                       + "  lost " + ofToString(stats.lost)
+                       + "  repaired " + ofToString(stats.repaired), margin, 50);
+
+    ofSetColor(255);
+    ofDrawBitmapString(wrapText(receivedText, ofGetWidth() - margin * 2.0f), margin, 90);
+}
+
+//--------------------------------------------------------------
+void ofApp::keyPressed(ofKeyEventArgs& args) {
+    if (!sender) {
+        return;
+    }
+
+    if (args.key == OF_KEY_TAB) {
+        llama.stopGeneration();
+        return;
+    }
+
+    if (args.key == OF_KEY_RETURN) {
+        if (!input.empty() && broadcaster.isOpen() && !llama.isGenerating()) {
+            reply.clear();
+            llama.startGeneration("User: " + input + "\nAssistant:");
+            status = "Generating and broadcasting...";
+            input.clear();
+        }
+        return;
+    }
+
+    if (args.key == OF_KEY_BACKSPACE) {
+        if (!input.empty()) {
+            input.pop_back();
+        }
+        return;
+    }
+
+    if (args.key >= 32 && args.key < 127) {
+        input += static_cast<char>(args.key);
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::loadConfigFromFile() {
+    const std::string configPath = ofToDataPath("broadcast_config.json");
+    if (!ofFile::doesFileExist(configPath)) {
+        ofLogNotice("example_broadcast") << "broadcast_config.json not found, running as receiver.";
+        return;
+    }
+
+    try {
+        const ofJson config = ofLoadJson(configPath);
+        sender = config.value("role", std::string("receiver")) == "sender";
+        address = config.value("address", address);
+        port = config.value("port", port);
+        interfaceAddress = config.value("interface", interfaceAddress);
+        ttl = config.value("ttl", ttl);
+        redundancy = config.value("redundancy", redundancy);
+        reorderWindowMs = config.value("reorder_window_ms", reorderWindowMs);
+    } catch (const std::exception& exception) {
+        ofLogError("example_broadcast") << "Failed to load broadcast_config.json: " << exception.what();
+    }
+}
+
+//--------------------------------------------------------------
+std::string ofApp::wrapText(const std::string& text, float width) const {
+    // The bitmap font is 8 pixels wide per character.
+    const std::size_t columns = std::max<std::size_t>(1, static_cast<std::size_t>(width / 8.0f));
+    std::string wrapped;
+    std::size_t column = 0;
+    for (char c : text) {
+        if (c == '\n' || column >= columns) {
+            wrapped += '\n';
+            column = 0;
+            if (c == '\n') {
+                continue;
+            }
+        }
+        wrapped += c;
+        ++column;
+    }
+    return wrapped;
+}
@@ -0,0 +1,60 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLlamaCpp.h"
+#include "TokenBroadcaster.h"
+#include "TokenBroadcastReceiver.h"
+
+// Shows the same generated text on several machines. One machine runs as
+// "sender": it generates with a local model and multicasts every token.
+// The projector machines run as "receiver" and display the stream.
+// The role and network settings come from data/broadcast_config.json.
+class ofApp : public ofBaseApp {
+public:
+    ~ofApp();
+
+    void setup();
+    void update();
+    void draw();
+    void keyPressed(ofKeyEventArgs& args);
+
+    // Sender: generated text, delivered on the main thread.
+    void onToken(std::string& piece);
+    void onFinish();
+
+private:
+    void loadConfigFromFile();
+    void setupSender();
+    void drawSender();
+    void drawReceiver();
+    std::string wrapText(const std::string& text, float width) const;
+
+    bool sender = false;
+    std::string address = "239.255.42.99";
+    int port = 9099;
+    std::string interfaceAddress;
+    int ttl = 1;
+    int redundancy = 2;
+    int reorderWindowMs = 50;
+
+    // Sender
+    ofxLlamaCpp llama;
+    TokenBroadcaster broadcaster;
+    std::string input;
+    std::string reply;
+    std::string status;
+
+    // Receiver
+    TokenBroadcastReceiver receiver;
+    std::string receivedText;
+};
@@ -16,6 +16,9 @@
 ChatUI::ChatUI() {
     // Initialize all layout-related constants to default values.
     yOffset = 0;
+    scrollbarShown = false;
+    positionedCount = 0;
+    layoutWidth = -1;
     chatAreaOuterPadding = 20;
     chatAreaBottomOffset = 110;
     textInnerPadding = 30;
@@ -27,6 +30,10 @@ ChatUI::ChatUI() {
 void ChatUI::setup(const std::string& fontPath, int fontSize) {
     // Load the font for the UI. Anti-aliasing, full character set, and mipmaps are enabled for better rendering.
     font.load(fontPath, fontSize, true, true, true);
+    // Cached layouts were measured with the previous font.
+    layouts.clear();
+    messageTops.clear();
+    positionedCount = 0;
     ofLogNotice("ChatUI") << "UI setup complete, font loaded.";
 }
 
@@ -54,59 +61,30 @@ void ChatUI::draw(const ofRectangle& viewport,
 
     // --- Scrolling & Content Height Calculation ---
     // The height of all chat messages combined is calculated to determine if a scrollbar is necessary.
-    // This is a two-pass process:
-    // 1. Calculate a provisional height assuming no scrollbar.
-    // 2. If the provisional height exceeds the viewport, recalculate with a narrower width to account for the scrollbar.
-
-    // 1. Provisional calculation to determine if a scrollbar is needed.
-    float provisionalTextMaxWidth = chatArea.width - (2 * textInnerPadding);
-    float provisionalTotalContentHeight = textInnerPadding; // Start with top padding.
-    if (!history.empty()) {
-        for (size_t i = 0; i < history.size(); ++i) {
-            const auto& msg = history[i];
-            std::string role = msg.isUser ? "You: " : "LLM: ";
-            if (msg.content.rfind("[Summarized", 0) == 0) role = ""; // Don't add a role for summary messages.
-            std::string wrapped = wrapText(role + msg.content, provisionalTextMaxWidth);
-            provisionalTotalContentHeight += font.stringHeight(wrapped);
-            if (i < history.size() - 1) {
-                provisionalTotalContentHeight += interMessageSpacing;
-            }
-        }
-        provisionalTotalContentHeight += textInnerPadding; // Add bottom padding.
-    }
-
-    // 2. Based on the provisional height, determine the final text width.
+    // Wrapping is cached per message, so the width from the last frame is tried first and the
+    // messages are only wrapped again when the scrollbar appears or disappears.
     float viewportHeight = chatArea.height;
-    bool scrollbarNeeded = (provisionalTotalContentHeight > viewportHeight);
-    
-    float effectiveChatAreaWidth = chatArea.width;
-    if (scrollbarNeeded) {
-        effectiveChatAreaWidth -= (scrollbarWidth + scrollbarGap);
-    }
-    float textMaxWidth = effectiveChatAreaWidth - (2 * textInnerPadding);
-
-    // 3. Final calculation of total content height using the correct text width.
-    float totalContentHeight = textInnerPadding;
-    if (!history.empty()) {
-        for (size_t i = 0; i < history.size(); ++i) {
-            const auto& msg = history[i];
-            std::string role = msg.isUser ? "You: " : "LLM: ";
-            if (msg.content.rfind("[Summarized", 0) == 0) role = "";
-            std::string wrapped = wrapText(role + msg.content, textMaxWidth);
-            totalContentHeight += font.stringHeight(wrapped);
-            if (i < history.size() - 1) {
-                totalContentHeight += interMessageSpacing;
-            }
-        }
-        totalContentHeight += textInnerPadding;
+    float fullTextMaxWidth = chatArea.width - (2 * textInnerPadding);
+    float narrowTextMaxWidth = fullTextMaxWidth - (scrollbarWidth + scrollbarGap);
+
+    bool scrollbarNeeded = scrollbarShown;
+    float totalContentHeight = layoutMessages(history, scrollbarNeeded ? narrowTextMaxWidth : fullTextMaxWidth);
+    if (!scrollbarNeeded && totalContentHeight > viewportHeight) {
+        scrollbarNeeded = true;
+        totalContentHeight = layoutMessages(history, narrowTextMaxWidth);
+    } else if (scrollbarNeeded && totalContentHeight <= viewportHeight) {
+        // Wider lines never make the content taller, so it also fits without the scrollbar.
+        scrollbarNeeded = false;
+        totalContentHeight = layoutMessages(history, fullTextMaxWidth);
     }
+    scrollbarShown = scrollbarNeeded;
     
     // If there's no history, the content height is just the viewport height.
     if (history.empty()) {
         totalContentHeight = viewportHeight;
     }
 
-    // 4. Adjust and clamp the vertical scroll offset (yOffset).
+    // Adjust and clamp the vertical scroll offset (yOffset).
     // Automatically scroll to the bottom when the AI is generating a reply.
     if (appState == GENERATING_REPLY && totalContentHeight > viewportHeight) {
         yOffset = viewportHeight - totalContentHeight;
@@ -133,23 +111,27 @@ void ChatUI::draw(const ofRectangle& viewport,
     // Apply translation for scrolling.
     ofTranslate(chatArea.x + textInnerPadding, chatArea.y + yOffset);
 
-    // 3. Draw all chat messages.
-    float currentY = textInnerPadding;
-    for (size_t i = 0; i < history.size(); ++i) {
+    // 3. Draw the visible chat messages. The message tops are sorted, so the
+    // first and last message inside the viewport are found by binary search
+    // and the frame costs the same however long the conversation gets.
+    // messageTops holds the baseline of each first line, and its glyphs reach
+    // one ascender above it, so both edges are shifted by that much.
+    const float ascender = font.getAscenderHeight();
+    const float visibleTop = -yOffset;
+    const float visibleBottom = visibleTop + viewportHeight;
+    auto first = std::upper_bound(messageTops.begin(), messageTops.end(), visibleTop + ascender);
+    if (first != messageTops.begin()) {
+        --first; // The message starting above the viewport may reach into it.
+    }
+    auto last = std::lower_bound(first, messageTops.end(), visibleBottom + ascender);
+
+    for (size_t i = first - messageTops.begin(); i < static_cast<size_t>(last - messageTops.begin()); ++i) {
         const auto& msg = history[i];
+        const auto& layout = layouts[i];
         // Set color based on whether the message is from the user, AI, or a system message.
-        ofSetColor(msg.isUser ? ofColor::yellow : (msg.content.rfind("[Summarized", 0) == 0 ? ofColor::gray : ofColor::white));
-        
-        std::string role = msg.isUser ? "You: " : "LLM: ";
-        if (msg.content.rfind("[Summarized", 0) == 0) role = "";
+        ofSetColor(msg.isUser ? ofColor::yellow : (layout.isSummary ? ofColor::gray : ofColor::white));
         
-        std::string wrapped = wrapText(role + msg.content, textMaxWidth);
-        font.drawString(wrapped, 0, currentY);
-        // Move down for the next message.
-        currentY += font.stringHeight(wrapped);
-        if (i < history.size() - 1) {
-            currentY += interMessageSpacing;
-        }
+        font.drawString(layout.wrapped, 0, messageTops[i]);
     }
 
     ofPopMatrix();
@@ -208,22 +190,96 @@ void ChatUI::mouseScrolled(int x, int y, float scrollX, float scrollY, bool isGe
     }
 }
 
-std::string ChatUI::wrapText(const std::string &text, float maxWidth) {
+float ChatUI::layoutMessages(const std::vector<ChatMessage>& history, float maxWidth) {
+    // Messages are only ever pruned from the front of the history, so their
+    // layouts go with them and the rest stay matched to their messages. The
+    // positions of the remaining ones all move up.
+    if (layouts.size() > history.size()) {
+        layouts.erase(layouts.begin(), layouts.begin() + (layouts.size() - history.size()));
+        positionedCount = 0;
+    }
+    layouts.resize(history.size());
+    messageTops.resize(history.size());
+
+    if (history.empty()) {
+        positionedCount = 0;
+        return 0;
+    }
+
+    if (maxWidth != layoutWidth) {
+        layoutWidth = maxWidth;
+        positionedCount = 0;
+    }
+    // The newest message may still be receiving tokens, so it is always checked.
+    size_t i = std::min(positionedCount, history.size() - 1);
+    for (; i < history.size(); ++i) {
+        layoutMessage(layouts[i], history[i], maxWidth);
+        messageTops[i] = (i == 0) ? textInnerPadding // Start with top padding.
+                                  : messageTops[i - 1] + layouts[i - 1].height + interMessageSpacing;
+    }
+    positionedCount = history.size();
+
+    return messageTops.back() + layouts.back().height + textInnerPadding; // Add bottom padding.
+}
+
+void ChatUI::layoutMessage(MessageLayout& layout, const ChatMessage& msg, float maxWidth) {
+    const bool isSummary = msg.content.rfind("[Summarized", 0) == 0;
+    const bool sameMessage = layout.isUser == msg.isUser && layout.isSummary == isSummary && layout.width == maxWidth;
+    if (sameMessage && layout.contentLength == msg.content.size()) {
+        return;
+    }
+
+    if (!sameMessage || msg.content.size() < layout.contentLength) {
+        // Wrap from scratch; only appended text can continue the old lines.
+        layout = MessageLayout();
+        layout.isUser = msg.isUser;
+        layout.isSummary = isSummary;
+        layout.width = maxWidth;
+    }
+
+    std::string role = msg.isUser ? "You: " : "LLM: ";
+    if (isSummary) role = ""; // Don't add a role for summary messages.
+    wrapFrom(layout, role + msg.content, maxWidth);
+    layout.contentLength = msg.content.size();
+}
+
+void ChatUI::wrapFrom(MessageLayout& layout, const std::string& text, float maxWidth) {
     // A simple text wrapping implementation. It breaks text into lines based on a maximum width.
-    std::stringstream ss(text);
-    std::string word;
+    // Lines before the last one are final, so the wrap restarts at the last line's first word.
+    static const char* whitespace = " \t\n\v\f\r";
+
+    layout.wrapped.erase(layout.lastLineStart);
     std::string line;
-    std::string result;
+    std::size_t position = layout.lastLineSource;
+    // After a break the first word always starts the line, however wide it is.
+    bool startsLine = layout.lineCount > 0;
+
+    while (true) {
+        const std::size_t wordStart = text.find_first_not_of(whitespace, position);
+        if (wordStart == std::string::npos) {
+            break;
+        }
+        std::size_t wordEnd = text.find_first_of(whitespace, wordStart);
+        if (wordEnd == std::string::npos) {
+            wordEnd = text.size();
+        }
+        const std::string word = text.substr(wordStart, wordEnd - wordStart);
+        position = wordEnd;
 
-    while (ss >> word) {
         std::string testLine = line + word + " ";
-        if (font.stringWidth(testLine) > maxWidth) {
-            result += line + "\n";
+        if (!startsLine && font.stringWidth(testLine) > maxWidth) {
+            layout.wrapped += line + "\n";
+            ++layout.lineCount;
+            layout.lastLineStart = layout.wrapped.size();
+            layout.lastLineSource = wordStart;
             line = word + " ";
         } else {
             line = testLine;
         }
+        startsLine = false;
     }
-    result += line;
-    return result;
+    layout.wrapped += line;
+
+    // Finished lines are a line height each; only the last one is measured.
+    layout.height = layout.lineCount * font.getLineHeight() + font.stringHeight(line);
 }
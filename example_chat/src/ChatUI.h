@@ -53,11 +53,41 @@ public:
     void mouseScrolled(int x, int y, float scrollX, float scrollY, bool isGenerating);
 
 private:
-    // Wraps text to fit within a specified width.
-    // param text The text to wrap.
+    // The wrapped text of one history message, kept between frames so that
+    // only new or changed messages are wrapped again.
+    struct MessageLayout {
+        std::size_t contentLength = 0; // Length of the content that was wrapped.
+        bool isUser = false;
+        bool isSummary = false;
+        float width = -1;              // Wrap width, so a resize wraps again.
+        std::string wrapped;           // The text with line breaks, ready to draw.
+        std::size_t lineCount = 0;     // Finished lines before the last one.
+        std::size_t lastLineStart = 0; // Where the last line starts in wrapped...
+        std::size_t lastLineSource = 0;// ...and in the role + content text.
+        float height = 0;
+    };
+
+    // Brings the cached layouts and message positions in line with the history
+    // at the given width. Only new messages and the newest one are checked,
+    // since the app only edits the message receiving tokens; a width change
+    // or pruning from the front touches the rest once.
+    // return The height of all messages including padding and spacing.
+    float layoutMessages(const std::vector<ChatMessage>& history, float maxWidth);
+
+    // Wraps one message again if it changed. A message that only grew, like
+    // the reply receiving tokens, is wrapped again from its last line on.
+    void layoutMessage(MessageLayout& layout, const ChatMessage& msg, float maxWidth);
+
+    // Word wraps text into layout, continuing from the start of its last line.
+    // param text The role prefix and message content.
     // param maxWidth The maximum width for the text lines.
-    // return The wrapped text as a single string with newlines.
-    std::string wrapText(const std::string &text, float maxWidth);
+    void wrapFrom(MessageLayout& layout, const std::string& text, float maxWidth);
+
+    std::vector<MessageLayout> layouts; // One per history message, same order.
+    std::vector<float> messageTops;     // Running sum of heights: where each message starts.
+    std::size_t positionedCount;        // Leading messages whose layout and top are current.
+    float layoutWidth;                  // Wrap width of the current positions.
+    bool scrollbarShown;                // Whether the last frame needed the scrollbar.
     
     ofTrueTypeFont font; // The font used for rendering all text in the UI.
     float yOffset;       // The current vertical scroll offset.
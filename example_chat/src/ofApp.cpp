@@ -17,6 +17,12 @@
 namespace {
 const std::string kNoModelFound = "NO MODEL FOUND";
 const std::string kNoRemoteModels = "NO REMOTE MODELS";
+const std::string kLoadingRemoteModels = "LOADING MODELS...";
+const std::string kRemoteEndpointName = "remote";
+
+bool isRemoteModelName(const std::string& name) {
+    return !name.empty() && name != kNoRemoteModels && name != kLoadingRemoteModels;
+}
 
 void configureSingleChoiceDropdown(const std::shared_ptr<ofxDropdown>& dropdown,
                                    const std::vector<std::string>& options,
@@ -409,37 +415,51 @@ void ofApp::populateLocalModels() {
 void ofApp::populateRemoteModels() {
     displayNameToFullFileName.clear();
 
+    stopRemoteWorker();
     remoteProvider = std::make_shared<RemoteAPIProvider>();
     applyRemoteConfig();
 
-    vector<string> remoteModelNames = remoteProvider->listModels();
-    vector<string> uniqueRemoteModelNames;
-    uniqueRemoteModelNames.reserve(remoteModelNames.size());
-    for (const auto& modelName : remoteModelNames) {
-        if (std::find(uniqueRemoteModelNames.begin(), uniqueRemoteModelNames.end(), modelName) == uniqueRemoteModelNames.end()) {
-            uniqueRemoteModelNames.push_back(modelName);
-        }
-    }
-    remoteModelNames = std::move(uniqueRemoteModelNames);
+    // One reply at a time; a newer request replaces one still waiting.
+    AdmissionPolicy remotePolicy;
+    remotePolicy.maxConcurrent = 1;
+    remotePolicy.maxQueueLength = 1;
+    remotePolicy.shedPolicy = AdmissionShedPolicy::DROP_OLDEST;
+    remotePolicy.maxQueueWaitSeconds = 30.0;
+    remoteQueue = std::make_shared<AdmissionControlProvider>(remoteProvider, remotePolicy);
+
+    // The listing runs on its own provider in a background thread. Whatever is
+    // cached is shown now; update() fills in the fresh list when it arrives.
+    std::shared_ptr<RemoteAPIProvider> listingProvider = std::make_shared<RemoteAPIProvider>();
+    configureRemoteProvider(*listingProvider);
+    remoteModelCatalog.addEndpoint(kRemoteEndpointName, listingProvider);
+    remoteModelsVersion = remoteModelCatalog.getVersion();
+    showRemoteModels(remoteModelCatalog.getModels(kRemoteEndpointName));
+}
 
+//--------------------------------------------------------------
+void ofApp::showRemoteModels(const std::vector<std::string>& models) {
+    vector<string> remoteModelNames = models;
     if (remoteModelNames.empty()) {
-        remoteModelNames.push_back(kNoRemoteModels);
+        remoteModelNames.push_back(remoteModelCatalog.isRefreshing(kRemoteEndpointName) ? kLoadingRemoteModels : kNoRemoteModels);
     }
 
+    // Keep the current choice across refreshes, otherwise prefer the configured model.
     string selected = remoteModelNames.front();
-    for (const auto& modelName : remoteModelNames) {
-        if (modelName == preferredRemoteModel) {
-            selected = modelName;
+    for (const string& candidate : {selectedRemoteModel, preferredRemoteModel}) {
+        if (isRemoteModelName(candidate)
+            && std::find(remoteModelNames.begin(), remoteModelNames.end(), candidate) != remoteModelNames.end()) {
+            selected = candidate;
             break;
         }
     }
 
     configureSingleChoiceDropdown(modelDropdown, remoteModelNames, selected);
     selectedRemoteModel = selected;
-    if (selectedRemoteModel != kNoRemoteModels) {
+    if (remoteProvider && isRemoteModelName(selectedRemoteModel)) {
         remoteProvider->setModel(selectedRemoteModel);
     }
     modelInfoLabel.setup(isAzureRemote() ? "Deployment" : "Model", selectedRemoteModel);
+    ready = remoteProvider != nullptr && !remoteApiKey.empty() && isRemoteModelName(selectedRemoteModel);
 }
 
 //--------------------------------------------------------------
@@ -448,20 +468,22 @@ void ofApp::applyRemoteConfig() {
         return;
     }
 
-    remoteProvider->setApiKey(remoteApiKey);
-    remoteProvider->setApiType(remoteApiType);
-    remoteProvider->setApiVersion(remoteApiVersion);
-    remoteProvider->setModelsUrl(remoteModelsUrl);
-    const std::string remoteModel =
-        (!selectedRemoteModel.empty() && selectedRemoteModel != kNoRemoteModels)
-            ? selectedRemoteModel
-            : preferredRemoteModel;
-    remoteProvider->setModel(remoteModel);
-    remoteProvider->setSystemPrompt(system_prompt);
-    remoteProvider->setSystemPromptAsSystemMessage(remoteSystemPromptAsSystemMessage);
-    remoteProvider->setExtraBody(remoteExtraBody);
-    remoteProvider->setStripReasoning(remoteStripReasoning);
-    remoteProvider->setup(remoteEndpoint);
+    configureRemoteProvider(*remoteProvider);
+}
+
+//--------------------------------------------------------------
+void ofApp::configureRemoteProvider(RemoteAPIProvider& provider) const {
+    provider.setApiKey(remoteApiKey);
+    provider.setApiType(remoteApiType);
+    provider.setApiVersion(remoteApiVersion);
+    provider.setModelsUrl(remoteModelsUrl);
+    const std::string remoteModel = isRemoteModelName(selectedRemoteModel) ? selectedRemoteModel : preferredRemoteModel;
+    provider.setModel(remoteModel);
+    provider.setSystemPrompt(system_prompt);
+    provider.setSystemPromptAsSystemMessage(remoteSystemPromptAsSystemMessage);
+    provider.setExtraBody(remoteExtraBody);
+    provider.setStripReasoning(remoteStripReasoning);
+    provider.setup(remoteEndpoint);
 }
 
 //--------------------------------------------------------------
@@ -476,11 +498,11 @@ void ofApp::onBackendChange(string &displayName) {
     if (displayName == "Remote") {
         backend = ChatBackend::REMOTE;
         populateRemoteModels();
-        ready = remoteProvider != nullptr && !remoteApiKey.empty() && selectedRemoteModel != kNoRemoteModels;
         gpuStatusLabel.setup("GPU Layers", "Remote");
         rebuildGuiForBackend();
     } else {
         backend = ChatBackend::LOCAL;
+        remoteQueue.reset();
         remoteProvider.reset();
         populateLocalModels();
         rebuildGuiForBackend();
@@ -496,7 +518,7 @@ void ofApp::onBackendChange(string &displayName) {
 void ofApp::onModelChange(string &displayName) {
     if (backend == ChatBackend::REMOTE) {
         selectedRemoteModel = displayName;
-        if (remoteProvider && selectedRemoteModel != kNoRemoteModels) {
+        if (remoteProvider && isRemoteModelName(selectedRemoteModel)) {
             remoteProvider->setModel(selectedRemoteModel);
             ready = !remoteApiKey.empty();
             modelInfoLabel.setup(isAzureRemote() ? "Deployment" : "Model", selectedRemoteModel);
@@ -685,7 +707,7 @@ void ofApp::startReplyGeneration() {
     
     ofLogNotice("ofApp PROMPT") << mPrompt;
 
-    llama.startGeneration(mPrompt, 1024); // Limit reply length to 1024 tokens
+    llama.startGeneration(mPrompt, 1024, REPLY_DEADLINE_SECONDS); // Limit reply length to 1024 tokens
     wasGenerating = true; 
 }
 
@@ -780,7 +802,7 @@ std::vector<RemoteChatMessage> ofApp::buildRemoteMessages() const {
 
 //--------------------------------------------------------------
 void ofApp::startRemoteReplyGeneration() {
-    if (!remoteProvider || remoteApiKey.empty()) {
+    if (!remoteQueue || remoteApiKey.empty()) {
         currentState = CHATTING;
         ofLogError("example_chat") << "Remote backend is not configured.";
         return;
@@ -789,48 +811,77 @@ void ofApp::startRemoteReplyGeneration() {
     stopRemoteWorker();
     applyRemoteConfig();
 
+    {
+        std::lock_guard<std::mutex> lock(remoteMutex);
+        remotePendingReply.clear();
+    }
+
     remoteGenerating = true;
     wasGenerating = true;
 
     const std::vector<RemoteChatMessage> requestMessages = buildRemoteMessages();
-    remoteWorker = std::thread([this, requestMessages]() {
-        const std::string reply = remoteProvider->generateChat(requestMessages);
-        {
+    const std::shared_ptr<AdmissionControlProvider> provider = remoteQueue;
+    remoteCancel = std::make_shared<InferenceCancellationToken>();
+    const std::shared_ptr<InferenceCancellationToken> cancel = remoteCancel;
+    remoteWorker = std::thread([this, provider, cancel, requestMessages]() {
+        // Deltas are queued as they arrive and drained by update() on the main thread.
+        provider->generateChatStream(requestMessages, [this](const std::string& token) {
             std::lock_guard<std::mutex> lock(remoteMutex);
-            remotePendingReply = reply;
-        }
+            remotePendingReply += token;
+        }, cancel);
         remoteGenerating = false;
     });
 }
 
 //--------------------------------------------------------------
 void ofApp::stopRemoteWorker() {
+    // Cancelling first keeps the join from waiting on a slow reply.
+    if (remoteCancel) {
+        remoteCancel->cancel();
+    }
     if (remoteWorker.joinable()) {
         remoteWorker.join();
     }
+    remoteCancel.reset();
     remoteGenerating = false;
 }
 
 
 //--------------------------------------------------------------
 void ofApp::update() {
+    // Pick up a model list refreshed in the background, but not mid-reply.
+    if (backend == ChatBackend::REMOTE && currentState != GENERATING_REPLY
+        && remoteModelCatalog.getVersion() != remoteModelsVersion) {
+        remoteModelsVersion = remoteModelCatalog.getVersion();
+        showRemoteModels(remoteModelCatalog.getModels(kRemoteEndpointName));
+    }
+
     if (!ready) return; // Don't do anything if the model isn't loaded
 
     if (backend == ChatBackend::REMOTE) {
-        if (currentState == GENERATING_REPLY && !remoteGenerating) {
-            stopRemoteWorker();
+        if (currentState != GENERATING_REPLY) {
+            return;
+        }
 
-            std::string reply;
-            {
-                std::lock_guard<std::mutex> lock(remoteMutex);
-                reply = remotePendingReply;
-                remotePendingReply.clear();
-            }
+        // Read the finished flag before draining so no trailing delta is lost.
+        const bool finished = !remoteGenerating;
+
+        std::string chunk;
+        {
+            std::lock_guard<std::mutex> lock(remoteMutex);
+            chunk.swap(remotePendingReply);
+        }
 
-            if (!reply.empty()) {
-                chatHistory.push_back({reply, false, ofColor::white});
+        if (!chunk.empty()) {
+            if (chatHistory.empty() || chatHistory.back().isUser) {
+                chatHistory.push_back({chunk, false, ofColor::white});
+            } else {
+                chatHistory.back().content += chunk;
             }
+        }
 
+        if (finished) {
+            stopRemoteWorker();
             currentState = CHATTING;
             wasGenerating = false;
         }
@@ -985,6 +1036,10 @@ void ofApp::mousePressed(int x, int y, int button) {
     auto handleSelectorClick = [&](OpenSelector selector, const ofRectangle& rect) {
         if (rect.inside(static_cast<float>(x), static_cast<float>(y))) {
             openSelector = openSelector == selector ? OpenSelector::NONE : selector;
+            if (openSelector == OpenSelector::MODEL && backend == ChatBackend::REMOTE) {
+                // Starts a background refresh if the list has expired; never blocks.
+                remoteModelCatalog.getModels(kRemoteEndpointName);
+            }
             return true;
         }
 
@@ -1078,11 +1133,12 @@ void ofApp::keyPressed(ofKeyEventArgs &args) {
 //--------------------------------------------------------------
 void ofApp::stopGeneration() {
     if (backend == ChatBackend::REMOTE) {
-        ofLogNotice("example_chat") << "Remote requests cannot be cancelled once sent.";
-        return;
+        stopRemoteWorker();
+        std::lock_guard<std::mutex> lock(remoteMutex);
+        remotePendingReply.clear();
+    } else {
+        llama.stopGeneration();
     }
-
-    llama.stopGeneration();
     wasGenerating = false;
     
     // Reset the state machine to idle
@@ -14,6 +14,8 @@
 #include "ofxGui.h"
 #include "ofxLlamaCpp.h"
 #include "RemoteAPIProvider.h"
+#include "AdmissionControlProvider.h"
+#include "RemoteModelCatalog.h"
 #if !defined(_MSC_VER)
 #define OFX_LLAMACPP_USE_MINJA 1
 #include "minja/chat-template.hpp"
@@ -112,6 +114,10 @@ private:
     // --- Llama Engine ---
     ofxLlamaCpp llama; // The core Llama language model object.
     std::shared_ptr<RemoteAPIProvider> remoteProvider;
+    std::shared_ptr<AdmissionControlProvider> remoteQueue; // Bounds requests sent to remoteProvider.
+    std::shared_ptr<InferenceCancellationToken> remoteCancel;
+    RemoteModelCatalog remoteModelCatalog; // Loads the model list off the UI thread.
+    std::uint64_t remoteModelsVersion = 0;
     ChatBackend backend = ChatBackend::LOCAL;
     bool ready = false; // Flag indicating if the model is loaded and ready.
     bool wasGenerating = false; // Flag to track if the model was generating in the previous frame.
@@ -144,6 +150,7 @@ private:
     // --- Memory ---
     std::vector<ChatMessage> chatHistory; // A vector storing the history of the conversation.
     int CHAT_HISTORY_LIMIT = 8; // The maximum number of messages to keep in active history before summarizing.
+    float REPLY_DEADLINE_SECONDS = 0.0f; // Time budget per reply, e.g. 8 for a kiosk. 0 means no deadline.
     int SUMMARY_INTERVAL = 4;   // The number of messages to process in each summarization step.
     std::string conversationSummary; // A running summary of the conversation.
     
@@ -160,7 +167,9 @@ private:
     void loadRemoteConfigFromFile();
     void populateLocalModels();
     void populateRemoteModels();
+    void showRemoteModels(const std::vector<std::string>& models);
     void applyRemoteConfig();
+    void configureRemoteProvider(RemoteAPIProvider& provider) const;
     bool isAzureRemote() const;
     std::vector<RemoteChatMessage> buildRemoteMessages() const;
     std::string formatLocalPrompt(const nlohmann::json& messages, bool addGenerationPrompt) const;
@@ -0,0 +1,143 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "ofApp.h"
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+    ofBackground(0);
+    ofSetFrameRate(30);
+
+    ofDirectory modelsDir(ofToDataPath("models"));
+    modelsDir.allowExt("gguf");
+    modelsDir.listDir();
+    modelsDir.sort();
+    if (modelsDir.size() == 0) {
+        status = "No .gguf model found in data/models.";
+        return;
+    }
+
+    modelReady = llama.loadModel(modelsDir.getPath(0));
+    if (!modelReady) {
+        status = "Failed to load " + modelsDir.getName(0);
+        return;
+    }
+    llama.addStopWord("User:");
+    // Long prompts are spread over several frames instead of one long one.
+    llama.setPrefillChunkSize(64);
+
+    status = "Type a prompt and press Enter.";
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+    if (!llama.isGenerating()) {
+        return;
+    }
+
+    const uint64_t start = ofGetElapsedTimeMicros();
+    reply += useTimeBudget ? llama.stepFor(budgetMilliseconds) : llama.step(stepsPerFrame);
+    lastStepMilliseconds = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+
+    if (!llama.isGenerating()) {
+        status = "Done after frame " + ofToString(ofGetFrameNum()) + ".";
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::draw() {
+    const float margin = 20.0f;
+
+    // Moves a fixed distance per frame, so any hitch shows as a jump.
+    ofSetColor(80, 200, 255);
+    ofDrawRectangle(std::fmod(ofGetFrameNum() * 8.0f, ofGetWidth()), ofGetHeight() - 30.0f, 40.0f, 10.0f);
+
+    ofSetColor(170);
+    const std::string mode = useTimeBudget
+        ? "time budget " + ofToString(budgetMilliseconds, 0) + " ms"
+        : ofToString(stepsPerFrame) + " step(s)";
+    ofDrawBitmapString("Per frame: " + mode + ", last " + ofToString(lastStepMilliseconds, 2) + " ms, "
+                       + ofToString(ofGetFrameRate(), 0) + " fps", margin, 30);
+    ofDrawBitmapString("Enter: send   Tab: stop   F1: switch mode   Up/Down: more/less per frame", margin, 50);
+    ofDrawBitmapString(status, margin, 70);
+
+    ofSetColor(255);
+    ofDrawBitmapString("> " + input, margin, 110);
+    ofDrawBitmapString(wrapText(reply, ofGetWidth() - margin * 2.0f), margin, 140);
+}
+
+//--------------------------------------------------------------
+void ofApp::keyPressed(ofKeyEventArgs& args) {
+    if (args.key == OF_KEY_F1) {
+        useTimeBudget = !useTimeBudget;
+        return;
+    }
+
+    if (args.key == OF_KEY_UP || args.key == OF_KEY_DOWN) {
+        const int direction = args.key == OF_KEY_UP ? 1 : -1;
+        if (useTimeBudget) {
+            budgetMilliseconds = ofClamp(budgetMilliseconds + direction * 2.0f, 1.0f, 30.0f);
+        } else {
+            stepsPerFrame = ofClamp(stepsPerFrame + direction, 1, 16);
+        }
+        return;
+    }
+
+    if (args.key == OF_KEY_TAB) {
+        if (llama.isGenerating()) {
+            llama.stopGeneration();
+            status = "Stopped.";
+        }
+        return;
+    }
+
+    if (args.key == OF_KEY_RETURN) {
+        if (!input.empty() && modelReady) {
+            // Nothing runs yet; update() advances the generation each frame.
+            reply.clear();
+            llama.beginGeneration("User: " + input + "\nAssistant:");
+            status = "Generating from frame " + ofToString(ofGetFrameNum()) + "...";
+            input.clear();
+        }
+        return;
+    }
+
+    if (args.key == OF_KEY_BACKSPACE) {
+        if (!input.empty()) {
+            input.pop_back();
+        }
+        return;
+    }
+
+    if (args.key >= 32 && args.key < 127) {
+        input += static_cast<char>(args.key);
+    }
+}
+
+//--------------------------------------------------------------
+std::string ofApp::wrapText(const std::string& text, float width) const {
+    // The bitmap font is 8 pixels wide per character.
+    const std::size_t columns = std::max<std::size_t>(1, static_cast<std::size_t>(width / 8.0f));
+    std::string wrapped;
+    std::size_t column = 0;
+    for (char c : text) {
+        if (c == '\n' || column >= columns) {
+            wrapped += '\n';
+            column = 0;
+            if (c == '\n') {
+                continue;
+            }
+        }
+        wrapped += c;
+        ++column;
+    }
+    return wrapped;
+}
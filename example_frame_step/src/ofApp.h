@@ -0,0 +1,41 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLlamaCpp.h"
+
+// Generates on the main thread, a fixed amount of work per frame, with no
+// worker thread. The text then advances in lockstep with the frames, which
+// keeps screen recordings and live visuals reproducible.
+class ofApp : public ofBaseApp {
+public:
+    void setup();
+    void update();
+    void draw();
+    void keyPressed(ofKeyEventArgs& args);
+
+private:
+    std::string wrapText(const std::string& text, float width) const;
+
+    ofxLlamaCpp llama;
+    bool modelReady = false;
+
+    // Either a fixed number of steps or a time budget per frame.
+    bool useTimeBudget = false;
+    int stepsPerFrame = 1;
+    float budgetMilliseconds = 8.0f;
+    float lastStepMilliseconds = 0.0f;
+
+    std::string input;
+    std::string reply;
+    std::string status;
+};
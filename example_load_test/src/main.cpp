@@ -0,0 +1,17 @@
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+//========================================================================
+int main( ){
+
+	// The load test has nothing to draw, so it runs without a window and
+	// can run on the machine being measured.
+	ofInit();
+	auto window = make_shared<ofAppNoWindow>();
+	ofGetMainLoop()->addWindow(window);
+
+	ofRunApp(window, make_shared<ofApp>());
+	ofRunMainLoop();
+
+}
@@ -0,0 +1,184 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "ofApp.h"
+#include "AdmissionControlProvider.h"
+#include "RemoteAPIProvider.h"
+
+//--------------------------------------------------------------
+ofApp::~ofApp() {
+    if (loadTest) {
+        loadTest->stop();
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+    mockServer.stop();
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+    ofSetFrameRate(10);
+    loadConfigFromFile();
+
+    std::shared_ptr<IInferenceProvider> provider = createProvider();
+    if (!provider) {
+        ofExit(1);
+        return;
+    }
+
+    loadTest.reset(new InferenceLoadTest(provider));
+    loadTest->setSettings(settings);
+
+    ofLogNotice("example_load_test")
+        << "Testing the " << backend << " backend, "
+        << (settings.arrivalMode == LoadArrivalMode::POISSON ? "Poisson arrivals" : "closed loop")
+        << ", " << settings.levels.size() << " levels of " << settings.durationSeconds << " s, "
+        << (settings.streaming ? "streaming" : "not streaming");
+
+    worker = std::thread([this]() {
+        results = loadTest->run();
+        finished = true;
+    });
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+    if (!finished) {
+        return;
+    }
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    ofLogNotice("example_load_test") << "Results:\n" << InferenceLoadTest::formatTable(results, settings.arrivalMode);
+    if (!resultsCsv.empty() && InferenceLoadTest::writeCsv(ofToDataPath(resultsCsv), results, settings.arrivalMode)) {
+        ofLogNotice("example_load_test") << "Wrote " << ofToDataPath(resultsCsv);
+    }
+    ofExit(0);
+}
+
+//--------------------------------------------------------------
+std::shared_ptr<IInferenceProvider> ofApp::createProvider() {
+    std::shared_ptr<IInferenceProvider> provider;
+
+    if (backend == "local") {
+        provider = BackendSelector::create(BackendType::LOCAL);
+        if (!provider->setup(ofToDataPath(modelPath))) {
+            return nullptr;
+        }
+    } else if (backend == "remote" || backend == "mock") {
+        std::string endpoint = remoteEndpoint;
+        if (backend == "mock") {
+            mockServer.setSettings(mockSettings);
+            if (!mockServer.start("127.0.0.1", 0)) {
+                ofLogError("example_load_test") << "Failed to start the mock server.";
+                return nullptr;
+            }
+            endpoint = mockServer.getBaseUrl();
+        }
+
+        provider = BackendSelector::create(BackendType::REMOTE);
+        if (auto remote = std::dynamic_pointer_cast<RemoteAPIProvider>(provider)) {
+            remote->setApiKey(remoteApiKey);
+            if (!remoteApiType.empty()) {
+                remote->setApiType(remoteApiType);
+            }
+            remote->setModel(backend == "mock" ? mockSettings.models.front() : remoteModel);
+            remote->setExtraBody(remoteExtraBody);
+        }
+        if (!provider->setup(endpoint)) {
+            return nullptr;
+        }
+    } else {
+        ofLogError("example_load_test") << "Unknown backend \"" << backend << "\". Use local, remote or mock.";
+        return nullptr;
+    }
+
+    if (maxConcurrent > 0) {
+        AdmissionPolicy policy;
+        policy.maxConcurrent = maxConcurrent;
+        policy.maxQueueLength = settings.maxInFlight;
+        policy.maxQueueWaitSeconds = 0.0;
+        provider = std::make_shared<AdmissionControlProvider>(provider, policy);
+    }
+    return provider;
+}
+
+//--------------------------------------------------------------
+void ofApp::loadConfigFromFile() {
+    const std::string configPath = ofToDataPath("load_test_config.json");
+    if (!ofFile::doesFileExist(configPath)) {
+        ofLogNotice("example_load_test") << "load_test_config.json not found, using defaults.";
+        return;
+    }
+
+    try {
+        const ofJson config = ofLoadJson(configPath);
+
+        backend = config.value("backend", backend);
+        modelPath = config.value("model_path", modelPath);
+
+        if (config.contains("remote") && config["remote"].is_object()) {
+            const ofJson& remote = config["remote"];
+            remoteApiType = remote.value("api_type", remoteApiType);
+            remoteEndpoint = remote.value("api_endpoint", remoteEndpoint);
+            remoteApiKey = remote.value("api_key", remoteApiKey);
+            remoteModel = remote.value("model", remoteModel);
+            if (remote.contains("extra_body") && remote["extra_body"].is_object()) {
+                remoteExtraBody = remote["extra_body"];
+            }
+        }
+
+        if (config.contains("mock") && config["mock"].is_object()) {
+            const ofJson& mock = config["mock"];
+            mockSettings.firstTokenLatency = mock.value("first_token_latency", mockSettings.firstTokenLatency);
+            mockSettings.latencyJitter = mock.value("latency_jitter", mockSettings.latencyJitter);
+            mockSettings.tokensPerSecond = mock.value("tokens_per_second", mockSettings.tokensPerSecond);
+            mockSettings.completionTokens = mock.value("completion_tokens", mockSettings.completionTokens);
+            mockSettings.errorRate = mock.value("error_rate", mockSettings.errorRate);
+        }
+
+        if (config.contains("max_concurrent") && config["max_concurrent"].is_number_unsigned()) {
+            maxConcurrent = config["max_concurrent"].get<std::size_t>();
+        }
+
+        if (config.contains("arrival") && config["arrival"].is_string()) {
+            settings.arrivalMode = config["arrival"].get<std::string>() == "poisson"
+                ? LoadArrivalMode::POISSON
+                : LoadArrivalMode::CLOSED_LOOP;
+        }
+
+        if (config.contains("levels") && config["levels"].is_array()) {
+            settings.levels.clear();
+            for (const auto& level : config["levels"]) {
+                if (level.is_number() && level.get<double>() > 0.0) {
+                    settings.levels.push_back(level.get<double>());
+                }
+            }
+        }
+
+        settings.durationSeconds = config.value("duration_seconds", settings.durationSeconds);
+        settings.thinkTimeSeconds = config.value("think_time_seconds", settings.thinkTimeSeconds);
+        settings.promptWordsMedian = config.value("prompt_words_median", settings.promptWordsMedian);
+        settings.promptWordsSpread = config.value("prompt_words_spread", settings.promptWordsSpread);
+        settings.minPromptWords = config.value("min_prompt_words", settings.minPromptWords);
+        settings.maxPromptWords = config.value("max_prompt_words", settings.maxPromptWords);
+        settings.streaming = config.value("streaming", settings.streaming);
+        settings.chat = config.value("chat", settings.chat);
+        settings.maxInFlight = config.value("max_in_flight", settings.maxInFlight);
+        settings.randomSeed = config.value("random_seed", settings.randomSeed);
+        resultsCsv = config.value("results_csv", resultsCsv);
+    } catch (const std::exception& exception) {
+        ofLogError("example_load_test") << "Failed to load load_test_config.json: " << exception.what();
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "BackendSelector.h"
+#include "InferenceLoadTest.h"
+#include "MockOpenAIServer.h"
+
+#include <atomic>
+#include <thread>
+
+// Headless app that sweeps a backend through increasing load levels and
+// reports throughput, time to first token and end-to-end latency per level,
+// to find the visitor count at which a machine saturates. Everything is set
+// in load_test_config.json; results are logged and written as CSV.
+class ofApp : public ofBaseApp {
+public:
+    ~ofApp();
+
+    void setup();
+    void update();
+
+private:
+    void loadConfigFromFile();
+    std::shared_ptr<IInferenceProvider> createProvider();
+
+    InferenceLoadTestSettings settings;
+    std::string backend = "mock";
+    std::string modelPath = "models/model.gguf";
+    std::string remoteApiType;
+    std::string remoteEndpoint;
+    std::string remoteApiKey;
+    std::string remoteModel;
+    ofJson remoteExtraBody = ofJson::object();
+    MockOpenAIServerSettings mockSettings;
+    std::size_t maxConcurrent = 0;
+    std::string resultsCsv = "load_test_results.csv";
+
+    MockOpenAIServer mockServer;
+    std::unique_ptr<InferenceLoadTest> loadTest;
+    std::thread worker;
+    std::vector<InferenceLoadLevelResult> results;
+    std::atomic<bool> finished{false};
+};
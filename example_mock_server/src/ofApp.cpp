@@ -0,0 +1,104 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License. 
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+ 
+#include "ofApp.h"
+
+namespace {
+    const float REPORT_INTERVAL_SECONDS = 5.0f;
+}
+
+//--------------------------------------------------------------
+ofApp::~ofApp() {
+    server.stop();
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+    ofSetFrameRate(30);
+    loadConfigFromFile();
+
+    server.setSettings(settings);
+    if (!server.start(host, port)) {
+        ofLogError("example_mock_server") << "Failed to start mock server on " << host << ":" << port;
+        ofExit(1);
+        return;
+    }
+
+    ofLogNotice("example_mock_server") << "Mock OpenAI-compatible endpoint at " << server.getBaseUrl();
+    ofLogNotice("example_mock_server")
+        << "first token " << settings.firstTokenLatency << " s (+" << settings.latencyJitter << " s jitter), "
+        << settings.tokensPerSecond << " tokens/s, " << settings.completionTokens << " tokens, "
+        << "error rate " << settings.errorRate << ", disconnect rate " << settings.disconnectRate;
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+    const float now = ofGetElapsedTimef();
+    if (now - lastReportTime < REPORT_INTERVAL_SECONDS) {
+        return;
+    }
+    lastReportTime = now;
+
+    const MockOpenAIServerStats stats = server.getStats();
+    if (stats.chatRequests == lastReportedRequests) {
+        return;
+    }
+    lastReportedRequests = stats.chatRequests;
+
+    ofLogNotice("example_mock_server")
+        << stats.chatRequests << " chat requests (" << stats.streamedRequests << " streamed), "
+        << stats.modelRequests << " model listings, "
+        << stats.injectedErrors << " injected errors, "
+        << stats.injectedDisconnects << " dropped, "
+        << stats.acceptedConnections << " connections accepted";
+}
+
+//--------------------------------------------------------------
+void ofApp::loadConfigFromFile() {
+    const std::string configPath = ofToDataPath("mock_server_config.json");
+    if (!ofFile::doesFileExist(configPath)) {
+        ofLogNotice("example_mock_server") << "mock_server_config.json not found, using defaults.";
+        return;
+    }
+
+    try {
+        const ofJson config = ofLoadJson(configPath);
+
+        if (config.contains("host") && config["host"].is_string()) {
+            host = config["host"].get<std::string>();
+        }
+
+        if (config.contains("port") && config["port"].is_number_integer()) {
+            port = config["port"].get<int>();
+        }
+
+        if (config.contains("models") && config["models"].is_array()) {
+            settings.models.clear();
+            for (const auto& model : config["models"]) {
+                if (model.is_string()) {
+                    settings.models.push_back(model.get<std::string>());
+                }
+            }
+        }
+
+        settings.firstTokenLatency = config.value("first_token_latency", settings.firstTokenLatency);
+        settings.latencyJitter = config.value("latency_jitter", settings.latencyJitter);
+        settings.tokensPerSecond = config.value("tokens_per_second", settings.tokensPerSecond);
+        settings.completionTokens = config.value("completion_tokens", settings.completionTokens);
+        settings.errorRate = config.value("error_rate", settings.errorRate);
+        settings.errorStatus = config.value("error_status", settings.errorStatus);
+        settings.retryAfter = config.value("retry_after", settings.retryAfter);
+        settings.disconnectRate = config.value("disconnect_rate", settings.disconnectRate);
+        settings.randomSeed = config.value("random_seed", settings.randomSeed);
+    } catch (const std::exception& exception) {
+        ofLogError("example_mock_server") << "Failed to load mock_server_config.json: " << exception.what();
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License. 
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+ 
+#pragma once
+#include "ofMain.h"
+#include "MockOpenAIServer.h"
+
+// Headless app that serves a mock OpenAI-compatible endpoint for offline
+// benchmarking of RemoteAPIProvider. Point remote_api_config.json of the other
+// examples at the printed URL.
+class ofApp : public ofBaseApp {
+public:
+    ~ofApp();
+
+    void setup();
+    void update();
+
+private:
+    void loadConfigFromFile();
+
+    MockOpenAIServer server;
+    MockOpenAIServerSettings settings;
+    std::string host = "127.0.0.1";
+    int port = 8089;
+
+    float lastReportTime = 0.0f;
+    std::size_t lastReportedRequests = 0;
+};
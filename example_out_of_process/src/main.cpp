@@ -0,0 +1,25 @@
+#include "ofMain.h"
+#include "ofApp.h"
+#include "InferenceWorkerProcess.h"
+
+#include <cstring>
+
+//========================================================================
+int main(int argc, char* argv[]){
+
+	// The app starts a second copy of itself as its inference worker.
+	// OutOfProcessProvider passes "--fd", which selects the worker role.
+	if (argc > 1 && std::strcmp(argv[1], "--fd") == 0) {
+		return InferenceWorkerProcess::main(argc, argv);
+	}
+
+	ofGLWindowSettings settings;
+	settings.setSize(1024, 768);
+	settings.windowMode = OF_WINDOW;
+
+	auto window = ofCreateWindow(settings);
+
+	ofRunApp(window, make_shared<ofApp>());
+	ofRunMainLoop();
+
+}
@@ -0,0 +1,201 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "ofApp.h"
+
+#include <csignal>
+
+//--------------------------------------------------------------
+ofApp::~ofApp() {
+    joinRequest();
+    if (provider) {
+        provider->stopWorker();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+    ofBackground(0);
+    ofSetFrameRate(60);
+
+    const std::string modelPath = findModelPath();
+    if (modelPath.empty()) {
+        status = "No .gguf model found in data/models.";
+        return;
+    }
+
+    // This executable doubles as the worker, see main.cpp.
+    provider = std::make_unique<OutOfProcessProvider>(ofFilePath::getCurrentExePath());
+
+    // Loading blocks until the worker has the model, so it runs on the
+    // request thread like a generation.
+    status = "Starting worker and loading " + ofFilePath::getFileName(modelPath) + "...";
+    busy = true;
+    requestThread = std::thread([this, modelPath]() {
+        const bool loaded = provider->setup(modelPath);
+        std::lock_guard<std::mutex> lock(replyMutex);
+        status = loaded ? "Type a prompt and press Enter." : "The worker failed to load the model.";
+        busy = false;
+    });
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+}
+
+//--------------------------------------------------------------
+void ofApp::draw() {
+    const float margin = 20.0f;
+
+    // Keeps turning while the worker loads or decodes, which is the point of
+    // moving the engine out of this process.
+    ofPushMatrix();
+    ofTranslate(ofGetWidth() - 50.0f, 50.0f);
+    ofRotateDeg(ofGetElapsedTimef() * 180.0f);
+    ofSetColor(80, 200, 255);
+    ofDrawRectangle(-25.0f, -3.0f, 50.0f, 6.0f);
+    ofPopMatrix();
+
+    std::string currentStatus;
+    std::string currentReply;
+    {
+        std::lock_guard<std::mutex> lock(replyMutex);
+        currentStatus = status;
+        currentReply = reply;
+    }
+
+    ofSetColor(170);
+    std::string workerInfo = "Worker: not running";
+    if (provider && provider->isWorkerRunning()) {
+        workerInfo = "Worker: pid " + ofToString(provider->getWorkerProcessId());
+    }
+    if (provider) {
+        workerInfo += ", restarts " + ofToString(provider->getRestartCount());
+    }
+    ofDrawBitmapString(workerInfo + ", " + ofToString(ofGetFrameRate(), 0) + " fps", margin, 30);
+    ofDrawBitmapString("Enter: send   Tab: cancel   F5: kill the worker", margin, 50);
+    ofDrawBitmapString(currentStatus, margin, 70);
+
+    ofSetColor(255);
+    ofDrawBitmapString("> " + input, margin, 110);
+    ofDrawBitmapString(wrapText(currentReply, ofGetWidth() - margin * 2.0f), margin, 140);
+}
+
+//--------------------------------------------------------------
+void ofApp::keyPressed(ofKeyEventArgs& args) {
+    if (args.key == OF_KEY_F5) {
+        // Simulates a crash. The running request ends with what it has; the
+        // next one starts a new worker with the same model.
+        if (provider && provider->isWorkerRunning()) {
+            ofLogNotice("example_out_of_process") << "Killing worker " << provider->getWorkerProcessId();
+            kill(provider->getWorkerProcessId(), SIGKILL);
+        }
+        return;
+    }
+
+    if (args.key == OF_KEY_TAB) {
+        if (cancel) {
+            cancel->cancel();
+        }
+        return;
+    }
+
+    if (args.key == OF_KEY_RETURN) {
+        if (!input.empty() && provider && !busy) {
+            startRequest(input);
+            input.clear();
+        }
+        return;
+    }
+
+    if (args.key == OF_KEY_BACKSPACE) {
+        if (!input.empty()) {
+            input.pop_back();
+        }
+        return;
+    }
+
+    if (args.key >= 32 && args.key < 127) {
+        input += static_cast<char>(args.key);
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::startRequest(const std::string& prompt) {
+    joinRequest();
+
+    transcript += "User: " + prompt + "\nAssistant:";
+    {
+        std::lock_guard<std::mutex> lock(replyMutex);
+        reply.clear();
+        status = "Generating in the worker...";
+    }
+
+    cancel = std::make_shared<InferenceCancellationToken>();
+    busy = true;
+    requestThread = std::thread([this, request = transcript, token = cancel]() {
+        const std::string result = provider->generateStream(request, [this](const std::string& piece) {
+            std::lock_guard<std::mutex> lock(replyMutex);
+            reply += piece;
+        }, token);
+
+        std::lock_guard<std::mutex> lock(replyMutex);
+        if (token->isCancelled()) {
+            status = "Cancelled.";
+        } else if (!provider->isWorkerRunning()) {
+            status = "The worker died. The next prompt starts a new one.";
+        } else {
+            status = "Done.";
+        }
+        transcript += " " + result + "\n";
+        busy = false;
+    });
+}
+
+//--------------------------------------------------------------
+void ofApp::joinRequest() {
+    if (cancel) {
+        cancel->cancel();
+    }
+    if (requestThread.joinable()) {
+        requestThread.join();
+    }
+    cancel.reset();
+}
+
+//--------------------------------------------------------------
+std::string ofApp::findModelPath() const {
+    ofDirectory modelsDir(ofToDataPath("models"));
+    modelsDir.allowExt("gguf");
+    modelsDir.listDir();
+    modelsDir.sort();
+    return modelsDir.size() > 0 ? modelsDir.getPath(0) : "";
+}
+
+//--------------------------------------------------------------
+std::string ofApp::wrapText(const std::string& text, float width) const {
+    // The bitmap font is 8 pixels wide per character.
+    const std::size_t columns = std::max<std::size_t>(1, static_cast<std::size_t>(width / 8.0f));
+    std::string wrapped;
+    std::size_t column = 0;
+    for (char c : text) {
+        if (c == '\n' || column >= columns) {
+            wrapped += '\n';
+            column = 0;
+            if (c == '\n') {
+                continue;
+            }
+        }
+        wrapped += c;
+        ++column;
+    }
+    return wrapped;
+}
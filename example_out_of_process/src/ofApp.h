@@ -0,0 +1,50 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "OutOfProcessProvider.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Runs the engine in a worker process and streams its tokens back through
+// shared memory. The spinning bar keeps turning while the worker loads and
+// decodes, and killing the worker (F5) only costs the current reply.
+class ofApp : public ofBaseApp {
+public:
+    ~ofApp();
+
+    void setup();
+    void update();
+    void draw();
+    void keyPressed(ofKeyEventArgs& args);
+
+private:
+    std::string findModelPath() const;
+    void startRequest(const std::string& prompt);
+    void joinRequest();
+    std::string wrapText(const std::string& text, float width) const;
+
+    std::unique_ptr<OutOfProcessProvider> provider;
+    std::thread requestThread;
+    std::shared_ptr<InferenceCancellationToken> cancel;
+    std::atomic<bool> busy{false};
+
+    std::mutex replyMutex;
+    std::string reply;
+    std::string status;
+
+    std::string input;
+    std::string transcript;
+};
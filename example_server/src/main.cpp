@@ -0,0 +1,17 @@
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+//========================================================================
+int main( ){
+
+	// The server has nothing to draw, so it runs without a window and
+	// can be started on headless machines in the installation.
+	ofInit();
+	auto window = make_shared<ofAppNoWindow>();
+	ofGetMainLoop()->addWindow(window);
+
+	ofRunApp(window, make_shared<ofApp>());
+	ofRunMainLoop();
+
+}
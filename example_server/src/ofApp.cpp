@@ -0,0 +1,129 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "ofApp.h"
+
+namespace {
+    const float REPORT_INTERVAL_SECONDS = 5.0f;
+}
+
+//--------------------------------------------------------------
+ofApp::~ofApp() {
+    server.stop();
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+    ofSetFrameRate(30);
+    loadConfigFromFile();
+
+    const std::string modelPath = findModelPath();
+    if (modelPath.empty()) {
+        ofLogError("example_server") << "No .gguf model found in data/models.";
+        ofExit(1);
+        return;
+    }
+
+    server.getEngine().setN_GpuLayers(gpuLayers);
+    if (!rpcServers.empty()) {
+        // Models larger than this machine's RAM are split across RPC workers.
+        server.getEngine().setRpcServers(rpcServers);
+        server.getEngine().setTensorSplit(tensorSplit);
+    }
+    if (!server.loadModel(modelPath, contextSize)) {
+        ofExit(1);
+        return;
+    }
+
+    server.setSettings(settings);
+    if (!server.start(host, port)) {
+        ofLogError("example_server") << "Failed to start server on " << host << ":" << port;
+        ofExit(1);
+        return;
+    }
+
+    ofLogNotice("example_server") << "Serving " << server.getModelName() << " at " << server.getBaseUrl();
+    ofLogNotice("example_server") << "Try: curl " << server.getBaseUrl()
+        << "/chat/completions -d '{\"messages\":[{\"role\":\"user\",\"content\":\"Hello\"}]}'";
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+    const float now = ofGetElapsedTimef();
+    if (now - lastReportTime < REPORT_INTERVAL_SECONDS) {
+        return;
+    }
+    lastReportTime = now;
+
+    const LlamaOpenAIServerStats stats = server.getStats();
+    const std::size_t requests = stats.chatRequests + stats.completionRequests + stats.embeddingRequests;
+    if (requests == lastReportedRequests) {
+        return;
+    }
+    lastReportedRequests = requests;
+
+    ofLogNotice("example_server")
+        << stats.chatRequests << " chat, " << stats.completionRequests << " completion, "
+        << stats.embeddingRequests << " embedding requests, "
+        << stats.queued << " queued, " << stats.rejectedRequests << " rejected, "
+        << stats.cancelledRequests << " cancelled, "
+        << stats.promptTokens << " prompt / " << stats.completionTokens << " completion tokens";
+}
+
+//--------------------------------------------------------------
+std::string ofApp::findModelPath() const {
+    if (!modelFile.empty()) {
+        const std::string path = ofToDataPath("models/" + modelFile);
+        if (ofFile::doesFileExist(path)) {
+            return path;
+        }
+        ofLogWarning("example_server") << "Model " << modelFile << " not found in data/models.";
+        return "";
+    }
+
+    ofDirectory modelsDir(ofToDataPath("models"));
+    modelsDir.allowExt("gguf");
+    modelsDir.listDir();
+    modelsDir.sort();
+    return modelsDir.size() > 0 ? modelsDir.getPath(0) : "";
+}
+
+//--------------------------------------------------------------
+void ofApp::loadConfigFromFile() {
+    const std::string configPath = ofToDataPath("server_config.json");
+    if (!ofFile::doesFileExist(configPath)) {
+        ofLogNotice("example_server") << "server_config.json not found, using defaults.";
+        return;
+    }
+
+    try {
+        const ofJson config = ofLoadJson(configPath);
+
+        if (config.contains("host") && config["host"].is_string()) {
+            host = config["host"].get<std::string>();
+        }
+
+        if (config.contains("port") && config["port"].is_number_integer()) {
+            port = config["port"].get<int>();
+        }
+
+        modelFile = config.value("model", modelFile);
+        contextSize = config.value("context_size", contextSize);
+        gpuLayers = config.value("gpu_layers", gpuLayers);
+        rpcServers = config.value("rpc_servers", rpcServers);
+        tensorSplit = config.value("tensor_split", tensorSplit);
+        settings.modelName = config.value("model_name", settings.modelName);
+        settings.defaultMaxTokens = config.value("default_max_tokens", settings.defaultMaxTokens);
+        settings.maxQueueLength = config.value("max_queue_length", settings.maxQueueLength);
+    } catch (const std::exception& exception) {
+        ofLogError("example_server") << "Failed to load server_config.json: " << exception.what();
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "LlamaOpenAIServer.h"
+
+// Headless app that serves a local .gguf model over an OpenAI-compatible API,
+// so other machines in an installation can share one engine. Point
+// remote_api_config.json of the other examples at the printed URL.
+class ofApp : public ofBaseApp {
+public:
+    ~ofApp();
+
+    void setup();
+    void update();
+
+private:
+    void loadConfigFromFile();
+    std::string findModelPath() const;
+
+    LlamaOpenAIServer server;
+    LlamaOpenAIServerSettings settings;
+    std::string host = "0.0.0.0";
+    int port = 8080;
+    std::string modelFile;
+    int contextSize = 2048;
+    int gpuLayers = 0;
+    std::vector<std::string> rpcServers;
+    std::vector<float> tensorSplit;
+
+    float lastReportTime = 0.0f;
+    std::size_t lastReportedRequests = 0;
+};
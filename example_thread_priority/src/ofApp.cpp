@@ -0,0 +1,232 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "ofApp.h"
+
+#include <fstream>
+#include <iomanip>
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+    ofBackground(0);
+    // Without vsync a starved render thread shows up as longer frames
+    // instead of being hidden behind the display's refresh.
+    ofSetVerticalSync(false);
+
+    loadConfigFromFile();
+    ofSetFrameRate(frameRate);
+
+    std::string modelPath = modelFile.empty() ? "" : ofToDataPath(modelFile);
+    if (modelPath.empty()) {
+        ofDirectory modelsDir(ofToDataPath("models"));
+        modelsDir.allowExt("gguf");
+        modelsDir.listDir();
+        modelsDir.sort();
+        if (modelsDir.size() > 0) {
+            modelPath = modelsDir.getPath(0);
+        }
+    }
+    if (modelPath.empty() || !llama.loadModel(modelPath)) {
+        status = "No model loaded. Put a .gguf file into data/models.";
+        finished = true;
+        return;
+    }
+
+    llama.setTokenCallback([this](const std::string&) {
+        const uint64_t now = ofGetElapsedTimeMicros();
+        if (tokenCount++ == 0) {
+            firstTokenMicros = now;
+        }
+        lastTokenMicros = now;
+    });
+
+    status = "Measuring the frame rate without generation...";
+    phaseStart = ofGetElapsedTimef();
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+    if (finished) {
+        return;
+    }
+
+    frameTimes.push_back(ofGetLastFrameTime() * 1000.0f);
+
+    if (!baselineDone) {
+        if (ofGetElapsedTimef() - phaseStart >= baselineSeconds) {
+            results.push_back(summarize("baseline, no generation", frameTimes));
+            baselineDone = true;
+            startRun();
+        }
+        return;
+    }
+
+    if (running && !llama.isGenerating()) {
+        finishRun();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::startRun() {
+    if (currentRun >= runs.size()) {
+        finished = true;
+        status = "Done.";
+        writeCsv();
+        return;
+    }
+
+    const Run& run = runs[currentRun];
+    llama.setThreadPriority(run.priority);
+    llama.setReservedCores(run.reservedCores);
+    llama.setThreadCount(run.threads);
+
+    tokenCount = 0;
+    firstTokenMicros = 0;
+    lastTokenMicros = 0;
+    frameTimes.clear();
+
+    status = "Run " + ofToString(currentRun + 1) + "/" + ofToString(runs.size()) + ": " + run.name
+             + " (" + ofToString(llama.getThreadCount()) + " threads)";
+    ofLogNotice("example_thread_priority") << status;
+    llama.startGeneration(prompt, tokensPerRun);
+    running = true;
+}
+
+//--------------------------------------------------------------
+void ofApp::finishRun() {
+    running = false;
+
+    Result result = summarize(runs[currentRun].name, frameTimes);
+    result.threads = llama.getThreadCount();
+    const float seconds = (lastTokenMicros - firstTokenMicros) / 1000000.0f;
+    if (tokenCount > 1 && seconds > 0.0f) {
+        result.tokensPerSecond = (tokenCount - 1) / seconds;
+    }
+    results.push_back(result);
+
+    ++currentRun;
+    startRun();
+}
+
+//--------------------------------------------------------------
+ofApp::Result ofApp::summarize(const std::string& name, std::vector<float>& times) const {
+    Result result;
+    result.name = name;
+    if (times.empty()) {
+        return result;
+    }
+
+    std::sort(times.begin(), times.end());
+    const std::size_t last = times.size() - 1;
+    result.frameP50 = times[last / 2];
+    result.frameP99 = times[std::min(last, static_cast<std::size_t>(times.size() * 0.99))];
+    result.frameMax = times[last];
+
+    const float lateThreshold = 1.5f * 1000.0f / std::max(1, frameRate);
+    const auto late = std::count_if(times.begin(), times.end(), [&](float time) { return time > lateThreshold; });
+    result.lateFrames = static_cast<float>(late) / times.size();
+    return result;
+}
+
+//--------------------------------------------------------------
+void ofApp::draw() {
+    // The render load: particles moved by noise on the CPU every frame.
+    const float time = ofGetElapsedTimef() * 0.2f;
+    ofMesh mesh;
+    mesh.setMode(OF_PRIMITIVE_POINTS);
+    for (int i = 0; i < particles; ++i) {
+        mesh.addVertex(glm::vec3(ofNoise(i * 0.013f, time) * ofGetWidth(),
+                                 ofNoise(i * 0.017f + 100.0f, time) * ofGetHeight(), 0.0f));
+    }
+    ofSetColor(80, 200, 255, 160);
+    mesh.draw();
+
+    std::ostringstream table;
+    table << std::fixed << std::setprecision(1);
+    table << std::left << std::setw(30) << "run" << std::right << std::setw(8) << "threads" << std::setw(8) << "tok/s"
+          << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << std::setw(8) << "late" << "\n";
+    for (const Result& result : results) {
+        table << std::left << std::setw(30) << result.name.substr(0, 29) << std::right
+              << std::setw(8) << result.threads << std::setw(8) << result.tokensPerSecond
+              << std::setw(10) << result.frameP50 << std::setw(10) << result.frameP99 << std::setw(10) << result.frameMax
+              << std::setw(7) << result.lateFrames * 100.0f << "%\n";
+    }
+
+    ofSetColor(0, 0, 0, 200);
+    ofDrawRectangle(10, 10, 760, 60 + 14 * results.size());
+    ofSetColor(255);
+    ofDrawBitmapString(ofToString(ofGetFrameRate(), 0) + " fps, " + ofToString(particles) + " particles", 20, 30);
+    ofDrawBitmapString(status, 20, 46);
+    ofDrawBitmapString(table.str(), 20, 70);
+}
+
+//--------------------------------------------------------------
+void ofApp::writeCsv() const {
+    const std::string path = ofToDataPath(resultsCsv);
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        ofLogError("example_thread_priority") << "Cannot open " << path << " for writing.";
+        return;
+    }
+
+    file << "run,threads,tokens_per_second,frame_p50_ms,frame_p99_ms,frame_max_ms,late_frames\n";
+    for (const Result& result : results) {
+        file << "\"" << result.name << "\"," << result.threads << "," << result.tokensPerSecond << ","
+             << result.frameP50 << "," << result.frameP99 << "," << result.frameMax << "," << result.lateFrames << "\n";
+    }
+    ofLogNotice("example_thread_priority") << "Wrote " << path;
+}
+
+//--------------------------------------------------------------
+void ofApp::loadConfigFromFile() {
+    const std::string configPath = ofToDataPath("thread_priority_config.json");
+    if (ofFile::doesFileExist(configPath)) {
+        try {
+            const ofJson config = ofLoadJson(configPath);
+            modelFile = config.value("model", modelFile);
+            prompt = config.value("prompt", prompt);
+            tokensPerRun = config.value("tokens_per_run", tokensPerRun);
+            baselineSeconds = config.value("baseline_seconds", baselineSeconds);
+            frameRate = config.value("frame_rate", frameRate);
+            particles = config.value("particles", particles);
+            resultsCsv = config.value("results_csv", resultsCsv);
+
+            if (config.contains("runs") && config["runs"].is_array()) {
+                for (const auto& entry : config["runs"]) {
+                    Run run;
+                    run.name = entry.value("name", std::string("run ") + ofToString(runs.size() + 1));
+                    const std::string priority = entry.value("priority", std::string("normal"));
+                    if (priority == "low") {
+                        run.priority = ofxLlamaCpp::ThreadPriority::LOW;
+                    } else if (priority == "idle") {
+                        run.priority = ofxLlamaCpp::ThreadPriority::IDLE;
+                    }
+                    run.reservedCores = entry.value("reserved_cores", 0);
+                    run.threads = entry.value("threads", 0);
+                    runs.push_back(run);
+                }
+            }
+        } catch (const std::exception& exception) {
+            ofLogError("example_thread_priority") << "Failed to load thread_priority_config.json: " << exception.what();
+        }
+    } else {
+        ofLogNotice("example_thread_priority") << "thread_priority_config.json not found, using defaults.";
+    }
+
+    if (runs.empty()) {
+        Run normal;
+        normal.name = "normal, all cores";
+        Run idle;
+        idle.name = "idle, all cores";
+        idle.priority = ofxLlamaCpp::ThreadPriority::IDLE;
+        runs = {normal, idle};
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * ofxLlamaCpp
+ *
+ * Copyright (c) 2025 Yannick Hofmann
+ * <contact@yannickhofmann.de>
+ *
+ * BSD Simplified License.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ofxLlamaCpp.h"
+
+#include <atomic>
+
+// Benchmarks how generation threads affect the frame rate. The app renders a
+// particle field while the model generates once per configured run, each with
+// a different thread priority and reserved-core setting, and reports frame
+// times next to tokens per second. Settings are in
+// data/thread_priority_config.json; results are shown and written as CSV.
+class ofApp : public ofBaseApp {
+public:
+    void setup();
+    void update();
+    void draw();
+
+private:
+    struct Run {
+        std::string name;
+        ofxLlamaCpp::ThreadPriority priority = ofxLlamaCpp::ThreadPriority::NORMAL;
+        int reservedCores = 0;
+        int threads = 0;
+    };
+
+    struct Result {
+        std::string name;
+        int threads = 0;
+        float tokensPerSecond = 0.0f;
+        float frameP50 = 0.0f;  // Milliseconds
+        float frameP99 = 0.0f;
+        float frameMax = 0.0f;
+        float lateFrames = 0.0f; // Share of frames over 1.5 frame intervals
+    };
+
+    void loadConfigFromFile();
+    void startRun();
+    void finishRun();
+    Result summarize(const std::string& name, std::vector<float>& times) const;
+    void writeCsv() const;
+
+    ofxLlamaCpp llama;
+    std::string modelFile;
+    std::string prompt = "User: Describe a walk through a city at night in a few paragraphs.\nAssistant:";
+    int tokensPerRun = 256;
+    float baselineSeconds = 5.0f;
+    int frameRate = 60;
+    int particles = 20000;
+    std::string resultsCsv = "thread_priority_results.csv";
+    std::vector<Run> runs;
+
+    std::vector<Result> results;
+    std::vector<float> frameTimes;
+    std::size_t currentRun = 0;
+    bool baselineDone = false;
+    bool running = false;
+    bool finished = false;
+    float phaseStart = 0.0f;
+    std::string status;
+
+    // Written by the token callback on the generation thread.
+    std::atomic<int> tokenCount{0};
+    std::atomic<uint64_t> firstTokenMicros{0};
+    std::atomic<uint64_t> lastTokenMicros{0};
+};
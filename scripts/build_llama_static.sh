@@ -8,6 +8,7 @@ BUILD_DIR=""
 CLEAN_BUILD=0
 PURGE_BUILD=0
 PURGE_ALL=0
+ENABLE_RPC=0
 
 while [[ $# -gt 0 ]]; do
     case "$1" in
@@ -27,6 +28,10 @@ while [[ $# -gt 0 ]]; do
             PURGE_ALL=1
             shift
             ;;
+        --rpc)
+            ENABLE_RPC=1
+            shift
+            ;;
         *)
             echo "Unknown argument: $1"
             exit 1
@@ -81,6 +86,11 @@ else
     exit 1
 fi
 
+if [[ "$ENABLE_RPC" == "1" ]]; then
+    echo "Enabling GGML_RPC"
+    CMAKE_FLAGS+=" -DGGML_RPC=ON"
+fi
+
 cd "$( dirname "${BASH_SOURCE[0]}" )/.."
 ADDON_DIR="$(pwd)"
 ADDONS_DIR="$(cd .. && pwd)"
@@ -140,6 +150,12 @@ copy_if_exists "$BUILD_DIR/common/libcommon.a" "$LLAMA_DIR/$DEST_DIR/"
 copy_if_exists "$BUILD_DIR/tools/mtmd/libmtmd.a" "$LLAMA_DIR/$DEST_DIR/"
 copy_if_exists "$BUILD_DIR/vendor/cpp-httplib/libcpp-httplib.a" "$LLAMA_DIR/$DEST_DIR/"
 
+if [[ "$ENABLE_RPC" == "1" ]]; then
+    # The RPC worker runs on the machines that hold part of the model.
+    copy_if_exists "$BUILD_DIR/ggml/src/ggml-rpc/libggml-rpc.a" "$LLAMA_DIR/$DEST_DIR/"
+    copy_if_exists "$BUILD_DIR/bin/rpc-server" "$LLAMA_DIR/$DEST_DIR/"
+fi
+
 if [[ "$OSTYPE" == "linux-gnu"* ]]; then
     copy_if_exists "$BUILD_DIR/ggml/src/ggml-cuda/libggml-cuda.a" "$LLAMA_DIR/$DEST_DIR/"
     copy_if_exists "$BUILD_DIR/ggml/src/ggml-blas/libggml-blas.a" "$LLAMA_DIR/$DEST_DIR/"
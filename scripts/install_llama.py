@@ -21,6 +21,7 @@ def parse_args():
     parser = argparse.ArgumentParser(description="Run setup_libs first and then build_llama_static.")
     parser.add_argument("--enable-cuda", action="store_true")
     parser.add_argument("--enable-vulkan", action="store_true")
+    parser.add_argument("--enable-rpc", action="store_true")
     parser.add_argument("--clean", action="store_true")
     parser.add_argument("--purge-build", action="store_true")
     parser.add_argument("--purge-all", action="store_true")
@@ -92,6 +93,8 @@ def main():
             build_cmd.append("-EnableCuda")
         if args.enable_vulkan:
             build_cmd.append("-EnableVulkan")
+        if args.enable_rpc:
+            print("Warning: --enable-rpc is only supported on Linux and macOS.", flush=True)
         if args.clean:
             build_cmd.append("-Clean")
         if args.purge_build:
@@ -119,6 +122,8 @@ def main():
             build_cmd.append("--purge-build")
         if args.purge_all:
             build_cmd.append("--purge-all")
+        if args.enable_rpc:
+            build_cmd.append("--rpc")
         if args.enable_cuda:
             print("Warning: --enable-cuda is not required on Linux/macOS because build_llama_static.sh auto-detects CUDA.", flush=True)
         if args.enable_vulkan:
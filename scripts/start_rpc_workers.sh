@@ -0,0 +1,101 @@
+#!/bin/bash
+
+set -euo pipefail
+
+# Starts ggml RPC workers that hold part of a model for ofxLlamaCpp::setRpcServers().
+# On each extra machine run it once with --host 0.0.0.0; to try distribution on one
+# machine, start several workers on loopback with --count.
+#
+# rpc-server is built by: python install_llama.py --enable-rpc
+# The protocol is unauthenticated, so only expose workers on a trusted network.
+
+HOST="127.0.0.1"
+PORT=50052
+COUNT=1
+THREADS=""
+RPC_SERVER=""
+EXTRA_ARGS=()
+
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --host)
+            HOST="$2"
+            shift 2
+            ;;
+        --port)
+            PORT="$2"
+            shift 2
+            ;;
+        --count)
+            COUNT="$2"
+            shift 2
+            ;;
+        --threads)
+            THREADS="$2"
+            shift 2
+            ;;
+        --rpc-server)
+            RPC_SERVER="$2"
+            shift 2
+            ;;
+        --)
+            # Everything after -- is passed to rpc-server unchanged.
+            shift
+            EXTRA_ARGS=("$@")
+            break
+            ;;
+        *)
+            echo "Unknown argument: $1"
+            echo "Usage: $0 [--host H] [--port P] [--count N] [--threads T] [--rpc-server PATH] [-- rpc-server options]"
+            exit 1
+            ;;
+    esac
+done
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="$SCRIPT_DIR/../libs/llama.cpp/lib"
+
+if [[ -z "$RPC_SERVER" ]]; then
+    if [[ "$OSTYPE" == "darwin"* ]]; then
+        RPC_SERVER="$LIB_DIR/osx-arm64/rpc-server"
+    elif [[ "$(uname -m)" == "aarch64" || "$(uname -m)" == "arm64" ]]; then
+        RPC_SERVER="$LIB_DIR/linuxaarch64/rpc-server"
+    else
+        RPC_SERVER="$LIB_DIR/linux64/rpc-server"
+    fi
+fi
+
+if [[ ! -x "$RPC_SERVER" ]]; then
+    echo "Error: rpc-server not found at $RPC_SERVER. Run install_llama.py --enable-rpc first."
+    exit 1
+fi
+
+PIDS=()
+stop_workers() {
+    if [[ ${#PIDS[@]} -gt 0 ]]; then
+        kill "${PIDS[@]}" 2>/dev/null || true
+        wait "${PIDS[@]}" 2>/dev/null || true
+    fi
+}
+trap stop_workers EXIT INT TERM
+
+ENDPOINTS=""
+for ((i = 0; i < COUNT; i++)); do
+    WORKER_PORT=$((PORT + i))
+    ARGS=(-H "$HOST" -p "$WORKER_PORT")
+    if [[ -n "$THREADS" ]]; then
+        ARGS+=(-t "$THREADS")
+    fi
+
+    "$RPC_SERVER" "${ARGS[@]}" "${EXTRA_ARGS[@]+"${EXTRA_ARGS[@]}"}" &
+    PIDS+=($!)
+    ENDPOINTS+="${ENDPOINTS:+, }\"$HOST:$WORKER_PORT\""
+done
+
+echo "========================================="
+echo "Started $COUNT RPC worker(s). Use them with:"
+echo "  \"rpc_servers\": [$ENDPOINTS]"
+echo "Press Ctrl+C to stop."
+echo "========================================="
+
+wait
@@ -0,0 +1,227 @@
+#include "AdmissionControlProvider.h"
+
+#include "ofMain.h"
+
+#include <algorithm>
+
+namespace {
+    // Bounds how long a cancelled request can sit in the queue unnoticed.
+    const std::chrono::milliseconds CANCEL_POLL_INTERVAL(20);
+    const std::size_t MAX_WAIT_SAMPLES = 256;
+}
+
+AdmissionControlProvider::AdmissionControlProvider(std::shared_ptr<IInferenceProvider> provider,
+                                                   const AdmissionPolicy& policy)
+: provider(provider)
+, policy(policy) {
+    this->policy.maxConcurrent = std::max<std::size_t>(1, policy.maxConcurrent);
+}
+
+bool AdmissionControlProvider::setup(const std::string& modelOrUrl) {
+    if (!provider) {
+        ofLogError("AdmissionControlProvider") << "No provider to set up.";
+        return false;
+    }
+    return provider->setup(modelOrUrl);
+}
+
+std::string AdmissionControlProvider::generate(const std::string& prompt) {
+    if (!acquire(nullptr)) {
+        return "";
+    }
+    Slot slot(*this);
+    return provider->generate(prompt);
+}
+
+std::string AdmissionControlProvider::generateChat(const std::vector<InferenceChatMessage>& messages) {
+    if (!acquire(nullptr)) {
+        return "";
+    }
+    Slot slot(*this);
+    return provider->generateChat(messages);
+}
+
+std::string AdmissionControlProvider::generateStream(const std::string& prompt,
+                                                     InferenceTokenCallback onToken,
+                                                     std::shared_ptr<InferenceCancellationToken> cancel) {
+    if (!acquire(cancel)) {
+        return "";
+    }
+    Slot slot(*this);
+    return provider->generateStream(prompt, onToken, cancel);
+}
+
+std::string AdmissionControlProvider::generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                                         InferenceTokenCallback onToken,
+                                                         std::shared_ptr<InferenceCancellationToken> cancel) {
+    if (!acquire(cancel)) {
+        return "";
+    }
+    Slot slot(*this);
+    return provider->generateChatStream(messages, onToken, cancel);
+}
+
+bool AdmissionControlProvider::isRemote() const {
+    return provider && provider->isRemote();
+}
+
+long long AdmissionControlProvider::getCompletionTokenCount() const {
+    return provider ? provider->getCompletionTokenCount() : -1;
+}
+
+std::shared_ptr<IInferenceProvider> AdmissionControlProvider::getProvider() const {
+    return provider;
+}
+
+void AdmissionControlProvider::setPolicy(const AdmissionPolicy& newPolicy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policy = newPolicy;
+    policy.maxConcurrent = std::max<std::size_t>(1, newPolicy.maxConcurrent);
+    // A higher limit may free slots for requests already waiting.
+    admitWaitingLocked();
+}
+
+AdmissionPolicy AdmissionControlProvider::getPolicy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return policy;
+}
+
+AdmissionStats AdmissionControlProvider::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    AdmissionStats result = stats;
+    result.running = running;
+    result.queued = queue.size();
+
+    if (!recentWaits.empty()) {
+        std::vector<double> sorted(recentWaits.begin(), recentWaits.end());
+        const std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(0.95 * sorted.size()));
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        result.p95WaitSeconds = sorted[index];
+    }
+    if (stats.admitted > 0) {
+        result.averageWaitSeconds = totalWaitSeconds / stats.admitted;
+    }
+    return result;
+}
+
+void AdmissionControlProvider::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats = AdmissionStats();
+    totalWaitSeconds = 0.0;
+    recentWaits.clear();
+}
+
+bool AdmissionControlProvider::acquire(const std::shared_ptr<InferenceCancellationToken>& cancel) {
+    if (!provider) {
+        ofLogError("AdmissionControlProvider") << "No provider to send the request to.";
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (running < policy.maxConcurrent && queue.empty()) {
+        ++running;
+        recordWaitLocked(0.0);
+        return true;
+    }
+
+    if (queue.size() >= policy.maxQueueLength) {
+        if (policy.shedPolicy == AdmissionShedPolicy::REJECT_NEWEST || queue.empty()) {
+            ++stats.rejected;
+            ofLogWarning("AdmissionControlProvider") << "Queue full (" << queue.size() << " waiting), request rejected.";
+            return false;
+        }
+
+        queue.front()->state = Waiter::State::SHED;
+        queue.pop_front();
+        changed.notify_all();
+    }
+
+    auto waiter = std::make_shared<Waiter>();
+    waiter->enqueuedAt = Clock::now();
+    if (policy.maxQueueWaitSeconds > 0.0) {
+        waiter->hasDeadline = true;
+        waiter->deadline = waiter->enqueuedAt
+            + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(policy.maxQueueWaitSeconds));
+    }
+    queue.push_back(waiter);
+
+    while (true) {
+        switch (waiter->state) {
+            case Waiter::State::ADMITTED:
+                return true;
+            case Waiter::State::SHED:
+                ++stats.shed;
+                ofLogWarning("AdmissionControlProvider") << "Request dropped from the queue to make room.";
+                return false;
+            case Waiter::State::EXPIRED:
+                ++stats.expired;
+                ofLogWarning("AdmissionControlProvider") << "Request waited too long for a slot.";
+                return false;
+            case Waiter::State::WAITING:
+                break;
+        }
+
+        const Clock::time_point now = Clock::now();
+        const bool cancelled = cancel && cancel->isCancelled();
+        if (cancelled || (waiter->hasDeadline && now >= waiter->deadline)) {
+            queue.erase(std::find(queue.begin(), queue.end(), waiter));
+            if (cancelled) {
+                ++stats.cancelled;
+                return false;
+            }
+            waiter->state = Waiter::State::EXPIRED;
+            continue;
+        }
+
+        Clock::time_point wakeAt = now + CANCEL_POLL_INTERVAL;
+        if (waiter->hasDeadline) {
+            wakeAt = std::min(wakeAt, waiter->deadline);
+        }
+        changed.wait_until(lock, wakeAt);
+    }
+}
+
+void AdmissionControlProvider::release() {
+    std::lock_guard<std::mutex> lock(mutex);
+    --running;
+    ++stats.completed;
+    admitWaitingLocked();
+}
+
+void AdmissionControlProvider::admitWaitingLocked() {
+    const Clock::time_point now = Clock::now();
+    bool admittedAny = false;
+
+    while (running < policy.maxConcurrent && !queue.empty()) {
+        std::shared_ptr<Waiter> waiter = queue.front();
+        queue.pop_front();
+
+        // Past its deadline the caller has given up; do not spend a slot on it.
+        if (waiter->hasDeadline && now >= waiter->deadline) {
+            waiter->state = Waiter::State::EXPIRED;
+            admittedAny = true;
+            continue;
+        }
+
+        waiter->state = Waiter::State::ADMITTED;
+        ++running;
+        recordWaitLocked(std::chrono::duration<double>(now - waiter->enqueuedAt).count());
+        admittedAny = true;
+    }
+
+    if (admittedAny) {
+        changed.notify_all();
+    }
+}
+
+void AdmissionControlProvider::recordWaitLocked(double seconds) {
+    ++stats.admitted;
+    totalWaitSeconds += seconds;
+    stats.maxWaitSeconds = std::max(stats.maxWaitSeconds, seconds);
+
+    recentWaits.push_back(seconds);
+    if (recentWaits.size() > MAX_WAIT_SAMPLES) {
+        recentWaits.pop_front();
+    }
+}
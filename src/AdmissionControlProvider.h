@@ -0,0 +1,114 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What happens to a request that arrives while the queue is full.
+enum class AdmissionShedPolicy {
+    REJECT_NEWEST, // Turn the new request away; queued requests keep their place.
+    DROP_OLDEST    // Admit the new request to the queue and drop the longest waiting one.
+};
+
+struct AdmissionPolicy {
+    // Requests allowed to run on the wrapped provider at once.
+    std::size_t maxConcurrent = 1;
+    // Requests allowed to wait for a slot. 0 rejects everything that cannot start at once.
+    std::size_t maxQueueLength = 8;
+    AdmissionShedPolicy shedPolicy = AdmissionShedPolicy::REJECT_NEWEST;
+    // Longest time a request may wait for a slot before it is given up on.
+    // 0 waits indefinitely.
+    double maxQueueWaitSeconds = 10.0;
+};
+
+struct AdmissionStats {
+    std::size_t admitted = 0;
+    std::size_t completed = 0;
+    std::size_t rejected = 0; // Queue full on arrival.
+    std::size_t shed = 0;     // Dropped from the queue to make room.
+    std::size_t expired = 0;  // Queue wait exceeded maxQueueWaitSeconds.
+    std::size_t cancelled = 0;
+    std::size_t running = 0;
+    std::size_t queued = 0;
+    // Time admitted requests spent waiting for a slot.
+    double averageWaitSeconds = 0.0;
+    double p95WaitSeconds = 0.0;
+    double maxWaitSeconds = 0.0;
+};
+
+// Front-end that bounds the load put on another provider. At most
+// maxConcurrent requests run on it; the rest wait in a FIFO queue of bounded
+// length and are shed according to the policy when it overflows. Requests
+// that wait past their deadline, are shed or rejected return "" without
+// reaching the wrapped provider, so admitted requests keep a predictable
+// latency under bursts.
+class AdmissionControlProvider : public IInferenceProvider {
+public:
+    explicit AdmissionControlProvider(std::shared_ptr<IInferenceProvider> provider,
+                                      const AdmissionPolicy& policy = AdmissionPolicy());
+
+    bool setup(const std::string& modelOrUrl) override;
+    std::string generate(const std::string& prompt) override;
+    std::string generateChat(const std::vector<InferenceChatMessage>& messages) override;
+    std::string generateStream(const std::string& prompt,
+                               InferenceTokenCallback onToken,
+                               std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    std::string generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                   InferenceTokenCallback onToken,
+                                   std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    bool isRemote() const override;
+    long long getCompletionTokenCount() const override;
+
+    std::shared_ptr<IInferenceProvider> getProvider() const;
+
+    // Takes effect for requests that arrive or are admitted afterwards.
+    void setPolicy(const AdmissionPolicy& policy);
+    AdmissionPolicy getPolicy() const;
+
+    AdmissionStats getStats() const;
+    void resetStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Waiter {
+        enum class State { WAITING, ADMITTED, SHED, EXPIRED };
+        State state = State::WAITING;
+        Clock::time_point enqueuedAt;
+        Clock::time_point deadline;
+        bool hasDeadline = false;
+    };
+
+    // Releases the slot taken by acquire() when it goes out of scope.
+    class Slot {
+    public:
+        explicit Slot(AdmissionControlProvider& owner) : owner(owner) {}
+        ~Slot() { owner.release(); }
+    private:
+        AdmissionControlProvider& owner;
+    };
+
+    bool acquire(const std::shared_ptr<InferenceCancellationToken>& cancel);
+    void release();
+    void admitWaitingLocked();
+    void recordWaitLocked(double seconds);
+
+    std::shared_ptr<IInferenceProvider> provider;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    AdmissionPolicy policy;
+    std::deque<std::shared_ptr<Waiter>> queue;
+    std::size_t running = 0;
+
+    AdmissionStats stats;
+    double totalWaitSeconds = 0.0;
+    std::deque<double> recentWaits;
+};
@@ -3,8 +3,8 @@
 #include "RemoteAPIProvider.h"
 #include "ofxLlamaCpp.h"
 
-#include <chrono>
-#include <thread>
+#include <atomic>
+#include <mutex>
 
 namespace {
     // Lightweight adapter that lets the example apps use the same provider
@@ -24,35 +24,73 @@ namespace {
             llama.addStopWord("User:");
             llama.addStopWord("Assistant:");
 
+            modelPath = modelOrUrl;
             return true;
         }
 
         std::string generate(const std::string& prompt) override {
+            return generateStream(prompt, nullptr);
+        }
+
+        std::string generateStream(const std::string& prompt,
+                                   InferenceTokenCallback onToken,
+                                   std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override {
+            // One engine serves one request at a time; overlapping calls wait
+            // here instead of taking over each other's callbacks.
+            std::lock_guard<std::mutex> lock(requestMutex);
+
             if (!llama.isModelLoaded()) {
                 ofLogError("LocalLlamaProvider") << "No local model loaded.";
                 return "";
             }
 
+            // The sampler chain ends in greedy selection, so a given model, prompt
+            // and token limit always produce the same text and are safe to cache.
+            const std::string cacheKey = responseCache
+                ? InferenceResponseCache::fingerprint(modelPath + "\n" + std::to_string(MAX_TOKENS) + "\n" + prompt)
+                : "";
             std::string output;
-
-            llama.stopGeneration();
-            llama.startGeneration(prompt, 1024);
-
-            while (llama.isGenerating()) {
-                output += llama.getNewOutput();
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (!cacheKey.empty() && responseCache->lookup(cacheKey, output)) {
+                completionTokens += static_cast<long long>(llama.tokenize(output).size());
+                if (!output.empty() && onToken) {
+                    onToken(output);
+                }
+                return output;
             }
 
-            output += llama.getNewOutput();
-            return output;
+            const ofxLlamaCpp::BlockingResult result = llama.generateBlocking(prompt, MAX_TOKENS,
+                [&](const std::string& piece) {
+                    if (onToken) {
+                        onToken(piece);
+                    }
+                    return true;
+                },
+                [&]() {
+                    return cancel && cancel->isCancelled();
+                });
+            completionTokens += result.tokens;
+
+            if (!result.interrupted && !cacheKey.empty() && !result.text.empty()) {
+                responseCache->store(cacheKey, result.text);
+            }
+            return result.text;
         }
 
         bool isRemote() const override {
             return false;
         }
 
+        long long getCompletionTokenCount() const override {
+            return completionTokens;
+        }
+
     private:
+        static const int MAX_TOKENS = 1024;
+
+        std::mutex requestMutex;
         ofxLlamaCpp llama;
+        std::string modelPath;
+        std::atomic<long long> completionTokens{0};
     };
 }
 
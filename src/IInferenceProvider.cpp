@@ -1,3 +1,61 @@
 #include "IInferenceProvider.h"
 
+#include <cctype>
+
+void InferenceCancellationToken::cancel() {
+    cancelled = true;
+}
+
+bool InferenceCancellationToken::isCancelled() const {
+    return cancelled;
+}
+
 IInferenceProvider::~IInferenceProvider() = default;
+
+std::string IInferenceProvider::generateChat(const std::vector<InferenceChatMessage>& messages) {
+    return generate(formatChatTranscript(messages));
+}
+
+std::string IInferenceProvider::generateStream(const std::string& prompt,
+                                               InferenceTokenCallback onToken,
+                                               std::shared_ptr<InferenceCancellationToken> cancel) {
+    // Fallback for backends that cannot stream: deliver the reply as one piece.
+    if (cancel && cancel->isCancelled()) {
+        return "";
+    }
+
+    const std::string reply = generate(prompt);
+    if (!reply.empty() && onToken && !(cancel && cancel->isCancelled())) {
+        onToken(reply);
+    }
+    return reply;
+}
+
+std::string IInferenceProvider::generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                                   InferenceTokenCallback onToken,
+                                                   std::shared_ptr<InferenceCancellationToken> cancel) {
+    return generateStream(formatChatTranscript(messages), onToken, cancel);
+}
+
+long long IInferenceProvider::getCompletionTokenCount() const {
+    return -1;
+}
+
+void IInferenceProvider::setResponseCache(std::shared_ptr<InferenceResponseCache> cache) {
+    responseCache = cache;
+}
+
+std::shared_ptr<InferenceResponseCache> IInferenceProvider::getResponseCache() const {
+    return responseCache;
+}
+
+std::string IInferenceProvider::formatChatTranscript(const std::vector<InferenceChatMessage>& messages) {
+    std::string transcript;
+    for (const auto& message : messages) {
+        std::string role = message.role.empty() ? "user" : message.role;
+        role[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(role[0])));
+        transcript += role + ": " + message.content + "\n";
+    }
+    transcript += "Assistant:";
+    return transcript;
+}
@@ -1,6 +1,32 @@
 #pragma once
 
+#include "InferenceResponseCache.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+
+// Represents a single chat message in the OpenAI-compatible "messages" array.
+struct InferenceChatMessage {
+    std::string role;
+    std::string content;
+};
+
+// Receives incremental text while a reply is being produced.
+using InferenceTokenCallback = std::function<void(const std::string&)>;
+
+// Lets one thread abort a request that is running on another. A token can be
+// handed to several requests; cancelling it stops all of them.
+class InferenceCancellationToken {
+public:
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::atomic<bool> cancelled{false};
+};
 
 // Small backend abstraction used by the examples so they can talk to either
 // a local llama.cpp runtime or a remote HTTP API through the same interface.
@@ -13,6 +39,33 @@ public:
     virtual bool setup(const std::string& modelOrUrl) = 0;
     // Runs a single prompt and returns the fully collected response text.
     virtual std::string generate(const std::string& prompt) = 0;
+    // Runs a chat history instead of a single prompt.
+    virtual std::string generateChat(const std::vector<InferenceChatMessage>& messages);
+    // Streaming variants. onToken is called on the calling thread for every new
+    // piece of text, and the full reply is returned at the end. When cancel is
+    // triggered the request stops early and the partial reply is returned.
+    virtual std::string generateStream(const std::string& prompt,
+                                       InferenceTokenCallback onToken,
+                                       std::shared_ptr<InferenceCancellationToken> cancel = nullptr);
+    virtual std::string generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                           InferenceTokenCallback onToken,
+                                           std::shared_ptr<InferenceCancellationToken> cancel = nullptr);
     // Allows the UI examples to branch between local and remote behavior.
     virtual bool isRemote() const = 0;
+    // Reply tokens produced since the provider was created, for throughput
+    // measurements such as InferenceLoadTest. -1 when the backend cannot
+    // count them (the default).
+    virtual long long getCompletionTokenCount() const;
+
+    // Attaches a response cache consulted before each request. One cache may be
+    // shared by several providers; pass nullptr to disable caching.
+    void setResponseCache(std::shared_ptr<InferenceResponseCache> cache);
+    std::shared_ptr<InferenceResponseCache> getResponseCache() const;
+
+    // Plain-text transcript ("User: ...\nAssistant:") for backends without a
+    // chat API. LlamaOpenAIServer uses it too, so served and local chats match.
+    static std::string formatChatTranscript(const std::vector<InferenceChatMessage>& messages);
+
+protected:
+    std::shared_ptr<InferenceResponseCache> responseCache;
 };
@@ -0,0 +1,377 @@
+#include "InferenceLoadTest.h"
+
+#include "ofMain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Bounds how long a stopped level keeps sleeping between arrivals.
+    const std::chrono::milliseconds CANCEL_POLL_INTERVAL(20);
+
+    const char* const PROMPT_PREFIX = "Summarize the following notes in a few sentences:";
+    const char* const PROMPT_WORDS[] = {
+        "the", "system", "request", "model", "latency", "network", "user", "token",
+        "queue", "server", "memory", "batch", "reply", "stream", "cache", "context",
+        "visitor", "gallery", "screen", "sensor", "light", "sound", "project", "frame",
+        "morning", "evening", "quickly", "slowly", "because", "while", "after", "before"
+    };
+
+    double secondsBetween(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    }
+
+    // Sleeps until the given time; false if cancelled first.
+    bool sleepUntil(Clock::time_point until, const std::shared_ptr<InferenceCancellationToken>& cancel) {
+        while (true) {
+            if (cancel->isCancelled()) {
+                return false;
+            }
+            const auto now = Clock::now();
+            if (now >= until) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::min<Clock::duration>(until - now, CANCEL_POLL_INTERVAL));
+        }
+    }
+
+    // Tokens produced between two readings of getCompletionTokenCount(), or
+    // -1 when the provider cannot count them.
+    long long tokensBetween(long long start, long long end) {
+        return start >= 0 && end >= start ? end - start : -1;
+    }
+
+    // Nearest-rank percentile of a sorted list.
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    }
+
+    const char* levelLabel(LoadArrivalMode mode) {
+        return mode == LoadArrivalMode::POISSON ? "arrivals/s" : "users";
+    }
+}
+
+// Collects the samples of one level. Poisson requests run on detached threads,
+// so they hold it through a shared_ptr.
+struct InferenceLoadTest::Level {
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::vector<Sample> samples;
+    std::size_t inFlight = 0;
+};
+
+InferenceLoadTest::InferenceLoadTest(std::shared_ptr<IInferenceProvider> provider)
+: provider(provider) {
+}
+
+void InferenceLoadTest::setSettings(const InferenceLoadTestSettings& newSettings) {
+    settings = newSettings;
+}
+
+const InferenceLoadTestSettings& InferenceLoadTest::getSettings() const {
+    return settings;
+}
+
+std::vector<InferenceLoadLevelResult> InferenceLoadTest::run() {
+    std::vector<InferenceLoadLevelResult> results;
+    for (double level : settings.levels) {
+        if (stopped) {
+            break;
+        }
+
+        const InferenceLoadLevelResult result = runLevel(level);
+        if (stopped) {
+            // A level cut short says nothing about its load.
+            break;
+        }
+
+        ofLogNotice("InferenceLoadTest")
+            << levelLabel(settings.arrivalMode) << " " << level << ": "
+            << result.completed << "/" << result.sent << " ok, "
+            << result.requestsPerSecond << " req/s, " << result.tokensPerSecond
+            << (result.countedTokens ? " tok/s, " : " pieces/s, ")
+            << "ttft p50 " << result.ttftP50 << " s, latency p50 " << result.latencyP50
+            << " s, p99 " << result.latencyP99 << " s";
+        results.push_back(result);
+    }
+    return results;
+}
+
+InferenceLoadLevelResult InferenceLoadTest::runLevel(double level) {
+    if (!provider) {
+        ofLogError("InferenceLoadTest") << "No provider to test.";
+        return InferenceLoadLevelResult();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cancelMutex);
+        levelCancel = std::make_shared<InferenceCancellationToken>();
+        if (stopped) {
+            levelCancel->cancel();
+        }
+    }
+
+    return settings.arrivalMode == LoadArrivalMode::POISSON ? runPoisson(level) : runClosedLoop(level);
+}
+
+void InferenceLoadTest::stop() {
+    stopped = true;
+    std::lock_guard<std::mutex> lock(cancelMutex);
+    if (levelCancel) {
+        levelCancel->cancel();
+    }
+}
+
+bool InferenceLoadTest::isStopped() const {
+    return stopped;
+}
+
+InferenceLoadLevelResult InferenceLoadTest::runClosedLoop(double users) {
+    const std::size_t userCount = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(users)));
+    const std::shared_ptr<InferenceCancellationToken> cancel = levelCancel;
+    Level state;
+
+    const long long tokensAtStart = provider->getCompletionTokenCount();
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, settings.durationSeconds)));
+
+    std::vector<std::thread> threads;
+    for (std::size_t user = 0; user < userCount; ++user) {
+        threads.emplace_back([this, user, cancel, deadline, &state]() {
+            std::mt19937 random(settings.randomSeed + static_cast<unsigned int>(user));
+            while (!cancel->isCancelled() && Clock::now() < deadline) {
+                Sample sample = send(makePrompt(random), cancel);
+                sample.inWindow = Clock::now() <= deadline;
+                {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    state.samples.push_back(sample);
+                }
+
+                if (settings.thinkTimeSeconds > 0.0) {
+                    sleepUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(settings.thinkTimeSeconds)), cancel);
+                }
+            }
+        });
+    }
+
+    // Tokens are read at the end of the window, so replies still running
+    // after it do not count, as for requests per second.
+    sleepUntil(deadline, cancel);
+    const long long windowTokens = tokensBetween(tokensAtStart, provider->getCompletionTokenCount());
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const double measured = secondsBetween(start, std::min(Clock::now(), deadline));
+    return summarize(users, state.samples, measured, windowTokens);
+}
+
+InferenceLoadLevelResult InferenceLoadTest::runPoisson(double rate) {
+    const std::shared_ptr<InferenceCancellationToken> cancel = levelCancel;
+    const std::shared_ptr<Level> state = std::make_shared<Level>();
+    std::size_t dropped = 0;
+
+    const long long tokensAtStart = provider->getCompletionTokenCount();
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, settings.durationSeconds)));
+
+    if (rate > 0.0) {
+        std::mt19937 random(settings.randomSeed);
+        std::exponential_distribution<double> gap(rate);
+        Clock::time_point arrival = start;
+
+        while (true) {
+            arrival += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap(random)));
+            if (arrival >= deadline || !sleepUntil(arrival, cancel)) {
+                break;
+            }
+
+            // The prompt is drawn even for dropped arrivals so the sequence of
+            // prompts does not depend on how fast the backend is.
+            std::string prompt = makePrompt(random);
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->inFlight >= std::max<std::size_t>(1, settings.maxInFlight)) {
+                    ++dropped;
+                    continue;
+                }
+                ++state->inFlight;
+            }
+
+            std::thread([this, state, cancel, deadline, prompt = std::move(prompt)]() {
+                Sample sample = send(prompt, cancel);
+                sample.inWindow = Clock::now() <= deadline;
+
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->samples.push_back(sample);
+                --state->inFlight;
+                state->finished.notify_all();
+            }).detach();
+        }
+    }
+
+    sleepUntil(deadline, cancel);
+    const long long windowTokens = tokensBetween(tokensAtStart, provider->getCompletionTokenCount());
+    const double measured = secondsBetween(start, std::min(Clock::now(), deadline));
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state]() { return state->inFlight == 0; });
+
+    InferenceLoadLevelResult result = summarize(rate, state->samples, measured, windowTokens);
+    result.dropped = dropped;
+    return result;
+}
+
+InferenceLoadTest::Sample InferenceLoadTest::send(const std::string& prompt,
+                                                  const std::shared_ptr<InferenceCancellationToken>& cancel) const {
+    Sample sample;
+    Clock::time_point firstPieceAt;
+    bool receivedPiece = false;
+
+    const InferenceTokenCallback onToken = [&](const std::string&) {
+        if (!receivedPiece) {
+            firstPieceAt = Clock::now();
+            receivedPiece = true;
+        }
+        ++sample.pieces;
+    };
+
+    const Clock::time_point startedAt = Clock::now();
+    std::string reply;
+    if (settings.chat) {
+        const std::vector<InferenceChatMessage> messages = {{"user", prompt}};
+        reply = settings.streaming ? provider->generateChatStream(messages, onToken, cancel)
+                                   : provider->generateChat(messages);
+    } else {
+        reply = settings.streaming ? provider->generateStream(prompt, onToken, cancel)
+                                   : provider->generate(prompt);
+    }
+    const Clock::time_point finishedAt = Clock::now();
+
+    sample.succeeded = !reply.empty() && !cancel->isCancelled();
+    sample.latency = secondsBetween(startedAt, finishedAt);
+    sample.ttft = receivedPiece ? secondsBetween(startedAt, firstPieceAt) : sample.latency;
+    return sample;
+}
+
+std::string InferenceLoadTest::makePrompt(std::mt19937& random) const {
+    const std::size_t minWords = std::max<std::size_t>(1, settings.minPromptWords);
+    const std::size_t maxWords = std::max(minWords, settings.maxPromptWords);
+
+    std::lognormal_distribution<double> length(std::log(std::max(1.0, settings.promptWordsMedian)),
+                                               std::max(0.0, settings.promptWordsSpread));
+    const double drawn = std::round(length(random));
+    const std::size_t words = std::min<std::size_t>(maxWords, std::max<std::size_t>(minWords, drawn > 0.0 ? static_cast<std::size_t>(drawn) : 0));
+
+    std::uniform_int_distribution<std::size_t> pick(0, sizeof(PROMPT_WORDS) / sizeof(PROMPT_WORDS[0]) - 1);
+    std::string prompt = PROMPT_PREFIX;
+    for (std::size_t i = 0; i < words; ++i) {
+        prompt += ' ';
+        prompt += PROMPT_WORDS[pick(random)];
+    }
+    return prompt;
+}
+
+InferenceLoadLevelResult InferenceLoadTest::summarize(double level, const std::vector<Sample>& samples, double durationSeconds,
+                                                     long long windowTokens) {
+    InferenceLoadLevelResult result;
+    result.level = level;
+    result.countedTokens = windowTokens >= 0;
+    result.sent = samples.size();
+
+    std::vector<double> ttfts;
+    std::vector<double> latencies;
+    std::size_t windowReplies = 0;
+    std::size_t windowPieces = 0;
+
+    for (const auto& sample : samples) {
+        if (!sample.succeeded) {
+            ++result.failed;
+            continue;
+        }
+
+        ++result.completed;
+        ttfts.push_back(sample.ttft);
+        latencies.push_back(sample.latency);
+        if (sample.inWindow) {
+            ++windowReplies;
+            windowPieces += sample.pieces;
+        }
+    }
+
+    if (durationSeconds > 0.0) {
+        result.requestsPerSecond = windowReplies / durationSeconds;
+        result.tokensPerSecond = (result.countedTokens ? static_cast<double>(windowTokens) : windowPieces) / durationSeconds;
+    }
+
+    std::sort(ttfts.begin(), ttfts.end());
+    std::sort(latencies.begin(), latencies.end());
+    result.ttftP50 = percentile(ttfts, 0.50);
+    result.ttftP90 = percentile(ttfts, 0.90);
+    result.ttftP99 = percentile(ttfts, 0.99);
+    result.latencyP50 = percentile(latencies, 0.50);
+    result.latencyP90 = percentile(latencies, 0.90);
+    result.latencyP99 = percentile(latencies, 0.99);
+    return result;
+}
+
+std::string InferenceLoadTest::formatTable(const std::vector<InferenceLoadLevelResult>& results, LoadArrivalMode mode) {
+    // A provider either counts tokens or it does not, so the first level decides.
+    const bool countedTokens = results.empty() || results.front().countedTokens;
+    std::ostringstream table;
+    table << std::fixed << std::setprecision(2);
+    table << std::setw(10) << levelLabel(mode)
+          << std::setw(7) << "sent" << std::setw(7) << "ok" << std::setw(7) << "failed" << std::setw(8) << "dropped"
+          << std::setw(9) << "req/s" << std::setw(9) << (countedTokens ? "tok/s" : "pieces/s")
+          << std::setw(9) << "ttft50" << std::setw(9) << "ttft90" << std::setw(9) << "ttft99"
+          << std::setw(9) << "e2e50" << std::setw(9) << "e2e90" << std::setw(9) << "e2e99" << "\n";
+
+    for (const auto& result : results) {
+        table << std::setw(10) << result.level
+              << std::setw(7) << result.sent << std::setw(7) << result.completed
+              << std::setw(7) << result.failed << std::setw(8) << result.dropped
+              << std::setw(9) << result.requestsPerSecond << std::setw(9) << result.tokensPerSecond
+              << std::setw(9) << result.ttftP50 << std::setw(9) << result.ttftP90 << std::setw(9) << result.ttftP99
+              << std::setw(9) << result.latencyP50 << std::setw(9) << result.latencyP90 << std::setw(9) << result.latencyP99
+              << "\n";
+    }
+    return table.str();
+}
+
+bool InferenceLoadTest::writeCsv(const std::string& path, const std::vector<InferenceLoadLevelResult>& results, LoadArrivalMode mode) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        ofLogError("InferenceLoadTest") << "Cannot open " << path << " for writing.";
+        return false;
+    }
+
+    const bool countedTokens = results.empty() || results.front().countedTokens;
+    file << (mode == LoadArrivalMode::POISSON ? "arrivals_per_second" : "users")
+         << ",sent,completed,failed,dropped,requests_per_second"
+         << (countedTokens ? ",tokens_per_second" : ",pieces_per_second")
+         << ",ttft_p50,ttft_p90,ttft_p99,latency_p50,latency_p90,latency_p99\n";
+    for (const auto& result : results) {
+        file << result.level << "," << result.sent << "," << result.completed << ","
+             << result.failed << "," << result.dropped << ","
+             << result.requestsPerSecond << "," << result.tokensPerSecond << ","
+             << result.ttftP50 << "," << result.ttftP90 << "," << result.ttftP99 << ","
+             << result.latencyP50 << "," << result.latencyP90 << "," << result.latencyP99 << "\n";
+    }
+    return static_cast<bool>(file);
+}
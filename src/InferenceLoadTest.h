@@ -0,0 +1,118 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// How requests arrive during a load test.
+enum class LoadArrivalMode {
+    // A fixed number of users, each sending its next request once the previous
+    // reply is complete. Levels are user counts.
+    CLOSED_LOOP,
+    // Requests arrive at random at a fixed average rate whether or not earlier
+    // ones have finished, like independent visitors. Levels are requests per second.
+    POISSON
+};
+
+struct InferenceLoadTestSettings {
+    LoadArrivalMode arrivalMode = LoadArrivalMode::CLOSED_LOOP;
+    // Load levels to measure, in the order given.
+    std::vector<double> levels = {1, 2, 4, 8};
+    // How long requests are sent at each level. Requests still running at the
+    // end are waited for but do not count towards throughput.
+    double durationSeconds = 30.0;
+    // Closed loop only: pause between a reply and the same user's next request.
+    double thinkTimeSeconds = 0.0;
+    // Prompt lengths in words follow a log-normal distribution with this
+    // median and spread (sigma), clamped to [minPromptWords, maxPromptWords].
+    double promptWordsMedian = 64.0;
+    double promptWordsSpread = 0.5;
+    std::size_t minPromptWords = 4;
+    std::size_t maxPromptWords = 1024;
+    bool streaming = true;
+    // Send a one-message chat instead of a plain prompt.
+    bool chat = true;
+    // Poisson only: arrivals while this many requests are running are dropped
+    // and counted, so an overloaded backend cannot pile up unbounded threads.
+    std::size_t maxInFlight = 256;
+    unsigned int randomSeed = 1;
+};
+
+struct InferenceLoadLevelResult {
+    double level = 0.0;
+    std::size_t sent = 0;
+    std::size_t completed = 0;
+    std::size_t failed = 0;  // Empty replies.
+    std::size_t dropped = 0; // Poisson arrivals over maxInFlight.
+    // Replies completed and tokens produced within the measured duration, per
+    // second. Tokens come from the provider's getCompletionTokenCount(); for
+    // providers that cannot count them, streamed pieces are counted instead
+    // (0 without streaming) and countedTokens is false.
+    double requestsPerSecond = 0.0;
+    double tokensPerSecond = 0.0;
+    bool countedTokens = false;
+    // Seconds, over all completed requests. Without streaming the time to first
+    // token is the end-to-end latency.
+    double ttftP50 = 0.0;
+    double ttftP90 = 0.0;
+    double ttftP99 = 0.0;
+    double latencyP50 = 0.0;
+    double latencyP90 = 0.0;
+    double latencyP99 = 0.0;
+};
+
+// Drives a provider with synthetic traffic at increasing load and reports
+// throughput and latency percentiles per level, to find the point where a
+// backend saturates: throughput stops growing while latency keeps climbing.
+class InferenceLoadTest {
+public:
+    explicit InferenceLoadTest(std::shared_ptr<IInferenceProvider> provider);
+
+    void setSettings(const InferenceLoadTestSettings& settings);
+    const InferenceLoadTestSettings& getSettings() const;
+
+    // Measures every level in turn. Blocks until done or stop() is called.
+    std::vector<InferenceLoadLevelResult> run();
+    // Measures one level: a user count for CLOSED_LOOP, requests per second for POISSON.
+    InferenceLoadLevelResult runLevel(double level);
+    // May be called from any thread: ends the current level early and cancels
+    // the requests in flight. run() returns the levels finished so far.
+    void stop();
+    bool isStopped() const;
+
+    // Results as an aligned text table, or written as CSV with a header row.
+    static std::string formatTable(const std::vector<InferenceLoadLevelResult>& results, LoadArrivalMode mode);
+    static bool writeCsv(const std::string& path, const std::vector<InferenceLoadLevelResult>& results, LoadArrivalMode mode);
+
+private:
+    struct Sample {
+        bool succeeded = false;
+        bool inWindow = false;
+        double ttft = 0.0;
+        double latency = 0.0;
+        std::size_t pieces = 0;
+    };
+
+    struct Level;
+
+    InferenceLoadLevelResult runClosedLoop(double users);
+    InferenceLoadLevelResult runPoisson(double rate);
+    Sample send(const std::string& prompt, const std::shared_ptr<InferenceCancellationToken>& cancel) const;
+    std::string makePrompt(std::mt19937& random) const;
+    static InferenceLoadLevelResult summarize(double level, const std::vector<Sample>& samples, double durationSeconds,
+                                              long long windowTokens);
+
+    std::shared_ptr<IInferenceProvider> provider;
+    InferenceLoadTestSettings settings;
+
+    std::atomic<bool> stopped{false};
+    // Shared by every request of the running level so stop() reaches them all.
+    std::mutex cancelMutex;
+    std::shared_ptr<InferenceCancellationToken> levelCancel;
+};
@@ -0,0 +1,235 @@
+#include "InferenceLog.h"
+
+#include "ofMain.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace {
+    const char LOG_MAGIC[8] = {'O', 'F', 'X', 'L', 'L', 'O', 'G', '\0'};
+    const unsigned char LOG_VERSION = 1;
+    const unsigned char FLAG_REMOTE = 0x01;
+
+    const unsigned char RECORD_PROMPT = 1;
+    const unsigned char RECORD_CHAT = 2;
+    const unsigned char RECORD_STREAMED = 0x01;
+    const unsigned char RECORD_CANCELLED = 0x02;
+
+    void putVarint(std::string& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    void putString(std::string& out, const std::string& value) {
+        putVarint(out, value.size());
+        out.append(value);
+    }
+
+    // Bounds-checked cursor over the loaded file.
+    class LogCursor {
+    public:
+        LogCursor(const std::string& data, std::size_t position)
+        : data(data)
+        , position(position) {
+        }
+
+        bool atEnd() const {
+            return position >= data.size();
+        }
+
+        bool byte(unsigned char& value) {
+            if (atEnd()) {
+                return false;
+            }
+            value = static_cast<unsigned char>(data[position++]);
+            return true;
+        }
+
+        bool varint(std::uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                unsigned char next = 0;
+                if (!byte(next)) {
+                    return false;
+                }
+                value |= static_cast<std::uint64_t>(next & 0x7F) << shift;
+                if ((next & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool string(std::string& value) {
+            std::uint64_t length = 0;
+            if (!varint(length) || length > data.size() - position) {
+                return false;
+            }
+            value.assign(data, position, static_cast<std::size_t>(length));
+            position += static_cast<std::size_t>(length);
+            return true;
+        }
+
+    private:
+        const std::string& data;
+        std::size_t position;
+    };
+
+    bool readRecord(LogCursor& cursor, InferenceLogRecord& record) {
+        unsigned char kind = 0;
+        unsigned char flags = 0;
+        if (!cursor.byte(kind) || !cursor.byte(flags) || !cursor.varint(record.startMicros)) {
+            return false;
+        }
+        if (kind != RECORD_PROMPT && kind != RECORD_CHAT) {
+            return false;
+        }
+
+        record.chat = kind == RECORD_CHAT;
+        record.streamed = (flags & RECORD_STREAMED) != 0;
+        record.cancelled = (flags & RECORD_CANCELLED) != 0;
+
+        if (record.chat) {
+            std::uint64_t count = 0;
+            if (!cursor.varint(count)) {
+                return false;
+            }
+            for (std::uint64_t i = 0; i < count; ++i) {
+                InferenceChatMessage message;
+                if (!cursor.string(message.role) || !cursor.string(message.content)) {
+                    return false;
+                }
+                record.messages.push_back(std::move(message));
+            }
+        } else if (!cursor.string(record.prompt)) {
+            return false;
+        }
+
+        std::uint64_t tokenCount = 0;
+        if (!cursor.varint(tokenCount)) {
+            return false;
+        }
+        for (std::uint64_t i = 0; i < tokenCount; ++i) {
+            InferenceLogToken token;
+            if (!cursor.varint(token.delayMicros) || !cursor.string(token.text)) {
+                return false;
+            }
+            record.tokens.push_back(std::move(token));
+        }
+
+        return cursor.varint(record.durationMicros) && cursor.string(record.response);
+    }
+}
+
+InferenceLogWriter::~InferenceLogWriter() {
+    close();
+}
+
+bool InferenceLogWriter::open(const std::string& path, bool remote) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.is_open()) {
+        file.close();
+    }
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        ofLogError("InferenceLogWriter") << "Cannot open " << path << " for writing.";
+        return false;
+    }
+
+    file.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+    file.put(static_cast<char>(LOG_VERSION));
+    file.put(static_cast<char>(remote ? FLAG_REMOTE : 0));
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+void InferenceLogWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+bool InferenceLogWriter::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return file.is_open();
+}
+
+bool InferenceLogWriter::write(const InferenceLogRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    buffer.clear();
+    buffer.push_back(static_cast<char>(record.chat ? RECORD_CHAT : RECORD_PROMPT));
+    buffer.push_back(static_cast<char>((record.streamed ? RECORD_STREAMED : 0) | (record.cancelled ? RECORD_CANCELLED : 0)));
+    putVarint(buffer, record.startMicros);
+
+    if (record.chat) {
+        putVarint(buffer, record.messages.size());
+        for (const auto& message : record.messages) {
+            putString(buffer, message.role);
+            putString(buffer, message.content);
+        }
+    } else {
+        putString(buffer, record.prompt);
+    }
+
+    putVarint(buffer, record.tokens.size());
+    for (const auto& token : record.tokens) {
+        putVarint(buffer, token.delayMicros);
+        putString(buffer, token.text);
+    }
+
+    putVarint(buffer, record.durationMicros);
+    putString(buffer, record.response);
+
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    if (!file) {
+        ofLogError("InferenceLogWriter") << "Failed to write record.";
+        return false;
+    }
+    return true;
+}
+
+bool readInferenceLog(const std::string& path, std::vector<InferenceLogRecord>& records, bool* remote) {
+    records.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        ofLogError("InferenceLog") << "Cannot open " << path;
+        return false;
+    }
+
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(LOG_MAGIC) + 2 || std::memcmp(data.data(), LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        ofLogError("InferenceLog") << path << " is not an inference log.";
+        return false;
+    }
+
+    if (static_cast<unsigned char>(data[sizeof(LOG_MAGIC)]) != LOG_VERSION) {
+        ofLogError("InferenceLog") << path << " has unsupported version " << static_cast<int>(static_cast<unsigned char>(data[sizeof(LOG_MAGIC)]));
+        return false;
+    }
+
+    if (remote) {
+        *remote = (static_cast<unsigned char>(data[sizeof(LOG_MAGIC) + 1]) & FLAG_REMOTE) != 0;
+    }
+
+    LogCursor cursor(data, sizeof(LOG_MAGIC) + 2);
+    while (!cursor.atEnd()) {
+        InferenceLogRecord record;
+        if (!readRecord(cursor, record)) {
+            ofLogWarning("InferenceLog") << "Ignoring truncated record after " << records.size() << " records in " << path;
+            break;
+        }
+        records.push_back(std::move(record));
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One streamed piece of a recorded reply.
+struct InferenceLogToken {
+    // Time since the previous token, or since the request started for the first one.
+    std::uint64_t delayMicros = 0;
+    std::string text;
+};
+
+// One request and its reply as captured by RecordingProvider.
+struct InferenceLogRecord {
+    bool chat = false;
+    std::string prompt;                         // Set when chat is false.
+    std::vector<InferenceChatMessage> messages; // Set when chat is true.
+    bool streamed = false;
+    bool cancelled = false;
+    // When the request started, relative to the start of the recording.
+    std::uint64_t startMicros = 0;
+    std::vector<InferenceLogToken> tokens;
+    // Request start to return, including time after the last token.
+    std::uint64_t durationMicros = 0;
+    // Final reply as returned to the caller; empty for failed requests.
+    std::string response;
+};
+
+// Appends records to a compact binary log: an 8-byte magic, a version and a
+// flag byte, then one record after another. Integers are LEB128 varints and
+// strings are length-prefixed, so a token costs a few bytes plus its text.
+// Each record is flushed as a whole, so a crash loses at most the request in
+// progress.
+class InferenceLogWriter {
+public:
+    ~InferenceLogWriter();
+
+    bool open(const std::string& path, bool remote);
+    void close();
+    bool isOpen() const;
+    bool write(const InferenceLogRecord& record);
+
+private:
+    mutable std::mutex mutex;
+    std::ofstream file;
+    std::string buffer;
+};
+
+// Reads a log written by InferenceLogWriter. remote receives the flag passed
+// to open(). Returns false if the file is missing or not a log; a truncated
+// final record is dropped with a warning.
+bool readInferenceLog(const std::string& path, std::vector<InferenceLogRecord>& records, bool* remote = nullptr);
@@ -0,0 +1,295 @@
+#include "InferenceResponseCache.h"
+
+#include "ofMain.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* const DISK_FILE_EXTENSION = ".cache";
+
+    std::uint64_t fnv1a(const std::string& text, std::uint64_t seed) {
+        std::uint64_t hash = seed;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::int64_t toEpochSeconds(const std::chrono::system_clock::time_point& time) {
+        return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    }
+}
+
+InferenceResponseCache::InferenceResponseCache() = default;
+
+bool InferenceResponseCache::lookup(const std::string& key, std::string& response) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        if (!isExpired(it->second->expiresAt)) {
+            entries.splice(entries.begin(), entries, it->second);
+            response = it->second->response;
+            ++hits;
+            return true;
+        }
+
+        bytes -= it->second->response.size();
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    Clock::time_point expiresAt;
+    if (!diskDirectory.empty() && readFromDisk(key, response, expiresAt)) {
+        if (!isExpired(expiresAt)) {
+            insertLocked(key, response, expiresAt);
+            ++hits;
+            return true;
+        }
+
+        std::error_code error;
+        const std::string path = diskPathForKey(key);
+        const std::uintmax_t size = fs::file_size(path, error);
+        if (fs::remove(path, error) && !error) {
+            diskBytes -= std::min(diskBytes, size);
+        }
+    }
+
+    ++misses;
+    return false;
+}
+
+void InferenceResponseCache::store(const std::string& key, const std::string& response) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point expiresAt = expiryFromNow();
+
+    insertLocked(key, response, expiresAt);
+    if (!diskDirectory.empty()) {
+        writeToDisk(key, response, expiresAt);
+    }
+}
+
+void InferenceResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    bytes = 0;
+
+    if (diskDirectory.empty()) {
+        return;
+    }
+
+    // Only our own files, in case the directory is shared.
+    std::vector<fs::path> files;
+    std::error_code error;
+    for (const auto& item : fs::directory_iterator(diskDirectory, error)) {
+        if (item.is_regular_file() && item.path().extension() == DISK_FILE_EXTENSION) {
+            files.push_back(item.path());
+        }
+    }
+    for (const auto& file : files) {
+        fs::remove(file, error);
+    }
+    diskBytes = 0;
+}
+
+void InferenceResponseCache::setTimeToLive(std::chrono::seconds ttl) {
+    std::lock_guard<std::mutex> lock(mutex);
+    timeToLive = ttl;
+}
+
+void InferenceResponseCache::setMaxEntries(std::size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxEntries = count;
+    evictLocked();
+}
+
+void InferenceResponseCache::setMaxBytes(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxBytes = bytes;
+    evictLocked();
+}
+
+void InferenceResponseCache::setDiskDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    diskDirectory = directory;
+    diskBytes = 0;
+
+    if (diskDirectory.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    fs::create_directories(diskDirectory, error);
+    if (error) {
+        ofLogError("InferenceResponseCache") << "Failed to create cache directory " << diskDirectory << ": " << error.message();
+        diskDirectory.clear();
+        return;
+    }
+
+    for (const auto& item : fs::directory_iterator(diskDirectory, error)) {
+        if (item.is_regular_file() && item.path().extension() == DISK_FILE_EXTENSION) {
+            diskBytes += item.file_size(error);
+        }
+    }
+    pruneDiskLocked();
+}
+
+void InferenceResponseCache::setMaxDiskBytes(std::uintmax_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxDiskBytes = bytes;
+    pruneDiskLocked();
+}
+
+void InferenceResponseCache::setDeterministicOnly(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    deterministicOnly = enabled;
+}
+
+bool InferenceResponseCache::isDeterministicOnly() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return deterministicOnly;
+}
+
+std::size_t InferenceResponseCache::getHitCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+std::size_t InferenceResponseCache::getMissCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+std::string InferenceResponseCache::fingerprint(const std::string& canonicalRequest) {
+    // Two independently seeded 64-bit FNV-1a hashes make accidental collisions negligible.
+    std::ostringstream out;
+    out << std::hex << std::setfill('0')
+        << std::setw(16) << fnv1a(canonicalRequest, 14695981039346656037ull)
+        << std::setw(16) << fnv1a(canonicalRequest, 0x9e3779b97f4a7c15ull);
+    return out.str();
+}
+
+bool InferenceResponseCache::isExpired(const Clock::time_point& expiresAt) const {
+    return expiresAt != Clock::time_point::max() && Clock::now() >= expiresAt;
+}
+
+InferenceResponseCache::Clock::time_point InferenceResponseCache::expiryFromNow() const {
+    if (timeToLive.count() <= 0) {
+        return Clock::time_point::max();
+    }
+    return Clock::now() + timeToLive;
+}
+
+void InferenceResponseCache::insertLocked(const std::string& key, const std::string& response, Clock::time_point expiresAt) {
+    auto it = index.find(key);
+    if (it != index.end()) {
+        bytes -= it->second->response.size();
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    entries.push_front({key, response, expiresAt});
+    index[key] = entries.begin();
+    bytes += response.size();
+    evictLocked();
+}
+
+void InferenceResponseCache::evictLocked() {
+    while (!entries.empty() && (entries.size() > maxEntries || bytes > maxBytes)) {
+        const Entry& oldest = entries.back();
+        bytes -= oldest.response.size();
+        index.erase(oldest.key);
+        entries.pop_back();
+    }
+}
+
+bool InferenceResponseCache::readFromDisk(const std::string& key, std::string& response, Clock::time_point& expiresAt) const {
+    std::ifstream file(diskPathForKey(key), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    // Layout: "<expiry epoch seconds or 0>\n<response bytes>".
+    std::int64_t expiry = 0;
+    file >> expiry;
+    if (!file || file.get() != '\n') {
+        return false;
+    }
+
+    response.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    expiresAt = expiry == 0 ? Clock::time_point::max() : Clock::time_point(std::chrono::seconds(expiry));
+    return true;
+}
+
+void InferenceResponseCache::writeToDisk(const std::string& key, const std::string& response, Clock::time_point expiresAt) {
+    const std::string path = diskPathForKey(key);
+    const std::string tempPath = path + ".tmp";
+    std::error_code error;
+    const std::uintmax_t previousSize = fs::exists(path, error) ? fs::file_size(path, error) : 0;
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            ofLogWarning("InferenceResponseCache") << "Failed to write cache file: " << tempPath;
+            return;
+        }
+
+        file << (expiresAt == Clock::time_point::max() ? 0 : toEpochSeconds(expiresAt)) << '\n';
+        file.write(response.data(), static_cast<std::streamsize>(response.size()));
+    }
+
+    fs::rename(tempPath, path, error);
+    if (error) {
+        fs::remove(tempPath, error);
+        return;
+    }
+
+    diskBytes -= std::min(diskBytes, previousSize);
+    diskBytes += fs::file_size(path, error);
+    pruneDiskLocked();
+}
+
+void InferenceResponseCache::pruneDiskLocked() {
+    if (diskDirectory.empty() || diskBytes <= maxDiskBytes) {
+        return;
+    }
+
+    struct DiskFile {
+        fs::path path;
+        fs::file_time_type modified;
+        std::uintmax_t size;
+    };
+
+    std::vector<DiskFile> files;
+    std::error_code error;
+    for (const auto& item : fs::directory_iterator(diskDirectory, error)) {
+        if (item.is_regular_file() && item.path().extension() == DISK_FILE_EXTENSION) {
+            files.push_back({item.path(), item.last_write_time(error), item.file_size(error)});
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const DiskFile& a, const DiskFile& b) {
+        return a.modified < b.modified;
+    });
+
+    for (const auto& file : files) {
+        if (diskBytes <= maxDiskBytes) {
+            break;
+        }
+        if (fs::remove(file.path, error)) {
+            diskBytes -= std::min(diskBytes, file.size);
+        }
+    }
+}
+
+std::string InferenceResponseCache::diskPathForKey(const std::string& key) const {
+    return (fs::path(diskDirectory) / (key + DISK_FILE_EXTENSION)).string();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Response cache shared by inference providers. Providers key each request by
+// a fingerprint of its canonical form (endpoint + JSON body for remote; model
+// path + token limit + prompt for local, which is enough because the local
+// sampler chain ends in greedy selection) and consult the cache before running it.
+//
+// Entries live in an in-memory LRU bounded by entry count and bytes. An optional
+// on-disk tier keeps answers across restarts. Both tiers honour the time-to-live.
+class InferenceResponseCache {
+public:
+    InferenceResponseCache();
+
+    // Returns true and fills response when a fresh entry exists for key.
+    bool lookup(const std::string& key, std::string& response);
+    void store(const std::string& key, const std::string& response);
+    // Drops every entry, including the files of the disk tier.
+    void clear();
+
+    // 0 disables expiry.
+    void setTimeToLive(std::chrono::seconds ttl);
+    void setMaxEntries(std::size_t count);
+    void setMaxBytes(std::size_t bytes);
+    // Enables the disk tier in directory (created if missing). Empty disables it.
+    void setDiskDirectory(const std::string& directory);
+    void setMaxDiskBytes(std::uintmax_t bytes);
+    // When true (default) providers only cache requests whose output is
+    // reproducible, e.g. remote requests sent with temperature 0.
+    void setDeterministicOnly(bool enabled);
+    bool isDeterministicOnly() const;
+
+    std::size_t getHitCount() const;
+    std::size_t getMissCount() const;
+
+    // 128-bit hex fingerprint of a canonical request string.
+    static std::string fingerprint(const std::string& canonicalRequest);
+
+private:
+    using Clock = std::chrono::system_clock;
+
+    struct Entry {
+        std::string key;
+        std::string response;
+        Clock::time_point expiresAt;
+    };
+
+    bool isExpired(const Clock::time_point& expiresAt) const;
+    Clock::time_point expiryFromNow() const;
+    void insertLocked(const std::string& key, const std::string& response, Clock::time_point expiresAt);
+    void evictLocked();
+    bool readFromDisk(const std::string& key, std::string& response, Clock::time_point& expiresAt) const;
+    void writeToDisk(const std::string& key, const std::string& response, Clock::time_point expiresAt);
+    void pruneDiskLocked();
+    std::string diskPathForKey(const std::string& key) const;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries; // Most recently used first.
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::size_t bytes = 0;
+
+    std::chrono::seconds timeToLive{3600};
+    std::size_t maxEntries = 256;
+    std::size_t maxBytes = 16 * 1024 * 1024;
+    std::string diskDirectory;
+    std::uintmax_t maxDiskBytes = 256 * 1024 * 1024;
+    std::uintmax_t diskBytes = 0;
+    bool deterministicOnly = true;
+
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
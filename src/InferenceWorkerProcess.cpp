@@ -0,0 +1,230 @@
+#include "InferenceWorkerProcess.h"
+
+#include "BackendSelector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef MSG_NOSIGNAL
+    const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    const int SEND_FLAGS = 0; // macOS sets SO_NOSIGPIPE on the socket instead.
+#endif
+
+    // How long the worker waits before retrying a write to a full ring.
+    const std::chrono::microseconds RING_FULL_BACKOFF(200);
+}
+
+InferenceWorkerProcess::InferenceWorkerProcess() = default;
+
+InferenceWorkerProcess::~InferenceWorkerProcess() {
+    finishGeneration();
+}
+
+#ifndef _WIN32
+
+int InferenceWorkerProcess::main(int argc, char* argv[]) {
+    int socket = -1;
+    std::string ringName;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        if (option == "--fd") {
+            socket = std::atoi(argv[i + 1]);
+        } else if (option == "--ring") {
+            ringName = argv[i + 1];
+        }
+    }
+
+    if (socket < 0 || ringName.empty()) {
+        ofLogError("InferenceWorkerProcess") << "Usage: " << (argc > 0 ? argv[0] : "worker") << " --fd <socket> --ring <name>";
+        return 2;
+    }
+
+    // A vanished app must end the worker through a failed write, not a signal.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    InferenceWorkerProcess worker;
+    return worker.run(socket, ringName);
+}
+
+int InferenceWorkerProcess::run(int socket, const std::string& ringName) {
+    commandSocket = socket;
+    if (!ring.open(ringName)) {
+        return 1;
+    }
+
+    provider = BackendSelector::create(BackendType::LOCAL);
+
+    std::string buffer;
+    ofJson message;
+    while (readMessage(commandSocket, buffer, message)) {
+        const std::string type = message.value("type", "");
+
+        if (type == "setup") {
+            finishGeneration();
+            ofJson reply;
+            reply["type"] = "setup";
+            reply["ok"] = provider->setup(message.value("model", ""));
+            sendMessage(commandSocket, reply);
+        } else if (type == "generate") {
+            startGeneration(message.value("id", 0u), message.value("prompt", ""));
+        } else if (type == "cancel") {
+            if (cancel && activeRequest == message.value("id", 0u)) {
+                cancel->cancel();
+            }
+        } else if (type == "shutdown") {
+            break;
+        }
+    }
+
+    finishGeneration();
+    ring.close();
+    ::close(commandSocket);
+    return 0;
+}
+
+bool InferenceWorkerProcess::sendMessage(int socket, const ofJson& message) {
+    const std::string line = message.dump(-1, ' ', false, ofJson::error_handler_t::replace) + "\n";
+    std::size_t sent = 0;
+    while (sent < line.size()) {
+        const ssize_t written = ::send(socket, line.data() + sent, line.size() - sent, SEND_FLAGS);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool InferenceWorkerProcess::readMessage(int socket, std::string& buffer, ofJson& message) {
+    while (true) {
+        const std::size_t end = buffer.find('\n');
+        if (end != std::string::npos) {
+            const std::string line = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            try {
+                message = ofJson::parse(line);
+                return true;
+            } catch (const std::exception& exception) {
+                ofLogWarning("InferenceWorkerProcess") << "Ignoring malformed message: " << exception.what();
+                continue;
+            }
+        }
+
+        char chunk[4096];
+        const ssize_t received = ::recv(socket, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(received));
+    }
+}
+
+#else
+
+int InferenceWorkerProcess::main(int, char*[]) {
+    ofLogError("InferenceWorkerProcess") << "Out-of-process inference is not supported on Windows.";
+    return 1;
+}
+
+int InferenceWorkerProcess::run(int, const std::string&) {
+    ofLogError("InferenceWorkerProcess") << "Out-of-process inference is not supported on Windows.";
+    return 1;
+}
+
+bool InferenceWorkerProcess::sendMessage(int, const ofJson&) {
+    return false;
+}
+
+bool InferenceWorkerProcess::readMessage(int, std::string&, ofJson&) {
+    return false;
+}
+
+#endif
+
+void InferenceWorkerProcess::startGeneration(std::uint32_t requestId, const std::string& prompt) {
+    finishGeneration();
+
+    cancel = std::make_shared<InferenceCancellationToken>();
+    activeRequest = requestId;
+
+    const std::shared_ptr<InferenceCancellationToken> token = cancel;
+    generationThread = std::thread([this, requestId, prompt, token]() {
+        bool delivering = true;
+        const std::string reply = provider->generateStream(prompt, [&](const std::string& piece) {
+            if (delivering) {
+                delivering = writeRecord(requestId, SharedTokenRing::TOKEN, piece, token);
+            }
+        }, token);
+
+        // A cancelled request needs no end marker: the app has stopped
+        // waiting and skips records of old requests by id.
+        if (token->isCancelled()) {
+            return;
+        }
+        if (reply.empty()) {
+            writeRecord(requestId, SharedTokenRing::FAILED, "The engine produced no reply.", token);
+        } else {
+            writeRecord(requestId, SharedTokenRing::END, "", token);
+        }
+    });
+}
+
+void InferenceWorkerProcess::finishGeneration() {
+    if (cancel) {
+        cancel->cancel();
+    }
+    if (generationThread.joinable()) {
+        generationThread.join();
+    }
+    cancel.reset();
+    activeRequest = 0;
+}
+
+bool InferenceWorkerProcess::writeRecord(std::uint32_t requestId, SharedTokenRing::RecordType type, const std::string& text,
+                                         const std::shared_ptr<InferenceCancellationToken>& token) {
+    const std::size_t maxText = ring.getMaxTextSize();
+    if (maxText < 4) {
+        ofLogError("InferenceWorkerProcess") << "The ring is too small for any record.";
+        return false;
+    }
+
+    // A record larger than the ring would never fit, so long tokens are split
+    // between UTF-8 characters and the app appends the parts. End and failure
+    // records must stay single, so their text is shortened instead.
+    std::size_t offset = 0;
+    do {
+        std::size_t length = std::min(maxText, text.size() - offset);
+        if (offset + length < text.size()) {
+            while (length > 1 && (static_cast<unsigned char>(text[offset + length]) & 0xC0) == 0x80) {
+                --length;
+            }
+        }
+
+        // The app reads the ring while it waits, so a full ring drains quickly
+        // unless the request was abandoned.
+        while (!ring.tryWrite(requestId, type, text.substr(offset, length))) {
+            if (token->isCancelled()) {
+                return false;
+            }
+            std::this_thread::sleep_for(RING_FULL_BACKOFF);
+        }
+        offset += length;
+    } while (type == SharedTokenRing::TOKEN && offset < text.size());
+    return true;
+}
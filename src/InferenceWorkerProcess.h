@@ -0,0 +1,50 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+#include "SharedTokenRing.h"
+
+#include "ofMain.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Engine side of OutOfProcessProvider. Runs in its own process, reads
+// newline-delimited JSON commands from a local socket inherited from the app
+// and streams reply tokens back through a SharedTokenRing created by the app.
+// It exits when the app closes the socket, so it never outlives its app.
+class InferenceWorkerProcess {
+public:
+    InferenceWorkerProcess();
+    ~InferenceWorkerProcess();
+
+    // Entry point for a worker executable:
+    //   int main(int argc, char* argv[]) { return InferenceWorkerProcess::main(argc, argv); }
+    // Expects "--fd <socket> --ring <name>" as passed by OutOfProcessProvider.
+    static int main(int argc, char* argv[]);
+
+    // Serves commands until the socket closes or a shutdown command arrives.
+    int run(int commandSocket, const std::string& ringName);
+
+    // Line protocol shared with OutOfProcessProvider. readMessage() keeps
+    // unread bytes in buffer between calls and fails once the peer is gone.
+    static bool sendMessage(int socket, const ofJson& message);
+    static bool readMessage(int socket, std::string& buffer, ofJson& message);
+
+private:
+    void startGeneration(std::uint32_t requestId, const std::string& prompt);
+    void finishGeneration();
+    // Waits for room in the ring; false if the request was cancelled meanwhile.
+    // Tokens longer than a record can hold go out as several records.
+    bool writeRecord(std::uint32_t requestId, SharedTokenRing::RecordType type, const std::string& text,
+                     const std::shared_ptr<InferenceCancellationToken>& token);
+
+    int commandSocket = -1;
+    SharedTokenRing ring;
+    std::shared_ptr<IInferenceProvider> provider;
+
+    std::thread generationThread;
+    std::shared_ptr<InferenceCancellationToken> cancel;
+    std::atomic<std::uint32_t> activeRequest{0};
+};
@@ -0,0 +1,618 @@
+#include "LlamaOpenAIServer.h"
+
+#include "IInferenceProvider.h"
+
+#include "ofMain.h"
+
+#include <ctime>
+
+namespace {
+    // Pieces may end inside a UTF-8 character, which JSON cannot carry, so
+    // invalid bytes are replaced rather than failing the whole reply.
+    std::string toJson(const ofJson& value) {
+        return value.dump(-1, ' ', false, ofJson::error_handler_t::replace);
+    }
+
+    std::string errorBody(const std::string& message, const std::string& type) {
+        ofJson error;
+        error["error"]["message"] = message;
+        error["error"]["type"] = type;
+        return toJson(error);
+    }
+
+    bool parseBody(const LocalHttpRequest& request, LocalHttpResponse& response, ofJson& body) {
+        try {
+            body = ofJson::parse(request.body);
+        } catch (const std::exception& exception) {
+            response.send(400, "application/json", errorBody(std::string("Invalid JSON: ") + exception.what(), "invalid_request_error"));
+            return false;
+        }
+        if (!body.is_object()) {
+            response.send(400, "application/json", errorBody("Expected a JSON object.", "invalid_request_error"));
+            return false;
+        }
+        return true;
+    }
+
+    // Text of a message, joining the text parts of multi-part content.
+    std::string messageText(const ofJson& content) {
+        if (content.is_string()) {
+            return content.get<std::string>();
+        }
+
+        std::string text;
+        if (content.is_array()) {
+            for (const auto& part : content) {
+                if (part.is_object() && part.value("type", "") == "text" && part.contains("text") && part["text"].is_string()) {
+                    text += part["text"].get<std::string>();
+                }
+            }
+        }
+        return text;
+    }
+
+    // Formats the messages with the providers' shared transcript, so the
+    // served model behaves as it does in example_chat.
+    std::string chatTranscript(const ofJson& messages) {
+        std::vector<InferenceChatMessage> chat;
+        for (const auto& message : messages) {
+            if (!message.is_object()) {
+                continue;
+            }
+            chat.push_back({message.value("role", "user"), messageText(message.value("content", ofJson()))});
+        }
+        return IInferenceProvider::formatChatTranscript(chat);
+    }
+
+    std::vector<std::string> stopWords(const ofJson& body, std::vector<std::string> stops) {
+        if (body.contains("stop")) {
+            const ofJson& stop = body["stop"];
+            if (stop.is_string()) {
+                stops.push_back(stop.get<std::string>());
+            } else if (stop.is_array()) {
+                for (const auto& word : stop) {
+                    if (word.is_string()) {
+                        stops.push_back(word.get<std::string>());
+                    }
+                }
+            }
+        }
+
+        stops.erase(std::remove(stops.begin(), stops.end(), std::string()), stops.end());
+        return stops;
+    }
+
+    ofJson usageBlock(int promptTokens, int completionTokens) {
+        ofJson usage;
+        usage["prompt_tokens"] = promptTokens;
+        usage["completion_tokens"] = completionTokens;
+        usage["total_tokens"] = promptTokens + completionTokens;
+        return usage;
+    }
+
+    // Number of bytes at the end of text that start an unfinished UTF-8 character.
+    std::size_t incompleteUtf8Tail(const std::string& text) {
+        const std::size_t lookback = std::min<std::size_t>(text.size(), 3);
+        for (std::size_t i = 1; i <= lookback; ++i) {
+            const unsigned char byte = static_cast<unsigned char>(text[text.size() - i]);
+            if ((byte & 0xC0) == 0x80) {
+                continue; // Continuation byte, keep looking for the lead byte.
+            }
+            const std::size_t length = (byte & 0xE0) == 0xC0 ? 2 : (byte & 0xF0) == 0xE0 ? 3 : (byte & 0xF8) == 0xF0 ? 4 : 1;
+            return length > i ? i : 0;
+        }
+        return 0;
+    }
+
+    // Holds back streamed text that may be the start of a stop word or of a
+    // UTF-8 character, so clients never see a stop word or half a character.
+    class StreamFilter {
+    public:
+        explicit StreamFilter(const std::vector<std::string>& stops)
+        : stops(stops) {
+        }
+
+        // Adds a piece and returns the text that is safe to send.
+        std::string push(const std::string& piece) {
+            if (stopped) {
+                return "";
+            }
+            pending += piece;
+
+            for (const auto& stop : stops) {
+                const std::size_t found = pending.find(stop);
+                if (found != std::string::npos) {
+                    stopped = true;
+                    std::string ready = pending.substr(0, found);
+                    pending.clear();
+                    return ready;
+                }
+            }
+
+            std::size_t held = 0;
+            for (const auto& stop : stops) {
+                for (std::size_t length = std::min(stop.size() - 1, pending.size()); length > held; --length) {
+                    if (pending.compare(pending.size() - length, length, stop, 0, length) == 0) {
+                        held = length;
+                        break;
+                    }
+                }
+            }
+
+            held = std::max(held, incompleteUtf8Tail(pending.substr(0, pending.size() - held)) + held);
+            std::string ready = pending.substr(0, pending.size() - held);
+            pending.erase(0, ready.size());
+            return ready;
+        }
+
+        // Whatever is still held back once generation has ended.
+        std::string finish() {
+            std::string rest;
+            rest.swap(pending);
+            return stopped ? std::string() : rest;
+        }
+
+        bool hitStopWord() const {
+            return stopped;
+        }
+
+    private:
+        std::vector<std::string> stops;
+        std::string pending;
+        bool stopped = false;
+    };
+}
+
+LlamaOpenAIServer::LlamaOpenAIServer() = default;
+
+LlamaOpenAIServer::~LlamaOpenAIServer() {
+    stop();
+}
+
+bool LlamaOpenAIServer::loadModel(const std::string& path, int contextSize) {
+    if (server.isRunning()) {
+        ofLogError("LlamaOpenAIServer") << "Stop the server before loading another model.";
+        return false;
+    }
+
+    if (!llama.loadModel(path, contextSize)) {
+        return false;
+    }
+
+    modelFileName = ofFilePath::getFileName(path);
+    return true;
+}
+
+ofxLlamaCpp& LlamaOpenAIServer::getEngine() {
+    return llama;
+}
+
+bool LlamaOpenAIServer::start(const std::string& listenHost, int port) {
+    if (!llama.isModelLoaded()) {
+        ofLogError("LlamaOpenAIServer") << "No model loaded. Call loadModel() first.";
+        return false;
+    }
+
+    host = listenHost;
+    {
+        // Requests that gave up when the server last stopped left their tickets behind.
+        std::lock_guard<std::mutex> lock(turnMutex);
+        nextTicket = 0;
+        servingTicket = 0;
+        stopping = false;
+    }
+    return server.start(listenHost, port, [this](const LocalHttpRequest& request, LocalHttpResponse& response) {
+        handleRequest(request, response);
+    });
+}
+
+void LlamaOpenAIServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(turnMutex);
+        stopping = true;
+    }
+    turnChanged.notify_all();
+    server.stop();
+}
+
+bool LlamaOpenAIServer::isRunning() const {
+    return server.isRunning();
+}
+
+int LlamaOpenAIServer::getPort() const {
+    return server.getPort();
+}
+
+std::string LlamaOpenAIServer::getBaseUrl() const {
+    const std::string urlHost = host.empty() || host == "0.0.0.0" ? "127.0.0.1" : host;
+    return "http://" + urlHost + ":" + std::to_string(getPort()) + "/v1";
+}
+
+void LlamaOpenAIServer::setSettings(const LlamaOpenAIServerSettings& newSettings) {
+    std::lock_guard<std::mutex> lock(mutex);
+    settings = newSettings;
+}
+
+LlamaOpenAIServerSettings LlamaOpenAIServer::getSettings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return settings;
+}
+
+LlamaOpenAIServerStats LlamaOpenAIServer::getStats() const {
+    LlamaOpenAIServerStats result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = stats;
+    }
+    result.acceptedConnections = server.getAcceptedConnectionCount();
+    return result;
+}
+
+std::string LlamaOpenAIServer::getModelName() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return settings.modelName.empty() ? modelFileName : settings.modelName;
+}
+
+void LlamaOpenAIServer::handleRequest(const LocalHttpRequest& request, LocalHttpResponse& response) {
+    const std::string path = request.path.compare(0, 3, "/v1") == 0 ? request.path.substr(3) : request.path;
+
+    if (path == "/models") {
+        handleModels(response);
+        return;
+    }
+
+    if (path != "/chat/completions" && path != "/completions" && path != "/embeddings") {
+        response.send(404, "application/json", errorBody("Unknown path " + request.path, "invalid_request_error"));
+        return;
+    }
+
+    if (request.method != "POST") {
+        response.send(405, "application/json", errorBody("Use POST.", "invalid_request_error"));
+        return;
+    }
+
+    if (path == "/chat/completions") {
+        handleChatCompletions(request, response);
+    } else if (path == "/completions") {
+        handleCompletions(request, response);
+    } else {
+        handleEmbeddings(request, response);
+    }
+}
+
+void LlamaOpenAIServer::handleChatCompletions(const LocalHttpRequest& request, LocalHttpResponse& response) {
+    ofJson body;
+    if (!parseBody(request, response, body)) {
+        return;
+    }
+
+    if (!body.contains("messages") || !body["messages"].is_array() || body["messages"].empty()) {
+        response.send(400, "application/json", errorBody("messages must be a non-empty array.", "invalid_request_error"));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.chatRequests;
+    }
+
+    // The transcript format ends a turn where the model starts the next one.
+    respondWithGeneration(chatTranscript(body["messages"]), body, true, {"User:", "Assistant:"}, response);
+}
+
+void LlamaOpenAIServer::handleCompletions(const LocalHttpRequest& request, LocalHttpResponse& response) {
+    ofJson body;
+    if (!parseBody(request, response, body)) {
+        return;
+    }
+
+    std::string prompt;
+    const ofJson promptValue = body.value("prompt", ofJson());
+    if (promptValue.is_string()) {
+        prompt = promptValue.get<std::string>();
+    } else if (promptValue.is_array() && promptValue.size() == 1 && promptValue[0].is_string()) {
+        prompt = promptValue[0].get<std::string>();
+    } else {
+        response.send(400, "application/json", errorBody("prompt must be a string.", "invalid_request_error"));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.completionRequests;
+    }
+
+    respondWithGeneration(prompt, body, false, {}, response);
+}
+
+void LlamaOpenAIServer::respondWithGeneration(const std::string& prompt, const ofJson& body, bool chat,
+                                              const std::vector<std::string>& defaultStops, LocalHttpResponse& response) {
+    const bool stream = body.value("stream", false);
+    const bool includeUsage = body.contains("stream_options") && body["stream_options"].is_object()
+        && body["stream_options"].value("include_usage", false);
+
+    int maxTokens = getSettings().defaultMaxTokens;
+    for (const char* limitKey : {"max_tokens", "max_completion_tokens"}) {
+        if (body.contains(limitKey) && body[limitKey].is_number_integer()) {
+            maxTokens = body[limitKey].get<int>();
+        }
+    }
+    if (maxTokens <= 0) {
+        response.send(400, "application/json", errorBody("max_tokens must be positive.", "invalid_request_error"));
+        return;
+    }
+
+    // Tokenizing only reads the vocabulary, so it need not wait for the turn.
+    const int promptTokens = static_cast<int>(llama.tokenize(prompt).size());
+    if (promptTokens >= llama.getContextSize()) {
+        response.send(400, "application/json", errorBody("The prompt does not fit into the model's context.", "context_length_exceeded"));
+        return;
+    }
+
+    const std::vector<std::string> stops = stopWords(body, defaultStops);
+    const std::string model = getModelName();
+    const std::int64_t created = static_cast<std::int64_t>(std::time(nullptr));
+    std::string id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = (chat ? "chatcmpl-" : "cmpl-") + std::to_string(nextCompletionId++);
+    }
+
+    const std::string objectType = chat ? "chat.completion" : "text_completion";
+    auto chunk = [&](const std::string& text, const ofJson& reason, bool first) {
+        ofJson event;
+        event["id"] = id;
+        event["object"] = chat ? "chat.completion.chunk" : "text_completion";
+        event["created"] = created;
+        event["model"] = model;
+        ofJson choice = {{"index", 0}, {"finish_reason", reason}};
+        if (chat) {
+            choice["delta"] = ofJson::object();
+            if (first) {
+                choice["delta"]["role"] = "assistant";
+            }
+            if (!text.empty() || first) {
+                choice["delta"]["content"] = text;
+            }
+        } else {
+            choice["text"] = text;
+            choice["logprobs"] = nullptr;
+        }
+        event["choices"] = ofJson::array();
+        event["choices"].push_back(choice);
+        return "data: " + toJson(event) + "\n\n";
+    };
+
+    if (!acquireTurn()) {
+        response.send(503, "application/json", errorBody("The server is busy. Try again later.", "server_error"), {"Retry-After: 1"});
+        return;
+    }
+
+    // The turn is held until the reply is complete, so the model is free for
+    // the next request as soon as this one is done.
+    Generation generation;
+    StreamFilter filter(stops);
+
+    if (!stream) {
+        std::string text;
+        generation = generate(prompt, promptTokens, maxTokens, stops, [&](const std::string& piece) {
+            text += filter.push(piece);
+            return !filter.hitStopWord();
+        }, response);
+        releaseTurn();
+
+        if (generation.interrupted && !filter.hitStopWord()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.cancelledRequests;
+            return;
+        }
+        text += filter.finish();
+
+        ofJson reply;
+        reply["id"] = id;
+        reply["object"] = objectType;
+        reply["created"] = created;
+        reply["model"] = model;
+        ofJson choice = {{"index", 0}, {"finish_reason", finishReason(generation, filter.hitStopWord())}};
+        if (chat) {
+            choice["message"] = {{"role", "assistant"}, {"content", text}};
+        } else {
+            choice["text"] = text;
+            choice["logprobs"] = nullptr;
+        }
+        reply["choices"] = ofJson::array();
+        reply["choices"].push_back(choice);
+        reply["usage"] = usageBlock(generation.promptTokens, generation.completionTokens);
+        response.send(200, "application/json", toJson(reply));
+        return;
+    }
+
+    if (!response.beginStream(200, "text/event-stream", {"Cache-Control: no-cache"})
+        || (chat && !response.writeChunk(chunk("", nullptr, true)))) {
+        releaseTurn();
+        return;
+    }
+
+    generation = generate(prompt, promptTokens, maxTokens, stops, [&](const std::string& piece) {
+        const std::string ready = filter.push(piece);
+        if (!ready.empty() && !response.writeChunk(chunk(ready, nullptr, false))) {
+            return false; // Client went away.
+        }
+        return !filter.hitStopWord();
+    }, response);
+    releaseTurn();
+
+    if (generation.interrupted && !filter.hitStopWord()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.cancelledRequests;
+        return;
+    }
+
+    const std::string rest = filter.finish();
+    if (!rest.empty()) {
+        response.writeChunk(chunk(rest, nullptr, false));
+    }
+    response.writeChunk(chunk("", finishReason(generation, filter.hitStopWord()), false));
+
+    if (includeUsage) {
+        ofJson usage;
+        usage["id"] = id;
+        usage["object"] = chat ? "chat.completion.chunk" : "text_completion";
+        usage["created"] = created;
+        usage["model"] = model;
+        usage["choices"] = ofJson::array();
+        usage["usage"] = usageBlock(generation.promptTokens, generation.completionTokens);
+        response.writeChunk("data: " + toJson(usage) + "\n\n");
+    }
+
+    response.writeChunk("data: [DONE]\n\n");
+    response.endStream();
+}
+
+void LlamaOpenAIServer::handleEmbeddings(const LocalHttpRequest& request, LocalHttpResponse& response) {
+    ofJson body;
+    if (!parseBody(request, response, body)) {
+        return;
+    }
+
+    std::vector<std::string> inputs;
+    const ofJson input = body.value("input", ofJson());
+    if (input.is_string()) {
+        inputs.push_back(input.get<std::string>());
+    } else if (input.is_array()) {
+        for (const auto& item : input) {
+            if (!item.is_string()) {
+                inputs.clear();
+                break;
+            }
+            inputs.push_back(item.get<std::string>());
+        }
+    }
+
+    if (inputs.empty()) {
+        response.send(400, "application/json", errorBody("input must be a string or an array of strings.", "invalid_request_error"));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.embeddingRequests;
+    }
+
+    if (!acquireTurn()) {
+        response.send(503, "application/json", errorBody("The server is busy. Try again later.", "server_error"), {"Retry-After: 1"});
+        return;
+    }
+
+    ofJson reply;
+    reply["object"] = "list";
+    reply["data"] = ofJson::array();
+    reply["model"] = getModelName();
+    int promptTokens = 0;
+    bool succeeded = true;
+
+    for (std::size_t i = 0; i < inputs.size() && succeeded; ++i) {
+        std::vector<float> embedding;
+        succeeded = llama.getEmbedding(inputs[i], embedding);
+        promptTokens += static_cast<int>(llama.tokenize(inputs[i]).size());
+        reply["data"].push_back({{"object", "embedding"}, {"index", i}, {"embedding", embedding}});
+    }
+    releaseTurn();
+
+    if (!succeeded) {
+        response.send(500, "application/json", errorBody("Failed to compute embeddings.", "server_error"));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.promptTokens += static_cast<std::size_t>(promptTokens);
+    }
+
+    reply["usage"] = {{"prompt_tokens", promptTokens}, {"total_tokens", promptTokens}};
+    response.send(200, "application/json", toJson(reply));
+}
+
+void LlamaOpenAIServer::handleModels(LocalHttpResponse& response) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.modelRequests;
+    }
+
+    ofJson reply;
+    reply["object"] = "list";
+    reply["data"] = ofJson::array();
+    reply["data"].push_back({{"id", getModelName()}, {"object", "model"}, {"owned_by", "ofxLlamaCpp"}});
+    response.send(200, "application/json", toJson(reply));
+}
+
+LlamaOpenAIServer::Generation LlamaOpenAIServer::generate(const std::string& prompt, int promptTokens, int maxTokens,
+                                                          const std::vector<std::string>& stops, const PieceHandler& onPiece,
+                                                          LocalHttpResponse& response) {
+    Generation generation;
+    generation.promptTokens = promptTokens;
+    maxTokens = std::max(1, std::min(maxTokens, llama.getContextSize() - promptTokens));
+
+    llama.clearStopWords();
+    for (const auto& stop : stops) {
+        llama.addStopWord(stop);
+    }
+
+    // Pieces are handed to this thread, so writes to the connection never
+    // block the model. A client that hangs up frees the turn early, also
+    // while it waits for a blocking reply.
+    const ofxLlamaCpp::BlockingResult result = llama.generateBlocking(prompt, maxTokens, onPiece, [&]() {
+        return stopping || !response.isConnected();
+    });
+
+    generation.text = result.text;
+    generation.interrupted = result.interrupted;
+    generation.completionTokens = result.tokens;
+    generation.reachedTokenLimit = result.tokens >= maxTokens;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.promptTokens += static_cast<std::size_t>(generation.promptTokens);
+        stats.completionTokens += static_cast<std::size_t>(generation.completionTokens);
+    }
+    return generation;
+}
+
+std::string LlamaOpenAIServer::finishReason(const Generation& generation, bool hitStopWord) {
+    return generation.reachedTokenLimit && !hitStopWord ? "length" : "stop";
+}
+
+bool LlamaOpenAIServer::acquireTurn() {
+    const std::size_t maxQueueLength = getSettings().maxQueueLength;
+
+    std::unique_lock<std::mutex> lock(turnMutex);
+    // Everything between servingTicket and nextTicket is running or waiting.
+    if (stopping || nextTicket - servingTicket > maxQueueLength) {
+        std::lock_guard<std::mutex> statsLock(mutex);
+        ++stats.rejectedRequests;
+        return false;
+    }
+
+    const std::uint64_t ticket = nextTicket++;
+    {
+        std::lock_guard<std::mutex> statsLock(mutex);
+        stats.queued = static_cast<std::size_t>(nextTicket - servingTicket - 1);
+    }
+
+    turnChanged.wait(lock, [&]() { return stopping || servingTicket == ticket; });
+    if (servingTicket != ticket) {
+        // Stopping: give up the place so the tickets behind it can leave too.
+        return false;
+    }
+    return true;
+}
+
+void LlamaOpenAIServer::releaseTurn() {
+    {
+        std::lock_guard<std::mutex> lock(turnMutex);
+        ++servingTicket;
+        std::lock_guard<std::mutex> statsLock(mutex);
+        stats.queued = nextTicket > servingTicket ? static_cast<std::size_t>(nextTicket - servingTicket - 1) : 0;
+    }
+    turnChanged.notify_all();
+}
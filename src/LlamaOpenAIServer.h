@@ -0,0 +1,120 @@
+#pragma once
+
+#include "LocalHttpServer.h"
+#include "ofxLlamaCpp.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct LlamaOpenAIServerSettings {
+    // Reported by /v1/models and in replies. Empty uses the model file name.
+    std::string modelName;
+    // Reply length when a request does not set max_tokens.
+    int defaultMaxTokens = 256;
+    // Requests allowed to wait while another one runs; further ones get 503.
+    std::size_t maxQueueLength = 16;
+};
+
+// Counters collected while the server runs.
+struct LlamaOpenAIServerStats {
+    std::size_t chatRequests = 0;
+    std::size_t completionRequests = 0;
+    std::size_t embeddingRequests = 0;
+    std::size_t modelRequests = 0;
+    std::size_t rejectedRequests = 0;  // Queue full.
+    std::size_t cancelledRequests = 0; // Client went away before the reply was complete.
+    std::size_t promptTokens = 0;
+    std::size_t completionTokens = 0;
+    std::size_t queued = 0;
+    std::size_t acceptedConnections = 0;
+};
+
+// Serves one ofxLlamaCpp model over an OpenAI-compatible HTTP API, so other
+// machines (or RemoteAPIProvider) can use a headless engine:
+// /v1/chat/completions and /v1/completions (blocking and SSE streaming),
+// /v1/embeddings and /v1/models. Every connection has its own thread;
+// requests take turns on the single loaded model in arrival order.
+class LlamaOpenAIServer {
+public:
+    LlamaOpenAIServer();
+    ~LlamaOpenAIServer();
+
+    // Loads the model served afterwards. Sampler settings can be changed
+    // through getEngine() before start().
+    bool loadModel(const std::string& path, int contextSize = 2048);
+    ofxLlamaCpp& getEngine();
+
+    // Port 0 picks a free port; see getPort().
+    bool start(const std::string& host = "127.0.0.1", int port = 8080);
+    // Ends running requests, closes every connection and waits for them.
+    void stop();
+    bool isRunning() const;
+
+    int getPort() const;
+    // Base URL to pass to RemoteAPIProvider, e.g. "http://127.0.0.1:8080/v1".
+    std::string getBaseUrl() const;
+
+    void setSettings(const LlamaOpenAIServerSettings& settings);
+    LlamaOpenAIServerSettings getSettings() const;
+    LlamaOpenAIServerStats getStats() const;
+    std::string getModelName() const;
+
+private:
+    // Result of one generation on the model.
+    struct Generation {
+        std::string text;
+        int promptTokens = 0;
+        int completionTokens = 0;
+        // Ended by the piece handler or by stop() rather than by the model.
+        bool interrupted = false;
+        bool reachedTokenLimit = false;
+    };
+
+    // Returns false for text that should end the request early.
+    using PieceHandler = std::function<bool(const std::string&)>;
+
+    void handleRequest(const LocalHttpRequest& request, LocalHttpResponse& response);
+    void handleChatCompletions(const LocalHttpRequest& request, LocalHttpResponse& response);
+    void handleCompletions(const LocalHttpRequest& request, LocalHttpResponse& response);
+    void handleEmbeddings(const LocalHttpRequest& request, LocalHttpResponse& response);
+    void handleModels(LocalHttpResponse& response);
+
+    // Generates a reply to prompt and streams it as OpenAI chat or text
+    // completion chunks, or sends it in one piece.
+    void respondWithGeneration(const std::string& prompt, const ofJson& body, bool chat,
+                               const std::vector<std::string>& defaultStops, LocalHttpResponse& response);
+    // Runs one generation; the caller must hold the turn. Ends early when the
+    // client behind response disconnects.
+    Generation generate(const std::string& prompt, int promptTokens, int maxTokens,
+                        const std::vector<std::string>& stops, const PieceHandler& onPiece,
+                        LocalHttpResponse& response);
+    static std::string finishReason(const Generation& generation, bool hitStopWord);
+
+    // Waits until every earlier request is done. False when the queue is
+    // full or the server is stopping.
+    bool acquireTurn();
+    void releaseTurn();
+
+    LocalHttpServer server;
+    std::string host;
+    ofxLlamaCpp llama;
+    std::string modelFileName;
+
+    mutable std::mutex mutex;
+    LlamaOpenAIServerSettings settings;
+    LlamaOpenAIServerStats stats;
+    std::size_t nextCompletionId = 1;
+
+    // Requests are served in ticket order.
+    std::mutex turnMutex;
+    std::condition_variable turnChanged;
+    std::uint64_t nextTicket = 0;
+    std::uint64_t servingTicket = 0;
+    std::atomic<bool> stopping{false};
+};
@@ -0,0 +1,492 @@
+#include "LocalHttpServer.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "ofMain.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    const SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+    const int SHUTDOWN_BOTH = SD_BOTH;
+    const int SEND_FLAGS = 0;
+
+    void closeSocket(SocketHandle socket) {
+        closesocket(socket);
+    }
+#else
+    using SocketHandle = int;
+    const SocketHandle INVALID_SOCKET_HANDLE = -1;
+    const int SHUTDOWN_BOTH = SHUT_RDWR;
+#ifdef MSG_NOSIGNAL
+    const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    const int SEND_FLAGS = 0;
+#endif
+
+    void closeSocket(SocketHandle socket) {
+        ::close(socket);
+    }
+#endif
+
+    const std::size_t MAX_HEADER_BYTES = 64 * 1024;
+    const std::size_t MAX_BODY_BYTES = 64 * 1024 * 1024;
+    const std::size_t RECEIVE_CHUNK_BYTES = 16 * 1024;
+
+    SocketHandle toHandle(std::intptr_t socket) {
+        return static_cast<SocketHandle>(socket);
+    }
+
+    std::string toLower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return value;
+    }
+
+    std::string trim(const std::string& value) {
+        const std::size_t first = value.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            return "";
+        }
+        const std::size_t last = value.find_last_not_of(" \t\r");
+        return value.substr(first, last - first + 1);
+    }
+
+    const char* statusText(int status) {
+        switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Status";
+        }
+    }
+
+    std::string toHex(std::size_t value) {
+        static const char* digits = "0123456789abcdef";
+        std::string result;
+        do {
+            result.insert(result.begin(), digits[value & 0xf]);
+            value >>= 4;
+        } while (value != 0);
+        return result;
+    }
+}
+
+std::string LocalHttpRequest::header(const std::string& name) const {
+    auto it = headers.find(toLower(name));
+    return it == headers.end() ? "" : it->second;
+}
+
+LocalHttpResponse::LocalHttpResponse(std::intptr_t socket, bool keepAlive)
+: socket(socket)
+, keepAlive(keepAlive) {
+}
+
+bool LocalHttpResponse::send(int status, const std::string& contentType, const std::string& body, const std::vector<std::string>& extraHeaders) {
+    if (started) {
+        return false;
+    }
+
+    if (!writeHead(status, contentType, extraHeaders, "Content-Length: " + std::to_string(body.size()))) {
+        return false;
+    }
+
+    finished = writeAll(body);
+    return finished;
+}
+
+bool LocalHttpResponse::beginStream(int status, const std::string& contentType, const std::vector<std::string>& extraHeaders) {
+    if (started) {
+        return false;
+    }
+
+    streaming = true;
+    return writeHead(status, contentType, extraHeaders, "Transfer-Encoding: chunked");
+}
+
+bool LocalHttpResponse::writeChunk(const std::string& data) {
+    if (!streaming || finished || broken) {
+        return false;
+    }
+
+    if (data.empty()) {
+        return true; // An empty chunk would end the stream.
+    }
+
+    return writeAll(toHex(data.size()) + "\r\n" + data + "\r\n");
+}
+
+bool LocalHttpResponse::endStream() {
+    if (!streaming || finished || broken) {
+        return false;
+    }
+
+    finished = writeAll("0\r\n\r\n");
+    return finished;
+}
+
+bool LocalHttpResponse::isConnected() {
+    if (broken) {
+        return false;
+    }
+
+    // A readable socket is either the next pipelined request or the end of
+    // the stream; peeking tells them apart without consuming anything.
+    const SocketHandle handle = toHandle(socket);
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(handle, &readable);
+    timeval timeout = {0, 0};
+    if (::select(static_cast<int>(handle) + 1, &readable, nullptr, nullptr, &timeout) <= 0) {
+        return true;
+    }
+
+    char byte = 0;
+    if (::recv(handle, &byte, 1, MSG_PEEK) <= 0) {
+        broken = true;
+        return false;
+    }
+    return true;
+}
+
+void LocalHttpResponse::abort() {
+    started = true;
+    broken = true;
+}
+
+bool LocalHttpResponse::isStarted() const {
+    return started;
+}
+
+bool LocalHttpResponse::writeHead(int status, const std::string& contentType, const std::vector<std::string>& extraHeaders, const std::string& lengthHeader) {
+    started = true;
+
+    std::string head = "HTTP/1.1 " + std::to_string(status) + " " + statusText(status) + "\r\n";
+    if (!contentType.empty()) {
+        head += "Content-Type: " + contentType + "\r\n";
+    }
+    head += lengthHeader + "\r\n";
+    head += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    for (const auto& header : extraHeaders) {
+        head += header + "\r\n";
+    }
+    head += "\r\n";
+
+    return writeAll(head);
+}
+
+bool LocalHttpResponse::writeAll(const std::string& data) {
+    if (broken) {
+        return false;
+    }
+
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        const int sent = ::send(toHandle(socket), data.data() + offset, static_cast<int>(data.size() - offset), SEND_FLAGS);
+        if (sent <= 0) {
+            broken = true;
+            return false;
+        }
+        offset += static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+LocalHttpServer::LocalHttpServer()
+: listenSocket(static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE))
+, running(false)
+, port(0) {
+}
+
+LocalHttpServer::~LocalHttpServer() {
+    stop();
+}
+
+bool LocalHttpServer::start(const std::string& host, int requestedPort, Handler requestHandler) {
+    if (running) {
+        ofLogWarning("LocalHttpServer") << "Server is already running on port " << port;
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        ofLogError("LocalHttpServer") << "WSAStartup failed.";
+        return false;
+    }
+#endif
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo* addresses = nullptr;
+    const std::string service = std::to_string(requestedPort);
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &addresses) != 0 || !addresses) {
+        ofLogError("LocalHttpServer") << "Cannot resolve listen address " << host << ":" << requestedPort;
+        return false;
+    }
+
+    SocketHandle socket = INVALID_SOCKET_HANDLE;
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket == INVALID_SOCKET_HANDLE) {
+            continue;
+        }
+
+        int reuse = 1;
+        setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        if (::bind(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 && ::listen(socket, SOMAXCONN) == 0) {
+            break;
+        }
+
+        closeSocket(socket);
+        socket = INVALID_SOCKET_HANDLE;
+    }
+    freeaddrinfo(addresses);
+
+    if (socket == INVALID_SOCKET_HANDLE) {
+        ofLogError("LocalHttpServer") << "Cannot listen on " << host << ":" << requestedPort;
+        return false;
+    }
+
+    sockaddr_storage bound = {};
+    socklen_t boundLength = sizeof(bound);
+    getsockname(socket, reinterpret_cast<sockaddr*>(&bound), &boundLength);
+    if (bound.ss_family == AF_INET6) {
+        port = ntohs(reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port);
+    } else {
+        port = ntohs(reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        acceptedConnections = 0;
+    }
+
+    handler = std::move(requestHandler);
+    listenSocket = static_cast<std::intptr_t>(socket);
+    running = true;
+    acceptThread = std::thread(&LocalHttpServer::acceptLoop, this);
+    return true;
+}
+
+void LocalHttpServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+
+    // Shutting the socket down wakes the blocked accept() call.
+    shutdown(toHandle(listenSocket), SHUTDOWN_BOTH);
+#ifdef _WIN32
+    closeSocket(toHandle(listenSocket));
+#endif
+    if (acceptThread.joinable()) {
+        acceptThread.join();
+    }
+#ifndef _WIN32
+    closeSocket(toHandle(listenSocket));
+#endif
+    listenSocket = static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (std::intptr_t client : clients) {
+        shutdown(toHandle(client), SHUTDOWN_BOTH);
+    }
+    connectionsClosed.wait(lock, [this] {
+        return clients.empty();
+    });
+    lock.unlock();
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool LocalHttpServer::isRunning() const {
+    return running;
+}
+
+int LocalHttpServer::getPort() const {
+    return port;
+}
+
+std::size_t LocalHttpServer::getOpenConnectionCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return clients.size();
+}
+
+std::size_t LocalHttpServer::getAcceptedConnectionCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return acceptedConnections;
+}
+
+void LocalHttpServer::acceptLoop() {
+    while (running) {
+        const SocketHandle client = ::accept(toHandle(listenSocket), nullptr, nullptr);
+        if (client == INVALID_SOCKET_HANDLE) {
+            if (!running) {
+                break;
+            }
+            continue;
+        }
+
+        // Small SSE chunks must leave immediately instead of waiting for Nagle.
+        int noDelay = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+        int noSigPipe = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) {
+                closeSocket(client);
+                break;
+            }
+            clients.insert(static_cast<std::intptr_t>(client));
+            ++acceptedConnections;
+        }
+
+        // stop() waits for every connection to deregister, so detaching is safe.
+        std::thread(&LocalHttpServer::serveConnection, this, static_cast<std::intptr_t>(client)).detach();
+    }
+}
+
+void LocalHttpServer::serveConnection(std::intptr_t client) {
+    std::string buffer;
+
+    while (running) {
+        LocalHttpRequest request;
+        bool keepAlive = false;
+        if (!readRequest(client, buffer, request, keepAlive)) {
+            break;
+        }
+
+        LocalHttpResponse response(client, keepAlive);
+        try {
+            handler(request, response);
+        } catch (const std::exception& exception) {
+            ofLogError("LocalHttpServer") << "Handler for " << request.path << " threw: " << exception.what();
+        }
+
+        if (!response.isStarted()) {
+            response.send(500, "text/plain", "No response.\n");
+        }
+
+        if (!keepAlive || response.broken || !response.finished) {
+            break;
+        }
+    }
+
+    closeSocket(toHandle(client));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    clients.erase(client);
+    connectionsClosed.notify_all();
+}
+
+bool LocalHttpServer::readRequest(std::intptr_t client, std::string& buffer, LocalHttpRequest& request, bool& keepAlive) {
+    char chunk[RECEIVE_CHUNK_BYTES];
+
+    std::size_t headerEnd = buffer.find("\r\n\r\n");
+    while (headerEnd == std::string::npos) {
+        if (buffer.size() > MAX_HEADER_BYTES) {
+            LocalHttpResponse(client, false).send(431, "text/plain", "Request headers too large.\n");
+            return false;
+        }
+
+        const int received = ::recv(toHandle(client), chunk, static_cast<int>(sizeof(chunk)), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(received));
+        headerEnd = buffer.find("\r\n\r\n");
+    }
+
+    std::size_t lineEnd = buffer.find("\r\n");
+    const std::string requestLine = buffer.substr(0, lineEnd);
+    const std::size_t methodEnd = requestLine.find(' ');
+    const std::size_t targetEnd = requestLine.find(' ', methodEnd == std::string::npos ? 0 : methodEnd + 1);
+    if (methodEnd == std::string::npos || targetEnd == std::string::npos) {
+        LocalHttpResponse(client, false).send(400, "text/plain", "Malformed request line.\n");
+        return false;
+    }
+
+    request.method = requestLine.substr(0, methodEnd);
+    const std::string target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    const std::string version = requestLine.substr(targetEnd + 1);
+    const std::size_t queryStart = target.find('?');
+    request.path = target.substr(0, queryStart);
+    request.query = queryStart == std::string::npos ? "" : target.substr(queryStart + 1);
+
+    while (lineEnd < headerEnd) {
+        const std::size_t next = buffer.find("\r\n", lineEnd + 2);
+        const std::string line = buffer.substr(lineEnd + 2, next - lineEnd - 2);
+        const std::size_t colon = line.find(':');
+        if (colon != std::string::npos) {
+            request.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+        }
+        lineEnd = next;
+    }
+
+    const std::string connection = toLower(request.header("connection"));
+    keepAlive = version == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+
+    if (!request.header("transfer-encoding").empty()) {
+        LocalHttpResponse(client, false).send(411, "text/plain", "Chunked request bodies are not supported.\n");
+        return false;
+    }
+
+    const std::size_t contentLength = static_cast<std::size_t>(std::strtoull(request.header("content-length").c_str(), nullptr, 10));
+    if (contentLength > MAX_BODY_BYTES) {
+        LocalHttpResponse(client, false).send(413, "text/plain", "Request body too large.\n");
+        return false;
+    }
+
+    const std::size_t bodyStart = headerEnd + 4;
+    while (buffer.size() < bodyStart + contentLength) {
+        const int received = ::recv(toHandle(client), chunk, static_cast<int>(sizeof(chunk)), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(received));
+    }
+
+    request.body = buffer.substr(bodyStart, contentLength);
+    // Keep any pipelined bytes for the next request.
+    buffer.erase(0, bodyStart + contentLength);
+    return true;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One parsed HTTP request as seen by a LocalHttpServer handler.
+struct LocalHttpRequest {
+    std::string method;
+    std::string path;   // Without the query string.
+    std::string query;
+    std::map<std::string, std::string> headers; // Lower-case names.
+    std::string body;
+
+    // Returns the header value, or an empty string when it is absent.
+    std::string header(const std::string& name) const;
+};
+
+// Writes the reply to one request. Either send() a complete response, or
+// beginStream() followed by writeChunk() calls and endStream().
+class LocalHttpResponse {
+public:
+    bool send(int status,
+              const std::string& contentType,
+              const std::string& body,
+              const std::vector<std::string>& extraHeaders = std::vector<std::string>());
+    // Starts a chunked response, e.g. for server-sent events.
+    bool beginStream(int status,
+                     const std::string& contentType,
+                     const std::vector<std::string>& extraHeaders = std::vector<std::string>());
+    // Returns false once the client has disconnected.
+    bool writeChunk(const std::string& data);
+    bool endStream();
+    // Checks without blocking whether the client is still there, e.g. while a
+    // blocking reply is being prepared.
+    bool isConnected();
+    // Drops the connection without a reply, e.g. to simulate a network failure.
+    void abort();
+
+    bool isStarted() const;
+
+private:
+    friend class LocalHttpServer;
+    LocalHttpResponse(std::intptr_t socket, bool keepAlive);
+
+    bool writeHead(int status, const std::string& contentType, const std::vector<std::string>& extraHeaders, const std::string& lengthHeader);
+    bool writeAll(const std::string& data);
+
+    std::intptr_t socket;
+    bool keepAlive;
+    bool started = false;
+    bool streaming = false;
+    bool finished = false;
+    bool broken = false;
+};
+
+// Minimal HTTP/1.1 server for local tools and tests. Every connection is served
+// by its own thread and kept alive between requests, so clients that reuse
+// connections can be told apart from clients that do not.
+class LocalHttpServer {
+public:
+    using Handler = std::function<void(const LocalHttpRequest&, LocalHttpResponse&)>;
+
+    LocalHttpServer();
+    ~LocalHttpServer();
+
+    LocalHttpServer(const LocalHttpServer&) = delete;
+    LocalHttpServer& operator=(const LocalHttpServer&) = delete;
+
+    // Binds host:port and starts accepting. Port 0 picks a free port.
+    bool start(const std::string& host, int port, Handler handler);
+    // Closes the listening socket and every open connection, then waits for handlers to return.
+    void stop();
+
+    bool isRunning() const;
+    int getPort() const;
+    // Connections currently open, and accepted since start().
+    std::size_t getOpenConnectionCount() const;
+    std::size_t getAcceptedConnectionCount() const;
+
+private:
+    void acceptLoop();
+    void serveConnection(std::intptr_t client);
+    bool readRequest(std::intptr_t client, std::string& buffer, LocalHttpRequest& request, bool& keepAlive);
+
+    Handler handler;
+    std::intptr_t listenSocket;
+    std::atomic<bool> running;
+    std::atomic<int> port;
+    std::thread acceptThread;
+
+    mutable std::mutex mutex;
+    std::condition_variable connectionsClosed;
+    std::set<std::intptr_t> clients;
+    std::size_t acceptedConnections = 0;
+};
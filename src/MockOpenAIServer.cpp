@@ -0,0 +1,290 @@
+#include "MockOpenAIServer.h"
+
+#include "ofMain.h"
+#include "ofJson.h"
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+namespace {
+    const char* const REPLY_WORDS[] = {
+        "The", " quick", " brown", " fox", " jumps", " over", " the", " lazy", " dog", ".",
+        " Mock", " replies", " are", " deterministic", " so", " runs", " compare", " cleanly", "."
+    };
+    const std::size_t REPLY_WORD_COUNT = sizeof(REPLY_WORDS) / sizeof(REPLY_WORDS[0]);
+
+    void sleepSeconds(double seconds) {
+        if (seconds > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        }
+    }
+
+    std::string errorBody(const std::string& message, const std::string& type) {
+        ofJson error;
+        error["error"]["message"] = message;
+        error["error"]["type"] = type;
+        return error.dump();
+    }
+
+    // Rough prompt size: one token per whitespace-separated word.
+    int countPromptTokens(const ofJson& messages) {
+        int tokens = 0;
+        if (!messages.is_array()) {
+            return tokens;
+        }
+
+        for (const auto& message : messages) {
+            if (!message.contains("content") || !message["content"].is_string()) {
+                continue;
+            }
+
+            bool inWord = false;
+            for (char c : message["content"].get<std::string>()) {
+                const bool space = c == ' ' || c == '\n' || c == '\t' || c == '\r';
+                if (!space && !inWord) {
+                    ++tokens;
+                }
+                inWord = !space;
+            }
+        }
+        return tokens;
+    }
+
+    ofJson usageBlock(int promptTokens, int completionTokens) {
+        ofJson usage;
+        usage["prompt_tokens"] = promptTokens;
+        usage["completion_tokens"] = completionTokens;
+        usage["total_tokens"] = promptTokens + completionTokens;
+        return usage;
+    }
+}
+
+MockOpenAIServer::MockOpenAIServer()
+: random(settings.randomSeed) {
+}
+
+MockOpenAIServer::~MockOpenAIServer() {
+    stop();
+}
+
+bool MockOpenAIServer::start(const std::string& listenHost, int port) {
+    host = listenHost;
+    return server.start(listenHost, port, [this](const LocalHttpRequest& request, LocalHttpResponse& response) {
+        handleRequest(request, response);
+    });
+}
+
+void MockOpenAIServer::stop() {
+    server.stop();
+}
+
+bool MockOpenAIServer::isRunning() const {
+    return server.isRunning();
+}
+
+int MockOpenAIServer::getPort() const {
+    return server.getPort();
+}
+
+std::string MockOpenAIServer::getBaseUrl() const {
+    const std::string urlHost = host.empty() || host == "0.0.0.0" ? "127.0.0.1" : host;
+    return "http://" + urlHost + ":" + std::to_string(getPort()) + "/v1";
+}
+
+void MockOpenAIServer::setSettings(const MockOpenAIServerSettings& newSettings) {
+    std::lock_guard<std::mutex> lock(mutex);
+    settings = newSettings;
+    random.seed(settings.randomSeed);
+}
+
+MockOpenAIServerSettings MockOpenAIServer::getSettings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return settings;
+}
+
+MockOpenAIServerStats MockOpenAIServer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    MockOpenAIServerStats result = stats;
+    result.acceptedConnections = server.getAcceptedConnectionCount();
+    return result;
+}
+
+void MockOpenAIServer::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats = MockOpenAIServerStats();
+}
+
+void MockOpenAIServer::handleRequest(const LocalHttpRequest& request, LocalHttpResponse& response) {
+    if (request.path == "/v1/chat/completions" || request.path == "/chat/completions") {
+        if (request.method != "POST") {
+            response.send(405, "application/json", errorBody("Use POST.", "invalid_request_error"));
+            return;
+        }
+        handleChatCompletions(request, response);
+        return;
+    }
+
+    if (request.path == "/v1/models" || request.path == "/models") {
+        handleModels(response);
+        return;
+    }
+
+    response.send(404, "application/json", errorBody("Unknown path " + request.path, "invalid_request_error"));
+}
+
+void MockOpenAIServer::handleChatCompletions(const LocalHttpRequest& request, LocalHttpResponse& response) {
+    ofJson body;
+    try {
+        body = ofJson::parse(request.body);
+    } catch (const std::exception& exception) {
+        response.send(400, "application/json", errorBody(std::string("Invalid JSON: ") + exception.what(), "invalid_request_error"));
+        return;
+    }
+
+    const bool stream = body.value("stream", false);
+    const bool includeUsage = body.contains("stream_options") && body["stream_options"].is_object()
+        && body["stream_options"].value("include_usage", false);
+
+    // Draw every random decision up front so one request consumes a fixed
+    // amount of the sequence, whatever path it takes.
+    MockOpenAIServerSettings current;
+    bool injectError = false;
+    bool injectDisconnect = false;
+    double latency = 0.0;
+    std::size_t completionId = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = settings;
+        injectDisconnect = nextRandom() < current.disconnectRate;
+        injectError = nextRandom() < current.errorRate;
+        latency = current.firstTokenLatency + current.latencyJitter * nextRandom();
+        completionId = nextCompletionId++;
+
+        ++stats.chatRequests;
+        if (stream) {
+            ++stats.streamedRequests;
+        }
+        if (injectDisconnect) {
+            ++stats.injectedDisconnects;
+        } else if (injectError) {
+            ++stats.injectedErrors;
+        }
+    }
+
+    sleepSeconds(latency);
+
+    if (injectDisconnect) {
+        response.abort();
+        return;
+    }
+
+    if (injectError) {
+        std::vector<std::string> headers;
+        if (current.retryAfter >= 0.0) {
+            headers.push_back("Retry-After: " + ofToString(current.retryAfter));
+        }
+        response.send(current.errorStatus, "application/json", errorBody("Injected failure.", "server_error"), headers);
+        return;
+    }
+
+    int tokens = current.completionTokens;
+    for (const char* limitKey : {"max_tokens", "max_completion_tokens"}) {
+        if (body.contains(limitKey) && body[limitKey].is_number_integer()) {
+            tokens = std::min(tokens, body[limitKey].get<int>());
+        }
+    }
+    tokens = std::max(0, tokens);
+
+    const std::string model = body.value("model", current.models.empty() ? std::string("mock-model") : current.models[0]);
+    const std::string id = "chatcmpl-mock-" + std::to_string(completionId);
+    const std::int64_t created = static_cast<std::int64_t>(std::time(nullptr));
+    const int promptTokens = countPromptTokens(body.value("messages", ofJson::array()));
+    const double tokenInterval = current.tokensPerSecond > 0.0 ? 1.0 / current.tokensPerSecond : 0.0;
+
+    if (!stream) {
+        std::string content;
+        for (int i = 0; i < tokens; ++i) {
+            content += REPLY_WORDS[i % REPLY_WORD_COUNT];
+        }
+        // The first token is covered by the initial latency.
+        sleepSeconds(tokenInterval * std::max(0, tokens - 1));
+
+        ofJson reply;
+        reply["id"] = id;
+        reply["object"] = "chat.completion";
+        reply["created"] = created;
+        reply["model"] = model;
+        reply["choices"] = ofJson::array();
+        reply["choices"].push_back({
+            {"index", 0},
+            {"message", {{"role", "assistant"}, {"content", content}}},
+            {"finish_reason", "stop"}
+        });
+        reply["usage"] = usageBlock(promptTokens, tokens);
+        response.send(200, "application/json", reply.dump());
+        return;
+    }
+
+    auto chunk = [&](const ofJson& delta, const ofJson& finishReason) {
+        ofJson event;
+        event["id"] = id;
+        event["object"] = "chat.completion.chunk";
+        event["created"] = created;
+        event["model"] = model;
+        event["choices"] = ofJson::array();
+        event["choices"].push_back({{"index", 0}, {"delta", delta}, {"finish_reason", finishReason}});
+        return "data: " + event.dump() + "\n\n";
+    };
+
+    if (!response.beginStream(200, "text/event-stream", {"Cache-Control: no-cache"})) {
+        return;
+    }
+
+    if (!response.writeChunk(chunk({{"role", "assistant"}, {"content", ""}}, nullptr))) {
+        return;
+    }
+
+    for (int i = 0; i < tokens; ++i) {
+        if (i > 0) {
+            sleepSeconds(tokenInterval);
+        }
+        if (!response.writeChunk(chunk({{"content", REPLY_WORDS[i % REPLY_WORD_COUNT]}}, nullptr))) {
+            return; // Client went away.
+        }
+    }
+
+    response.writeChunk(chunk(ofJson::object(), "stop"));
+
+    if (includeUsage) {
+        ofJson usage;
+        usage["id"] = id;
+        usage["object"] = "chat.completion.chunk";
+        usage["created"] = created;
+        usage["model"] = model;
+        usage["choices"] = ofJson::array();
+        usage["usage"] = usageBlock(promptTokens, tokens);
+        response.writeChunk("data: " + usage.dump() + "\n\n");
+    }
+
+    response.writeChunk("data: [DONE]\n\n");
+    response.endStream();
+}
+
+void MockOpenAIServer::handleModels(LocalHttpResponse& response) {
+    ofJson reply;
+    reply["object"] = "list";
+    reply["data"] = ofJson::array();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.modelRequests;
+        for (const auto& model : settings.models) {
+            reply["data"].push_back({{"id", model}, {"object", "model"}, {"owned_by", "mock"}});
+        }
+    }
+    response.send(200, "application/json", reply.dump());
+}
+
+double MockOpenAIServer::nextRandom() {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(random);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "LocalHttpServer.h"
+
+#include <cstddef>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// Behaviour of the mock endpoint. All delays are in seconds.
+struct MockOpenAIServerSettings {
+    std::vector<std::string> models = {"mock-model"};
+    // Time before the first byte of a reply (time to first token when streaming).
+    double firstTokenLatency = 0.2;
+    // Uniform random extra delay added to firstTokenLatency.
+    double latencyJitter = 0.0;
+    // Generation speed after the first token. 0 sends every token at once.
+    double tokensPerSecond = 50.0;
+    // Reply length when the request does not ask for fewer via max_tokens.
+    int completionTokens = 64;
+    // Fraction of chat requests answered with errorStatus instead of a reply.
+    double errorRate = 0.0;
+    int errorStatus = 503;
+    // Sent as Retry-After with injected errors when >= 0.
+    double retryAfter = -1.0;
+    // Fraction of chat requests whose connection is dropped without a reply.
+    double disconnectRate = 0.0;
+    // Seed for latency jitter and fault injection, so runs are reproducible.
+    unsigned int randomSeed = 1;
+};
+
+// Counters collected while the mock server runs.
+struct MockOpenAIServerStats {
+    std::size_t chatRequests = 0;
+    std::size_t streamedRequests = 0;
+    std::size_t modelRequests = 0;
+    std::size_t injectedErrors = 0;
+    std::size_t injectedDisconnects = 0;
+    std::size_t acceptedConnections = 0;
+};
+
+// Local stand-in for an OpenAI-compatible endpoint. It serves
+// /v1/chat/completions (blocking and SSE streaming) and /v1/models with
+// configurable latency, token rate and fault injection, so RemoteAPIProvider
+// can be measured without network access.
+class MockOpenAIServer {
+public:
+    MockOpenAIServer();
+    ~MockOpenAIServer();
+
+    // Port 0 picks a free port; see getPort().
+    bool start(const std::string& host = "127.0.0.1", int port = 8089);
+    void stop();
+    bool isRunning() const;
+
+    int getPort() const;
+    // Base URL to pass to RemoteAPIProvider, e.g. "http://127.0.0.1:8089/v1".
+    std::string getBaseUrl() const;
+
+    void setSettings(const MockOpenAIServerSettings& settings);
+    MockOpenAIServerSettings getSettings() const;
+    MockOpenAIServerStats getStats() const;
+    void resetStats();
+
+private:
+    void handleRequest(const LocalHttpRequest& request, LocalHttpResponse& response);
+    void handleChatCompletions(const LocalHttpRequest& request, LocalHttpResponse& response);
+    void handleModels(LocalHttpResponse& response);
+    double nextRandom();
+
+    LocalHttpServer server;
+    std::string host;
+
+    mutable std::mutex mutex;
+    MockOpenAIServerSettings settings;
+    MockOpenAIServerStats stats;
+    std::mt19937 random;
+    std::size_t nextCompletionId = 1;
+};
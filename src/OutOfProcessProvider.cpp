@@ -0,0 +1,325 @@
+#include "OutOfProcessProvider.h"
+
+#include "InferenceWorkerProcess.h"
+
+#include "ofMain.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Tokens arrive every few milliseconds, so after a short spin the reader
+    // sleeps this long between looks at the ring.
+    const std::chrono::microseconds RING_POLL_INTERVAL(200);
+    const int RING_SPIN_COUNT = 64;
+    // How often a waiting request checks that the worker is still alive.
+    const std::chrono::milliseconds WORKER_CHECK_INTERVAL(20);
+    // How long a worker gets to exit after shutdown before it is killed.
+    const std::chrono::milliseconds WORKER_EXIT_TIMEOUT(2000);
+}
+
+OutOfProcessProvider::OutOfProcessProvider(const std::string& workerExecutable)
+: workerExecutable(workerExecutable) {
+}
+
+OutOfProcessProvider::~OutOfProcessProvider() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorkerLocked(true);
+}
+
+bool OutOfProcessProvider::setup(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    modelPath = path;
+
+    if (!checkWorker() && !startWorker()) {
+        return false;
+    }
+    if (!loadModelInWorker()) {
+        ofLogError("OutOfProcessProvider") << "Worker failed to load " << path;
+        return false;
+    }
+    return true;
+}
+
+std::string OutOfProcessProvider::generate(const std::string& prompt) {
+    return generateStream(prompt, nullptr);
+}
+
+bool OutOfProcessProvider::isRemote() const {
+    return false;
+}
+
+void OutOfProcessProvider::setRingCapacity(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ringCapacity = bytes;
+}
+
+bool OutOfProcessProvider::isWorkerRunning() const {
+    return workerProcessId != 0;
+}
+
+int OutOfProcessProvider::getWorkerProcessId() const {
+    return workerProcessId;
+}
+
+std::size_t OutOfProcessProvider::getRestartCount() const {
+    return restartCount;
+}
+
+void OutOfProcessProvider::stopWorker() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopWorkerLocked(true);
+}
+
+#ifndef _WIN32
+
+std::string OutOfProcessProvider::generateStream(const std::string& prompt,
+                                                 InferenceTokenCallback onToken,
+                                                 std::shared_ptr<InferenceCancellationToken> cancel) {
+    // The worker runs one generation at a time, so requests take turns here.
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (modelPath.empty()) {
+        ofLogError("OutOfProcessProvider") << "No model set. Call setup() first.";
+        return "";
+    }
+
+    if (!checkWorker()) {
+        if (!startWorker() || !loadModelInWorker()) {
+            stopWorkerLocked(false);
+            return "";
+        }
+    }
+
+    const std::uint32_t requestId = nextRequestId++;
+    ofJson command;
+    command["type"] = "generate";
+    command["id"] = requestId;
+    command["prompt"] = prompt;
+    if (!InferenceWorkerProcess::sendMessage(commandSocket, command)) {
+        ofLogError("OutOfProcessProvider") << "Lost the connection to the worker.";
+        checkWorker();
+        return "";
+    }
+
+    std::string output;
+    SharedTokenRing::Record record;
+    int idle = 0;
+    Clock::time_point lastCheck = Clock::now();
+
+    while (true) {
+        if (ring.tryRead(record)) {
+            idle = 0;
+            if (record.requestId != requestId) {
+                continue; // Leftovers of a cancelled request.
+            }
+
+            if (record.type == SharedTokenRing::TOKEN) {
+                output += record.text;
+                if (onToken) {
+                    onToken(record.text);
+                }
+            } else if (record.type == SharedTokenRing::FAILED) {
+                ofLogError("OutOfProcessProvider") << record.text;
+                return output;
+            } else {
+                return output;
+            }
+            continue;
+        }
+
+        if (cancel && cancel->isCancelled()) {
+            ofJson cancelCommand;
+            cancelCommand["type"] = "cancel";
+            cancelCommand["id"] = requestId;
+            InferenceWorkerProcess::sendMessage(commandSocket, cancelCommand);
+            return output;
+        }
+
+        const Clock::time_point now = Clock::now();
+        if (now - lastCheck >= WORKER_CHECK_INTERVAL) {
+            lastCheck = now;
+            if (!checkWorker()) {
+                return output;
+            }
+        }
+
+        if (++idle < RING_SPIN_COUNT) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(RING_POLL_INTERVAL);
+        }
+    }
+}
+
+bool OutOfProcessProvider::startWorker() {
+    stopWorkerLocked(false);
+
+    if (!ring.create(SharedTokenRing::makeUniqueName(), ringCapacity)) {
+        return false;
+    }
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+        ofLogError("OutOfProcessProvider") << "Cannot create the command socket: " << std::strerror(errno);
+        ring.close();
+        return false;
+    }
+#ifdef SO_NOSIGPIPE
+    const int noSigPipe = 1;
+    setsockopt(sockets[0], SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+    fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+
+    // Everything the child needs is prepared before fork(), which only allows
+    // async-signal-safe calls until exec.
+    const std::string socketArgument = std::to_string(sockets[1]);
+    const std::string ringName = ring.getName();
+    char* const arguments[] = {
+        const_cast<char*>(workerExecutable.c_str()),
+        const_cast<char*>("--fd"), const_cast<char*>(socketArgument.c_str()),
+        const_cast<char*>("--ring"), const_cast<char*>(ringName.c_str()),
+        nullptr
+    };
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+        execv(workerExecutable.c_str(), arguments);
+        _exit(127);
+    }
+
+    ::close(sockets[1]);
+    if (pid < 0) {
+        ofLogError("OutOfProcessProvider") << "Cannot start the worker: " << std::strerror(errno);
+        ::close(sockets[0]);
+        ring.close();
+        return false;
+    }
+
+    commandSocket = sockets[0];
+    workerProcessId = static_cast<int>(pid);
+    readBuffer.clear();
+
+    if (workerFailed) {
+        ++restartCount;
+        workerFailed = false;
+    }
+
+    ofLogNotice("OutOfProcessProvider") << "Started worker " << workerProcessId << " (" << workerExecutable << ")";
+    return true;
+}
+
+bool OutOfProcessProvider::loadModelInWorker() {
+    ofJson command;
+    command["type"] = "setup";
+    command["model"] = modelPath;
+    if (!InferenceWorkerProcess::sendMessage(commandSocket, command)) {
+        checkWorker();
+        return false;
+    }
+
+    ofJson reply;
+    while (InferenceWorkerProcess::readMessage(commandSocket, readBuffer, reply)) {
+        if (reply.value("type", "") == "setup") {
+            return reply.value("ok", false);
+        }
+    }
+
+    // The socket closed: the worker did not start or crashed while loading.
+    checkWorker();
+    return false;
+}
+
+bool OutOfProcessProvider::checkWorker() {
+    if (workerProcessId == 0) {
+        return false;
+    }
+
+    int status = 0;
+    const pid_t result = waitpid(static_cast<pid_t>(workerProcessId), &status, WNOHANG);
+    if (result == 0) {
+        return true;
+    }
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 127) {
+        ofLogError("OutOfProcessProvider") << "Cannot run worker " << workerExecutable;
+    } else if (WIFSIGNALED(status)) {
+        ofLogError("OutOfProcessProvider") << "Worker " << workerProcessId << " died with signal " << WTERMSIG(status);
+    } else {
+        ofLogError("OutOfProcessProvider") << "Worker " << workerProcessId << " exited.";
+    }
+
+    workerProcessId = 0;
+    workerFailed = true;
+    stopWorkerLocked(false);
+    return false;
+}
+
+void OutOfProcessProvider::stopWorkerLocked(bool graceful) {
+    if (commandSocket >= 0) {
+        if (graceful && workerProcessId != 0) {
+            ofJson command;
+            command["type"] = "shutdown";
+            InferenceWorkerProcess::sendMessage(commandSocket, command);
+        }
+        // The worker also leaves once it sees the socket close.
+        ::close(commandSocket);
+        commandSocket = -1;
+    }
+
+    if (workerProcessId != 0) {
+        const pid_t pid = static_cast<pid_t>(workerProcessId);
+        const Clock::time_point deadline = Clock::now() + WORKER_EXIT_TIMEOUT;
+        while (waitpid(pid, nullptr, WNOHANG) == 0) {
+            if (Clock::now() >= deadline) {
+                ofLogWarning("OutOfProcessProvider") << "Worker " << pid << " did not exit, killing it.";
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(WORKER_CHECK_INTERVAL);
+        }
+        workerProcessId = 0;
+    }
+
+    ring.close();
+    readBuffer.clear();
+}
+
+#else
+
+std::string OutOfProcessProvider::generateStream(const std::string&, InferenceTokenCallback,
+                                                 std::shared_ptr<InferenceCancellationToken>) {
+    ofLogError("OutOfProcessProvider") << "Out-of-process inference is not supported on Windows.";
+    return "";
+}
+
+bool OutOfProcessProvider::startWorker() {
+    ofLogError("OutOfProcessProvider") << "Out-of-process inference is not supported on Windows.";
+    return false;
+}
+
+bool OutOfProcessProvider::loadModelInWorker() {
+    return false;
+}
+
+bool OutOfProcessProvider::checkWorker() {
+    return false;
+}
+
+void OutOfProcessProvider::stopWorkerLocked(bool) {
+}
+
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+#include "SharedTokenRing.h"
+
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Runs the local engine in a separate worker process (see
+// InferenceWorkerProcess and the --fd dispatch in
+// example_out_of_process/src/main.cpp), so a crash or a
+// long stall while loading or decoding cannot take the renderer down with it.
+// Commands go over a local socket; reply tokens come back through a
+// lock-free ring in shared memory. A worker that dies is started again, with
+// the same model, on the next request. POSIX only.
+class OutOfProcessProvider : public IInferenceProvider {
+public:
+    // workerExecutable is the path of a program that calls InferenceWorkerProcess::main().
+    explicit OutOfProcessProvider(const std::string& workerExecutable);
+    ~OutOfProcessProvider() override;
+
+    // Starts the worker if needed and loads the model there. Blocks until the
+    // worker has loaded it or failed.
+    bool setup(const std::string& modelPath) override;
+    std::string generate(const std::string& prompt) override;
+    std::string generateStream(const std::string& prompt,
+                               InferenceTokenCallback onToken,
+                               std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    bool isRemote() const override;
+
+    // Ring size; takes effect when the worker is next started.
+    void setRingCapacity(std::size_t bytes);
+
+    // These three do not wait for a running request, so they are safe to
+    // call from draw().
+    bool isWorkerRunning() const;
+    // Process id of the running worker, or 0.
+    int getWorkerProcessId() const;
+    // Times a worker was started again after it died.
+    std::size_t getRestartCount() const;
+    // Ends the worker. The next request starts a new one.
+    void stopWorker();
+
+private:
+    bool startWorker();
+    bool loadModelInWorker();
+    // Reaps the worker if it has exited; true while it is alive.
+    bool checkWorker();
+    void stopWorkerLocked(bool graceful);
+
+    std::string workerExecutable;
+    std::string modelPath;
+    std::size_t ringCapacity = 1 << 20;
+
+    // Held for a whole request or model load, so requests take turns.
+    mutable std::mutex mutex;
+    SharedTokenRing ring;
+    int commandSocket = -1;
+    std::atomic<int> workerProcessId{0};
+    bool workerFailed = false;
+    std::atomic<std::size_t> restartCount{0};
+    std::uint32_t nextRequestId = 1;
+    std::string readBuffer;
+};
@@ -0,0 +1,132 @@
+#include "RecordingProvider.h"
+
+#include "ofMain.h"
+
+RecordingProvider::RecordingProvider(std::shared_ptr<IInferenceProvider> provider)
+: provider(provider)
+, origin(Clock::now().time_since_epoch().count()) {
+}
+
+bool RecordingProvider::open(const std::string& path) {
+    if (!provider) {
+        ofLogError("RecordingProvider") << "No provider to record.";
+        return false;
+    }
+
+    origin = Clock::now().time_since_epoch().count();
+    recordCount = 0;
+    return writer.open(path, provider->isRemote());
+}
+
+void RecordingProvider::close() {
+    writer.close();
+}
+
+bool RecordingProvider::isRecording() const {
+    return writer.isOpen();
+}
+
+std::size_t RecordingProvider::getRecordCount() const {
+    return recordCount;
+}
+
+bool RecordingProvider::setup(const std::string& modelOrUrl) {
+    if (!provider) {
+        ofLogError("RecordingProvider") << "No provider to set up.";
+        return false;
+    }
+    return provider->setup(modelOrUrl);
+}
+
+std::string RecordingProvider::generate(const std::string& prompt) {
+    InferenceLogRecord record;
+    record.prompt = prompt;
+    Capture capture(*this, record);
+    const std::string response = provider->generate(prompt);
+    capture.finish(response, nullptr);
+    return response;
+}
+
+std::string RecordingProvider::generateChat(const std::vector<InferenceChatMessage>& messages) {
+    InferenceLogRecord record;
+    record.chat = true;
+    record.messages = messages;
+    Capture capture(*this, record);
+    const std::string response = provider->generateChat(messages);
+    capture.finish(response, nullptr);
+    return response;
+}
+
+std::string RecordingProvider::generateStream(const std::string& prompt,
+                                              InferenceTokenCallback onToken,
+                                              std::shared_ptr<InferenceCancellationToken> cancel) {
+    InferenceLogRecord record;
+    record.prompt = prompt;
+    record.streamed = true;
+    Capture capture(*this, record);
+    const std::string response = provider->generateStream(prompt, capture.wrap(onToken), cancel);
+    capture.finish(response, cancel);
+    return response;
+}
+
+std::string RecordingProvider::generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                                  InferenceTokenCallback onToken,
+                                                  std::shared_ptr<InferenceCancellationToken> cancel) {
+    InferenceLogRecord record;
+    record.chat = true;
+    record.messages = messages;
+    record.streamed = true;
+    Capture capture(*this, record);
+    const std::string response = provider->generateChatStream(messages, capture.wrap(onToken), cancel);
+    capture.finish(response, cancel);
+    return response;
+}
+
+bool RecordingProvider::isRemote() const {
+    return provider && provider->isRemote();
+}
+
+long long RecordingProvider::getCompletionTokenCount() const {
+    return provider ? provider->getCompletionTokenCount() : -1;
+}
+
+std::uint64_t RecordingProvider::microsSince(Clock::time_point from, Clock::time_point to) const {
+    return to > from ? static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count()) : 0;
+}
+
+RecordingProvider::Clock::time_point RecordingProvider::getOrigin() const {
+    return Clock::time_point(Clock::duration(origin.load()));
+}
+
+RecordingProvider::Capture::Capture(RecordingProvider& owner, InferenceLogRecord& record)
+: owner(owner)
+, record(record)
+, startedAt(Clock::now())
+, lastTokenAt(startedAt) {
+    record.startMicros = owner.microsSince(owner.getOrigin(), startedAt);
+}
+
+InferenceTokenCallback RecordingProvider::Capture::wrap(InferenceTokenCallback onToken) {
+    return [this, onToken](const std::string& piece) {
+        const Clock::time_point now = Clock::now();
+        InferenceLogToken token;
+        token.delayMicros = owner.microsSince(lastTokenAt, now);
+        token.text = piece;
+        record.tokens.push_back(std::move(token));
+        lastTokenAt = now;
+
+        if (onToken) {
+            onToken(piece);
+        }
+    };
+}
+
+void RecordingProvider::Capture::finish(const std::string& response, const std::shared_ptr<InferenceCancellationToken>& cancel) {
+    record.durationMicros = owner.microsSince(startedAt, Clock::now());
+    record.cancelled = cancel && cancel->isCancelled();
+    record.response = response;
+
+    if (owner.writer.write(record)) {
+        ++owner.recordCount;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+#include "InferenceLog.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Wraps another provider and writes every request, the timing of each streamed
+// token and the final reply to an InferenceLog. Requests pass through
+// unchanged; ReplayProvider plays the log back later without a model or network.
+class RecordingProvider : public IInferenceProvider {
+public:
+    explicit RecordingProvider(std::shared_ptr<IInferenceProvider> provider);
+
+    // Starts a new log; request start times are measured from here.
+    bool open(const std::string& path);
+    void close();
+    bool isRecording() const;
+    std::size_t getRecordCount() const;
+
+    bool setup(const std::string& modelOrUrl) override;
+    std::string generate(const std::string& prompt) override;
+    std::string generateChat(const std::vector<InferenceChatMessage>& messages) override;
+    std::string generateStream(const std::string& prompt,
+                               InferenceTokenCallback onToken,
+                               std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    std::string generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                   InferenceTokenCallback onToken,
+                                   std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    bool isRemote() const override;
+    long long getCompletionTokenCount() const override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Collects one record while its request runs.
+    class Capture {
+    public:
+        Capture(RecordingProvider& owner, InferenceLogRecord& record);
+        InferenceTokenCallback wrap(InferenceTokenCallback onToken);
+        void finish(const std::string& response, const std::shared_ptr<InferenceCancellationToken>& cancel);
+
+    private:
+        RecordingProvider& owner;
+        InferenceLogRecord& record;
+        Clock::time_point startedAt;
+        Clock::time_point lastTokenAt;
+    };
+
+    std::uint64_t microsSince(Clock::time_point from, Clock::time_point to) const;
+    Clock::time_point getOrigin() const;
+
+    std::shared_ptr<IInferenceProvider> provider;
+    InferenceLogWriter writer;
+    // Clock ticks of the log start. Atomic because open() may run while
+    // requests on other threads read it.
+    std::atomic<Clock::rep> origin;
+    std::atomic<std::size_t> recordCount{0};
+};
@@ -1,8 +1,30 @@
 #include "RemoteAPIProvider.h"
 
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
 namespace {
     const char* const DEFAULT_OPENAI_ENDPOINT = "https://api.openai.com/v1/chat/completions";
     const char* const DEFAULT_MODEL = "gpt-4o-mini";
+    const long CONNECT_TIMEOUT_SECONDS = 30;
+    const long STALL_TIMEOUT_SECONDS = 120;
+    // Listings are small; a host that cannot answer in time counts as down.
+    const long LIST_TIMEOUT_SECONDS = 10;
+    const std::size_t MAX_LATENCY_SAMPLES = 64;
+
+    // Opening/closing tag pairs removed when reasoning stripping is enabled.
+    const std::vector<std::pair<std::string, std::string>> REASONING_TAGS = {
+        {"<think>", "</think>"},
+        {"<thinking>", "</thinking>"},
+        {"<reasoning>", "</reasoning>"}
+    };
 
     bool endsWith(const std::string& value, const std::string& suffix) {
         if (suffix.size() > value.size()) {
@@ -56,22 +78,470 @@ namespace {
     bool containsText(const std::string& value, const std::string& needle) {
         return value.find(needle) != std::string::npos;
     }
+
+    bool isWhitespace(char c) {
+        return c == '\n' || c == '\r' || c == ' ' || c == '\t';
+    }
+
+    // Splits a text/event-stream body into complete "data:" payloads as bytes arrive.
+    // Multi-line data fields are joined with newlines and "[DONE]" ends the stream.
+    class ServerSentEventParser {
+    public:
+        explicit ServerSentEventParser(std::function<void(const std::string&)> onData)
+        : onData(std::move(onData)) {
+        }
+
+        void feed(const char* data, std::size_t size) {
+            buffer.append(data, size);
+
+            std::size_t lineStart = 0;
+            std::size_t lineEnd = buffer.find('\n', lineStart);
+            while (lineEnd != std::string::npos) {
+                std::size_t length = lineEnd - lineStart;
+                if (length > 0 && buffer[lineEnd - 1] == '\r') {
+                    --length;
+                }
+
+                handleLine(buffer.data() + lineStart, length);
+                lineStart = lineEnd + 1;
+                lineEnd = buffer.find('\n', lineStart);
+            }
+
+            buffer.erase(0, lineStart);
+        }
+
+        void finish() {
+            if (!buffer.empty()) {
+                handleLine(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+            dispatchEvent();
+        }
+
+        bool isDone() const {
+            return done;
+        }
+
+        // Drops any partial event so the parser can read a fresh stream.
+        void reset() {
+            buffer.clear();
+            eventData.clear();
+            done = false;
+        }
+
+    private:
+        void handleLine(const char* line, std::size_t length) {
+            if (length == 0) {
+                dispatchEvent();
+                return;
+            }
+
+            if (line[0] == ':') {
+                return; // Comment or keep-alive ping.
+            }
+
+            if (length >= 5 && std::strncmp(line, "data:", 5) == 0) {
+                std::size_t offset = 5;
+                if (offset < length && line[offset] == ' ') {
+                    ++offset;
+                }
+
+                if (!eventData.empty()) {
+                    eventData += '\n';
+                }
+                eventData.append(line + offset, length - offset);
+            }
+        }
+
+        void dispatchEvent() {
+            if (eventData.empty() || done) {
+                eventData.clear();
+                return;
+            }
+
+            if (eventData == "[DONE]") {
+                done = true;
+            } else {
+                onData(eventData);
+            }
+            eventData.clear();
+        }
+
+        std::function<void(const std::string&)> onData;
+        std::string buffer;
+        std::string eventData;
+        bool done = false;
+    };
+
+    // Streaming counterpart of RemoteAPIProvider::stripReasoningBlocks(). Text inside
+    // reasoning tags is dropped and a possible partial tag is held back until the
+    // next delta decides it, so callers never see fragments of "<think>".
+    class ReasoningStreamFilter {
+    public:
+        std::string push(const std::string& delta) {
+            pending += delta;
+            std::string out;
+
+            while (!pending.empty()) {
+                if (!closeTag.empty()) {
+                    const std::size_t end = pending.find(closeTag);
+                    if (end == std::string::npos) {
+                        if (pending.size() >= closeTag.size()) {
+                            pending.erase(0, pending.size() - (closeTag.size() - 1));
+                        }
+                        break;
+                    }
+
+                    pending.erase(0, end + closeTag.size());
+                    closeTag.clear();
+                    continue;
+                }
+
+                std::size_t start = std::string::npos;
+                const std::pair<std::string, std::string>* match = nullptr;
+                for (const auto& tag : REASONING_TAGS) {
+                    const std::size_t position = pending.find(tag.first);
+                    if (position < start) {
+                        start = position;
+                        match = &tag;
+                    }
+                }
+
+                if (match) {
+                    out.append(pending, 0, start);
+                    pending.erase(0, start + match->first.size());
+                    closeTag = match->second;
+                    continue;
+                }
+
+                std::size_t keep = 0;
+                const std::size_t lastOpen = pending.rfind('<');
+                if (lastOpen != std::string::npos && couldStartTag(pending.substr(lastOpen))) {
+                    keep = pending.size() - lastOpen;
+                }
+
+                out.append(pending, 0, pending.size() - keep);
+                pending.erase(0, pending.size() - keep);
+                break;
+            }
+
+            return trimLeading(out);
+        }
+
+        std::string finish() {
+            std::string out = closeTag.empty() ? pending : "";
+            pending.clear();
+            return trimLeading(out);
+        }
+
+    private:
+        static bool couldStartTag(const std::string& text) {
+            for (const auto& tag : REASONING_TAGS) {
+                if (text.size() < tag.first.size() && tag.first.compare(0, text.size(), text) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::string trimLeading(std::string text) {
+            if (!emittedText) {
+                std::size_t first = 0;
+                while (first < text.size() && isWhitespace(text[first])) {
+                    ++first;
+                }
+                text.erase(0, first);
+                emittedText = !text.empty();
+            }
+            return text;
+        }
+
+        std::string pending;
+        std::string closeTag;
+        bool emittedText = false;
+    };
+
+    // SAX handler that pulls choices[0].<container>.content and the usage token
+    // counts out of a chat completion without building a DOM. container is
+    // "message" for blocking replies and "delta" for stream chunks. Parsing stops
+    // once both have been read; usage normally comes last, after any logprobs.
+    class ChatContentReader {
+    public:
+        explicit ChatContentReader(const char* container)
+        : container(container) {
+        }
+
+        bool null() { return scalar(); }
+        bool boolean(bool) { return scalar(); }
+        bool number_integer(ofJson::number_integer_t value) { return number(static_cast<long long>(value)); }
+        bool number_unsigned(ofJson::number_unsigned_t value) { return number(static_cast<long long>(value)); }
+        bool number_float(ofJson::number_float_t, const ofJson::string_t&) { return scalar(); }
+        bool binary(ofJson::binary_t&) { return scalar(); }
+
+        bool string(ofJson::string_t& value) {
+            if (beginValue() == Location::Content) {
+                content = std::move(value);
+                hasContent = true;
+                return !isComplete();
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) {
+            if (beginValue() == Location::Container) {
+                hasContainer = true;
+            }
+            frames.push_back(Frame());
+            return true;
+        }
+
+        bool key(ofJson::string_t& name) {
+            frames.back().key = std::move(name);
+            return true;
+        }
+
+        bool end_object() {
+            frames.pop_back();
+            return true;
+        }
+
+        bool start_array(std::size_t) {
+            if (beginValue() == Location::Choices) {
+                hasChoices = true;
+            }
+            frames.push_back(Frame());
+            frames.back().isArray = true;
+            return true;
+        }
+
+        bool end_array() {
+            frames.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& exception) {
+            error = exception.what();
+            return false;
+        }
+
+        std::string content;
+        std::string error;
+        bool hasChoices = false;
+        bool hasFirstChoice = false;
+        bool hasContainer = false;
+        bool hasContent = false;
+        bool hasErrorField = false;
+        long long promptTokens = -1;
+        long long completionTokens = -1;
+
+        bool hasUsage() const {
+            return promptTokens >= 0 && completionTokens >= 0;
+        }
+
+    private:
+        enum class Location {
+            Other,
+            Choices,
+            FirstChoice,
+            Container,
+            Content,
+            PromptTokens,
+            CompletionTokens
+        };
+
+        struct Frame {
+            bool isArray = false;
+            std::string key;
+            std::size_t count = 0;
+        };
+
+        bool scalar() {
+            beginValue();
+            return true;
+        }
+
+        bool number(long long value) {
+            const Location location = beginValue();
+            if (location == Location::PromptTokens) {
+                promptTokens = value;
+            } else if (location == Location::CompletionTokens) {
+                completionTokens = value;
+            } else {
+                return true;
+            }
+            return !isComplete();
+        }
+
+        bool isComplete() const {
+            return hasContent && hasUsage();
+        }
+
+        // Classifies the value that starts at the current position.
+        Location beginValue() {
+            if (frames.empty()) {
+                return Location::Other;
+            }
+
+            Frame& current = frames.back();
+            ++current.count;
+
+            if (frames[0].isArray) {
+                return Location::Other;
+            }
+
+            if (frames.size() == 1) {
+                if (current.key == "error") {
+                    hasErrorField = true;
+                }
+                return current.key == "choices" ? Location::Choices : Location::Other;
+            }
+
+            if (frames.size() == 2 && frames[0].key == "usage" && !frames[1].isArray) {
+                if (current.key == "prompt_tokens") {
+                    return Location::PromptTokens;
+                }
+                return current.key == "completion_tokens" ? Location::CompletionTokens : Location::Other;
+            }
+
+            if (frames[0].key != "choices" || !frames[1].isArray || frames[1].count != 1) {
+                return Location::Other;
+            }
+
+            if (frames.size() == 2) {
+                hasFirstChoice = true;
+                return Location::FirstChoice;
+            }
+
+            if (frames[2].isArray || frames[2].key != container) {
+                return Location::Other;
+            }
+
+            if (frames.size() == 3) {
+                return Location::Container;
+            }
+
+            if (frames.size() == 4 && !frames[3].isArray && frames[3].key == "content") {
+                return Location::Content;
+            }
+
+            return Location::Other;
+        }
+
+        const char* container;
+        std::vector<Frame> frames;
+    };
+
+    // Rough token cost of a request for the rate limiter: about four characters
+    // per prompt token plus the completion limit when one is set. The estimate
+    // is replaced with the server's usage figures once the reply arrives.
+    double estimateRequestTokens(const ofJson& body) {
+        std::size_t characters = 0;
+        const auto messages = body.find("messages");
+        if (messages != body.end() && messages->is_array()) {
+            for (const auto& message : *messages) {
+                const auto content = message.find("content");
+                if (content != message.end() && content->is_string()) {
+                    characters += content->get_ref<const std::string&>().size();
+                }
+            }
+        }
+
+        double completion = 0.0;
+        for (const char* limitKey : {"max_completion_tokens", "max_tokens"}) {
+            const auto limit = body.find(limitKey);
+            if (limit != body.end() && limit->is_number()) {
+                completion = limit->get<double>();
+                break;
+            }
+        }
+
+        return characters / 4.0 + completion;
+    }
+
+    struct StreamingRequestState {
+        CURL* curl = nullptr;
+        ServerSentEventParser* parser = nullptr;
+        long status = 0;
+        std::string errorBody;
+        const InferenceCancellationToken* cancel = nullptr;
+    };
+
+    bool isCancelled(const InferenceCancellationToken* cancel) {
+        return cancel && cancel->isCancelled();
+    }
+
+    std::size_t appendToString(char* data, std::size_t size, std::size_t count, void* userData) {
+        static_cast<std::string*>(userData)->append(data, size * count);
+        return size * count;
+    }
+
+    // Options shared by every request; the handle comes freshly reset from the pool.
+    void applyCommonOptions(CURL* curl, const std::string& url, curl_slist* headers) {
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT_SECONDS);
+        // Abort only when the transfer stalls completely, not when generation is long.
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, STALL_TIMEOUT_SECONDS);
+    }
+
+    curl_slist* toCurlHeaders(const std::vector<std::string>& headers) {
+        curl_slist* list = nullptr;
+        for (const auto& header : headers) {
+            list = curl_slist_append(list, header.c_str());
+        }
+        return list;
+    }
+
+    std::size_t writeStreamingChunk(char* data, std::size_t size, std::size_t count, void* userData) {
+        StreamingRequestState* state = static_cast<StreamingRequestState*>(userData);
+        const std::size_t length = size * count;
+
+        if (isCancelled(state->cancel)) {
+            return 0; // Makes curl abort the transfer.
+        }
+
+        if (state->status == 0) {
+            curl_easy_getinfo(state->curl, CURLINFO_RESPONSE_CODE, &state->status);
+        }
+
+        if (state->status < 200 || state->status >= 300) {
+            state->errorBody.append(data, length);
+        } else {
+            state->parser->feed(data, length);
+        }
+
+        return length;
+    }
+
+    // Also polled while no data arrives, e.g. before the first token.
+    int abortIfCancelled(void* userData, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+        return isCancelled(static_cast<StreamingRequestState*>(userData)->cancel) ? 1 : 0;
+    }
 }
 
 RemoteAPIProvider::RemoteAPIProvider()
 : endpointUrl(DEFAULT_OPENAI_ENDPOINT)
-, model(DEFAULT_MODEL) {
+, model(DEFAULT_MODEL)
+, connectionPool(std::make_shared<RemoteHttpConnectionPool>())
+, rateLimiter(std::make_shared<RemoteRateLimiter>()) {
 }
 
 RemoteAPIProvider::RemoteAPIProvider(const std::string& endpointUrl)
 : endpointUrl(normalizeEndpointUrl(endpointUrl))
-, model(DEFAULT_MODEL) {
+, model(DEFAULT_MODEL)
+, connectionPool(std::make_shared<RemoteHttpConnectionPool>())
+, rateLimiter(std::make_shared<RemoteRateLimiter>()) {
 }
 
 RemoteAPIProvider::RemoteAPIProvider(const std::string& endpointUrl, const std::string& apiKey)
 : endpointUrl(normalizeEndpointUrl(endpointUrl))
 , apiKey(apiKey)
-, model(DEFAULT_MODEL) {
+, model(DEFAULT_MODEL)
+, connectionPool(std::make_shared<RemoteHttpConnectionPool>())
+, rateLimiter(std::make_shared<RemoteRateLimiter>()) {
 }
 
 bool RemoteAPIProvider::setup(const std::string& modelOrUrl) {
@@ -96,35 +566,31 @@ std::string RemoteAPIProvider::generate(const std::string& prompt) {
         return "";
     }
 
-    const ofJson body = buildRequestBody(prompt);
-    const ofHttpResponse response = performPost(body);
+    return postForContent(buildRequestBody(prompt));
+}
 
-    if (response.status < 200 || response.status >= 300) {
-        ofLogError("RemoteAPIProvider")
-            << "HTTP error " << response.status << ": " << response.error
-            << " Body: " << response.data.getText();
+std::string RemoteAPIProvider::generateChat(const std::vector<RemoteChatMessage>& messages) {
+    if (endpointUrl.empty()) {
+        ofLogError("RemoteAPIProvider") << "Provider is not configured. Call setup() first.";
         return "";
     }
 
-    const std::string responseText = response.data.getText();
-    if (responseText.empty()) {
-        ofLogError("RemoteAPIProvider") << "Received empty response body.";
+    if (model.empty()) {
+        ofLogError("RemoteAPIProvider") << "Model name is empty.";
         return "";
     }
 
-    try {
-        const ofJson json = ofJson::parse(responseText);
-        return parseResponseContent(json);
-    } catch (const std::exception& exception) {
-        ofLogError("RemoteAPIProvider") << "Failed to parse JSON response: " << exception.what();
-    } catch (...) {
-        ofLogError("RemoteAPIProvider") << "Failed to parse JSON response.";
+    if (messages.empty()) {
+        ofLogError("RemoteAPIProvider") << "No chat messages provided.";
+        return "";
     }
 
-    return "";
+    return postForContent(buildChatRequestBody(messages));
 }
 
-std::string RemoteAPIProvider::generateChat(const std::vector<RemoteChatMessage>& messages) {
+std::string RemoteAPIProvider::generateStream(const std::string& prompt,
+                                              RemoteTokenCallback onToken,
+                                              std::shared_ptr<InferenceCancellationToken> cancel) {
     if (endpointUrl.empty()) {
         ofLogError("RemoteAPIProvider") << "Provider is not configured. Call setup() first.";
         return "";
@@ -135,37 +601,50 @@ std::string RemoteAPIProvider::generateChat(const std::vector<RemoteChatMessage>
         return "";
     }
 
-    if (messages.empty()) {
-        ofLogError("RemoteAPIProvider") << "No chat messages provided.";
+    return performStreamingPost(buildRequestBody(prompt), onToken, cancel.get());
+}
+
+std::string RemoteAPIProvider::generateChatStream(const std::vector<RemoteChatMessage>& messages,
+                                                  RemoteTokenCallback onToken,
+                                                  std::shared_ptr<InferenceCancellationToken> cancel) {
+    if (endpointUrl.empty()) {
+        ofLogError("RemoteAPIProvider") << "Provider is not configured. Call setup() first.";
         return "";
     }
 
-    const ofJson body = buildChatRequestBody(messages);
-    const ofHttpResponse response = performPost(body);
-
-    if (response.status < 200 || response.status >= 300) {
-        ofLogError("RemoteAPIProvider")
-            << "HTTP error " << response.status << ": " << response.error
-            << " Body: " << response.data.getText();
+    if (model.empty()) {
+        ofLogError("RemoteAPIProvider") << "Model name is empty.";
         return "";
     }
 
-    const std::string responseText = response.data.getText();
-    if (responseText.empty()) {
-        ofLogError("RemoteAPIProvider") << "Received empty response body.";
+    if (messages.empty()) {
+        ofLogError("RemoteAPIProvider") << "No chat messages provided.";
         return "";
     }
 
-    try {
-        const ofJson json = ofJson::parse(responseText);
-        return parseResponseContent(json);
-    } catch (const std::exception& exception) {
-        ofLogError("RemoteAPIProvider") << "Failed to parse JSON response: " << exception.what();
-    } catch (...) {
-        ofLogError("RemoteAPIProvider") << "Failed to parse JSON response.";
+    return performStreamingPost(buildChatRequestBody(messages), onToken, cancel.get());
+}
+
+std::future<std::string> RemoteAPIProvider::generateAsync(const std::string& prompt) {
+    if (endpointUrl.empty() || model.empty()) {
+        ofLogError("RemoteAPIProvider") << "Provider is not configured. Call setup() and setModel() first.";
+        std::promise<std::string> failed;
+        failed.set_value("");
+        return failed.get_future();
+    }
+
+    return submitAsync(buildRequestBody(prompt));
+}
+
+std::future<std::string> RemoteAPIProvider::generateChatAsync(const std::vector<RemoteChatMessage>& messages) {
+    if (endpointUrl.empty() || model.empty() || messages.empty()) {
+        ofLogError("RemoteAPIProvider") << "Provider is not configured or no chat messages provided.";
+        std::promise<std::string> failed;
+        failed.set_value("");
+        return failed.get_future();
     }
 
-    return "";
+    return submitAsync(buildChatRequestBody(messages));
 }
 
 bool RemoteAPIProvider::isRemote() const {
@@ -221,42 +700,127 @@ void RemoteAPIProvider::setStripReasoning(bool enabled) {
     stripReasoning = enabled;
 }
 
+void RemoteAPIProvider::setConnectionPoolSize(std::size_t maxIdleConnectionsPerHost) {
+    connectionPool->setMaxIdleHandlesPerHost(maxIdleConnectionsPerHost);
+}
+
+void RemoteAPIProvider::setConnectionIdleTimeout(float seconds) {
+    connectionPool->setIdleTimeout(std::chrono::seconds(static_cast<long long>(std::max(0.0f, seconds))));
+}
+
+void RemoteAPIProvider::setConnectionPool(std::shared_ptr<RemoteHttpConnectionPool> pool) {
+    if (pool) {
+        connectionPool = pool;
+    }
+}
+
+void RemoteAPIProvider::setMaxConcurrentRequests(std::size_t count) {
+    std::lock_guard<std::mutex> lock(asyncClientMutex);
+    maxConcurrentRequests = std::max<std::size_t>(1, count);
+    if (asyncClient) {
+        asyncClient->setMaxConcurrentPerHost(maxConcurrentRequests);
+    }
+}
+
+void RemoteAPIProvider::setRetryPolicy(const RemoteRetryPolicy& policy) {
+    retryPolicy = policy;
+    retryPolicy.maxAttempts = std::max(1, policy.maxAttempts);
+}
+
+void RemoteAPIProvider::setHedgingPolicy(const RemoteHedgingPolicy& policy) {
+    hedgingPolicy = policy;
+    hedgingPolicy.percentile = std::min(1.0, std::max(0.0, policy.percentile));
+}
+
+void RemoteAPIProvider::setRateLimits(const RemoteRateLimits& limits) {
+    rateLimiter->setLimits(limits);
+}
+
+void RemoteAPIProvider::setRateLimiter(std::shared_ptr<RemoteRateLimiter> limiter) {
+    if (limiter) {
+        rateLimiter = limiter;
+    }
+}
+
+std::shared_ptr<RemoteRateLimiter> RemoteAPIProvider::getRateLimiter() const {
+    return rateLimiter;
+}
+
+std::map<std::string, RemoteUsageStats> RemoteAPIProvider::getUsageByModel() const {
+    std::lock_guard<std::mutex> lock(usageMutex);
+    return usageByModel;
+}
+
+RemoteUsageStats RemoteAPIProvider::getTotalUsage() const {
+    std::lock_guard<std::mutex> lock(usageMutex);
+    RemoteUsageStats total;
+    for (const auto& entry : usageByModel) {
+        total.requests += entry.second.requests;
+        total.reportedRequests += entry.second.reportedRequests;
+        total.promptTokens += entry.second.promptTokens;
+        total.completionTokens += entry.second.completionTokens;
+    }
+    return total;
+}
+
+long long RemoteAPIProvider::getCompletionTokenCount() const {
+    const RemoteUsageStats total = getTotalUsage();
+    if (total.requests > 0 && total.reportedRequests == 0) {
+        return -1;
+    }
+    return static_cast<long long>(total.completionTokens);
+}
+
+void RemoteAPIProvider::resetUsage() {
+    std::lock_guard<std::mutex> lock(usageMutex);
+    usageByModel.clear();
+}
+
 std::vector<std::string> RemoteAPIProvider::listModels() const {
     std::vector<std::string> models;
+    listModels(models);
+    return models;
+}
+
+bool RemoteAPIProvider::listModels(std::vector<std::string>& models, std::shared_ptr<InferenceCancellationToken> cancel) const {
+    models.clear();
 
     if (endpointUrl.empty()) {
         ofLogError("RemoteAPIProvider") << "Provider is not configured. Call setup() first.";
-        return models;
+        return false;
     }
 
     if (isAzureOpenAI() && modelsUrl.empty()) {
         if (!model.empty()) {
             models.push_back(model);
         }
-        return models;
+        return true;
     }
 
     const std::string requestUrl = modelsUrl.empty() ? modelsUrlFromEndpointUrl(endpointUrl) : modelsUrl;
-    const ofHttpResponse response = performGet(requestUrl);
+    const RemoteHttpResult response = performGet(requestUrl, cancel.get());
+    if (isCancelled(cancel.get())) {
+        return false;
+    }
 
     if (response.status < 200 || response.status >= 300) {
         ofLogError("RemoteAPIProvider")
             << "HTTP error while loading models " << response.status << ": " << response.error
-            << " Body: " << response.data.getText();
-        return models;
+            << " Body: " << response.body;
+        return false;
     }
 
-    const std::string responseText = response.data.getText();
+    const std::string& responseText = response.body;
     if (responseText.empty()) {
         ofLogError("RemoteAPIProvider") << "Received empty models response body.";
-        return models;
+        return false;
     }
 
     try {
         const ofJson json = ofJson::parse(responseText);
         if (!json.contains("data") || !json["data"].is_array()) {
             ofLogError("RemoteAPIProvider") << "Models response does not contain a data array.";
-            return models;
+            return false;
         }
 
         for (const auto& item : json["data"]) {
@@ -266,11 +830,13 @@ std::vector<std::string> RemoteAPIProvider::listModels() const {
         }
     } catch (const std::exception& exception) {
         ofLogError("RemoteAPIProvider") << "Failed to parse models response: " << exception.what();
+        return false;
     } catch (...) {
         ofLogError("RemoteAPIProvider") << "Failed to parse models response.";
+        return false;
     }
 
-    return models;
+    return true;
 }
 
 ofJson RemoteAPIProvider::buildRequestBody(const std::string& prompt) const {
@@ -353,46 +919,87 @@ ofJson RemoteAPIProvider::buildChatRequestBody(const std::vector<RemoteChatMessa
     return body;
 }
 
-std::string RemoteAPIProvider::parseResponseContent(const ofJson& response) const {
-    try {
-        if (!response.contains("choices") || !response["choices"].is_array() || response["choices"].empty()) {
-            ofLogError("RemoteAPIProvider") << "Response does not contain choices.";
-            return "";
-        }
+RemoteAPIProvider::RequestAccounting RemoteAPIProvider::accountingForBody(const ofJson& body) const {
+    RequestAccounting accounting;
+    accounting.model = model;
+    accounting.estimatedTokens = estimateRequestTokens(body);
+    return accounting;
+}
 
-        const ofJson& choice = response["choices"][0];
-        if (!choice.contains("message") || !choice["message"].is_object()) {
-            ofLogError("RemoteAPIProvider") << "Response choice does not contain a message.";
-            return "";
+bool RemoteAPIProvider::waitForRateLimit(const RequestAccounting& accounting, const InferenceCancellationToken* cancel) const {
+    const std::chrono::milliseconds wait = rateLimiter->reserve(accounting.estimatedTokens);
+    if (wait.count() <= 0) {
+        return true;
+    }
+
+    ofLogVerbose("RemoteAPIProvider") << "Rate limit reached, waiting " << wait.count() << " ms.";
+    const auto until = std::chrono::steady_clock::now() + wait;
+    while (std::chrono::steady_clock::now() < until) {
+        if (isCancelled(cancel)) {
+            rateLimiter->settle(accounting.estimatedTokens, 0.0);
+            return false;
         }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            until - std::chrono::steady_clock::now(), std::chrono::milliseconds(20)));
+    }
+    return true;
+}
+
+void RemoteAPIProvider::recordUsage(const RequestAccounting& accounting, long long promptTokens, long long completionTokens) const {
+    const bool reported = promptTokens >= 0 && completionTokens >= 0;
+    if (reported) {
+        rateLimiter->settle(accounting.estimatedTokens, static_cast<double>(promptTokens + completionTokens));
+    }
+
+    std::lock_guard<std::mutex> lock(usageMutex);
+    RemoteUsageStats& stats = usageByModel[accounting.model];
+    ++stats.requests;
+    if (reported) {
+        ++stats.reportedRequests;
+        stats.promptTokens += static_cast<std::uint64_t>(promptTokens);
+        stats.completionTokens += static_cast<std::uint64_t>(completionTokens);
+    }
+}
+
+std::string RemoteAPIProvider::parseResponseText(long status, const std::string& responseText, const std::string& error,
+                                                 const RequestAccounting& accounting) const {
+    if (status < 200 || status >= 300) {
+        ofLogError("RemoteAPIProvider")
+            << "HTTP error " << status << ": " << error
+            << " Body: " << responseText;
+        return "";
+    }
 
-        const ofJson& message = choice["message"];
-        if (!message.contains("content") || !message["content"].is_string()) {
+    if (responseText.empty()) {
+        ofLogError("RemoteAPIProvider") << "Received empty response body.";
+        return "";
+    }
+
+    // Read straight from the receive buffer; no DOM and no copy of the body.
+    ChatContentReader reader("message");
+    ofJson::sax_parse(responseText.data(), responseText.data() + responseText.size(), &reader);
+
+    if (!reader.hasContent) {
+        if (!reader.error.empty()) {
+            ofLogError("RemoteAPIProvider") << "Failed to parse JSON response: " << reader.error;
+        } else if (!reader.hasChoices || !reader.hasFirstChoice) {
+            ofLogError("RemoteAPIProvider") << "Response does not contain choices.";
+        } else if (!reader.hasContainer) {
+            ofLogError("RemoteAPIProvider") << "Response choice does not contain a message.";
+        } else {
             ofLogError("RemoteAPIProvider") << "Response message does not contain string content.";
-            return "";
         }
-
-        const std::string content = message["content"].get<std::string>();
-        return stripReasoning ? stripReasoningBlocks(content) : content;
-    } catch (const std::exception& exception) {
-        ofLogError("RemoteAPIProvider") << "Failed to read response content: " << exception.what();
-    } catch (...) {
-        ofLogError("RemoteAPIProvider") << "Failed to read response content.";
+        return "";
     }
 
-    return "";
+    recordUsage(accounting, reader.promptTokens, reader.completionTokens);
+    return stripReasoning ? stripReasoningBlocks(reader.content) : reader.content;
 }
 
 std::string RemoteAPIProvider::stripReasoningBlocks(const std::string& text) const {
     std::string result = text;
 
-    const std::vector<std::pair<std::string, std::string>> tags = {
-        {"<think>", "</think>"},
-        {"<thinking>", "</thinking>"},
-        {"<reasoning>", "</reasoning>"}
-    };
-
-    for (const auto& tag : tags) {
+    for (const auto& tag : REASONING_TAGS) {
         std::size_t start = result.find(tag.first);
         while (start != std::string::npos) {
             const std::size_t end = result.find(tag.second, start + tag.first.size());
@@ -406,48 +1013,532 @@ std::string RemoteAPIProvider::stripReasoningBlocks(const std::string& text) con
         }
     }
 
-    while (!result.empty() && (result[0] == '\n' || result[0] == '\r' || result[0] == ' ' || result[0] == '\t')) {
+    while (!result.empty() && isWhitespace(result[0])) {
         result.erase(0, 1);
     }
 
     return result;
 }
 
-ofHttpResponse RemoteAPIProvider::performPost(const ofJson& body) const {
-    ofHttpRequest request;
-    request.url = getChatCompletionsUrl();
-    request.method = ofHttpRequest::POST;
-    request.body = body.dump();
-    request.contentType = "application/json";
+RemoteHttpResult RemoteAPIProvider::performPost(const std::string& payload) const {
+    return performRequest(getChatCompletionsUrl(), &payload);
+}
 
-    if (!apiKey.empty()) {
-        if (isAzureOpenAI()) {
-            request.headers["api-key"] = apiKey;
+std::string RemoteAPIProvider::postForContent(const ofJson& body) {
+    // A hedge needs two requests in flight at once, which the async client provides.
+    if (hedgingPolicy.enabled) {
+        return submitAsync(body).get();
+    }
+
+    const std::string cacheKey = cacheKeyForBody(body);
+    std::string content;
+    if (!cacheKey.empty() && responseCache->lookup(cacheKey, content)) {
+        return content;
+    }
+
+    const RequestAccounting accounting = accountingForBody(body);
+    const std::string payload = body.dump();
+    RemoteHttpResult response;
+    for (int attempt = 0;; ++attempt) {
+        waitForRateLimit(accounting, nullptr);
+
+        const auto startedAt = std::chrono::steady_clock::now();
+        response = performPost(payload);
+        if (response.status >= 200 && response.status < 300) {
+            recordLatency(std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count());
+            break;
+        }
+
+        // A failed request consumed no tokens.
+        rateLimiter->settle(accounting.estimatedTokens, 0.0);
+
+        if (!shouldRetry(response, attempt)) {
+            break;
+        }
+
+        const std::chrono::milliseconds delay = retryDelay(attempt, response.retryAfterSeconds);
+        if (response.status == 429) {
+            rateLimiter->pause(delay);
+        }
+        ofLogWarning("RemoteAPIProvider")
+            << "Request failed with status " << response.status << ", retrying in " << delay.count() << " ms.";
+        std::this_thread::sleep_for(delay);
+    }
+
+    content = parseResponseText(response.status, response.body, response.error, accounting);
+
+    if (!cacheKey.empty() && !content.empty()) {
+        responseCache->store(cacheKey, content);
+    }
+    return content;
+}
+
+// State shared by every attempt of one asynchronous request. Slot 0 is the
+// primary request of the current attempt and slot 1 its hedge.
+struct RemoteAPIProvider::AsyncRequest {
+    std::string url;
+    std::vector<std::string> headers;
+    std::string payload;
+    std::string cacheKey;
+    std::shared_ptr<InferenceResponseCache> cache;
+    RequestAccounting accounting;
+    std::promise<std::string> promise;
+
+    std::mutex mutex;
+    int attempt = 0;
+    int pending = 0;
+    bool settled = false;
+    RemoteHttpClient::RequestId ids[2] = {0, 0};
+    std::chrono::steady_clock::time_point startedAt[2];
+};
+
+std::future<std::string> RemoteAPIProvider::submitAsync(const ofJson& body) {
+    const std::string cacheKey = cacheKeyForBody(body);
+    std::shared_ptr<InferenceResponseCache> cache = cacheKey.empty() ? nullptr : responseCache;
+
+    std::string cached;
+    if (cache && cache->lookup(cacheKey, cached)) {
+        std::promise<std::string> ready;
+        ready.set_value(cached);
+        return ready.get_future();
+    }
+
+    std::shared_ptr<AsyncRequest> request = std::make_shared<AsyncRequest>();
+    request->url = getChatCompletionsUrl();
+    request->headers = buildRequestHeaders(false);
+    request->payload = body.dump();
+    request->cacheKey = cacheKey;
+    request->cache = cache;
+    request->accounting = accountingForBody(body);
+
+    std::future<std::string> future = request->promise.get_future();
+    startAsyncAttempt(request, std::chrono::milliseconds(0));
+    return future;
+}
+
+void RemoteAPIProvider::startAsyncAttempt(const std::shared_ptr<AsyncRequest>& request, std::chrono::milliseconds delay) {
+    RemoteHttpClient& client = getAsyncClient();
+    const bool hedged = hedgingPolicy.enabled;
+    // Both the request and its hedge count against the quota.
+    delay += rateLimiter->reserve(request->accounting.estimatedTokens);
+    std::chrono::milliseconds hedgeAfter = delay;
+    if (hedged) {
+        hedgeAfter = std::max(delay + hedgeDelay(), rateLimiter->reserve(request->accounting.estimatedTokens));
+    }
+    const auto now = std::chrono::steady_clock::now();
+
+    int attempt = 0;
+    {
+        std::lock_guard<std::mutex> lock(request->mutex);
+        attempt = request->attempt;
+        request->pending = hedged ? 2 : 1;
+        request->ids[0] = 0;
+        request->ids[1] = 0;
+        request->startedAt[0] = now + delay;
+        request->startedAt[1] = now + hedgeAfter;
+    }
+
+    for (int slot = 0; slot < (hedged ? 2 : 1); ++slot) {
+        // Submitting may complete synchronously, so the request lock is not held here.
+        const RemoteHttpClient::RequestId id = client.submitAfter(slot == 0 ? delay : hedgeAfter,
+            request->url, request->headers, request->payload,
+            [this, request, attempt, slot](RemoteHttpResult& result) {
+                finishAsyncAttempt(request, attempt, slot, result);
+            });
+
+        std::lock_guard<std::mutex> lock(request->mutex);
+        if (request->settled || request->attempt != attempt) {
+            // Already decided while we were submitting; the hedge is not needed.
+            if (slot == 1) {
+                client.cancel(id);
+            }
+            break;
+        }
+        request->ids[slot] = id;
+    }
+}
+
+void RemoteAPIProvider::finishAsyncAttempt(const std::shared_ptr<AsyncRequest>& request, int attempt, int slot, RemoteHttpResult& result) {
+    const bool succeeded = result.status >= 200 && result.status < 300;
+    if (!succeeded) {
+        // Failed or cancelled attempts consumed no tokens.
+        rateLimiter->settle(request->accounting.estimatedTokens, 0.0);
+    }
+
+    RemoteHttpClient::RequestId sibling = 0;
+    bool retry = false;
+    double latency = 0.0;
+
+    {
+        std::lock_guard<std::mutex> lock(request->mutex);
+        if (request->settled || request->attempt != attempt) {
+            return; // A cancelled loser or a leftover from an earlier attempt.
+        }
+
+        --request->pending;
+        sibling = request->ids[1 - slot];
+
+        if (succeeded) {
+            request->settled = true;
+            latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - request->startedAt[slot]).count();
         } else {
-            request.headers["Authorization"] = buildAuthorizationHeader(apiKey);
+            // Let a running hedge finish, unless the server asked everyone to back off.
+            if (request->pending > 0 && result.status != 429) {
+                return;
+            }
+
+            retry = shouldRetry(result, attempt);
+            if (retry) {
+                ++request->attempt;
+            } else {
+                request->settled = true;
+            }
         }
     }
 
-    ofURLFileLoader loader;
-    return loader.handleRequest(request);
+    if (sibling != 0 && !result.aborted) {
+        getAsyncClient().cancel(sibling);
+    }
+
+    if (retry) {
+        const std::chrono::milliseconds delay = retryDelay(attempt, result.retryAfterSeconds);
+        if (result.status == 429) {
+            rateLimiter->pause(delay);
+        }
+        ofLogWarning("RemoteAPIProvider")
+            << "Request failed with status " << result.status << ", retrying in " << delay.count() << " ms.";
+        startAsyncAttempt(request, delay);
+        return;
+    }
+
+    if (succeeded) {
+        recordLatency(latency);
+    }
+
+    const std::string content = parseResponseText(result.status, result.body, result.error, request->accounting);
+    if (request->cache && !content.empty()) {
+        request->cache->store(request->cacheKey, content);
+    }
+    request->promise.set_value(content);
+}
+
+RemoteHttpClient& RemoteAPIProvider::getAsyncClient() {
+    std::lock_guard<std::mutex> lock(asyncClientMutex);
+    if (!asyncClient) {
+        asyncClient.reset(new RemoteHttpClient(maxConcurrentRequests));
+    }
+    return *asyncClient;
+}
+
+bool RemoteAPIProvider::shouldRetry(const RemoteHttpResult& result, int attempt) const {
+    if (result.aborted || attempt + 1 >= retryPolicy.maxAttempts) {
+        return false;
+    }
+
+    switch (result.status) {
+    case -1:  // Transport failure: connect, TLS, reset connection.
+    case 408:
+    case 429:
+    case 500:
+    case 502:
+    case 503:
+    case 504:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::chrono::milliseconds RemoteAPIProvider::retryDelay(int attempt, double retryAfterSeconds) const {
+    thread_local std::mt19937 random(std::random_device{}());
+
+    // Full jitter: a uniform pick below the exponential ceiling keeps clients
+    // that failed together from retrying in lockstep.
+    const double ceiling = std::min(retryPolicy.maxBackoffSeconds,
+        retryPolicy.initialBackoffSeconds * std::pow(retryPolicy.backoffMultiplier, attempt));
+    double seconds = std::uniform_real_distribution<double>(0.0, std::max(0.0, ceiling))(random);
+
+    if (retryPolicy.respectRetryAfter && retryAfterSeconds >= 0.0) {
+        seconds = std::max(seconds, std::min(retryAfterSeconds, retryPolicy.maxRetryAfterSeconds));
+    }
+
+    return std::chrono::milliseconds(static_cast<long long>(seconds * 1000.0));
+}
+
+std::chrono::milliseconds RemoteAPIProvider::hedgeDelay() const {
+    double seconds = hedgingPolicy.fallbackDelaySeconds;
+    {
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        if (!recentLatencies.empty() && recentLatencies.size() >= hedgingPolicy.minSamples) {
+            std::vector<double> sorted(recentLatencies.begin(), recentLatencies.end());
+            std::size_t index = static_cast<std::size_t>(std::ceil(hedgingPolicy.percentile * sorted.size()));
+            index = std::min(sorted.size() - 1, index > 0 ? index - 1 : 0);
+            std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+            seconds = sorted[index];
+        }
+    }
+
+    seconds = std::max(seconds, hedgingPolicy.minDelaySeconds);
+    return std::chrono::milliseconds(static_cast<long long>(seconds * 1000.0));
+}
+
+void RemoteAPIProvider::recordLatency(double seconds) {
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    recentLatencies.push_back(seconds);
+    if (recentLatencies.size() > MAX_LATENCY_SAMPLES) {
+        recentLatencies.pop_front();
+    }
+}
+
+std::string RemoteAPIProvider::cacheKeyForBody(const ofJson& body) const {
+    if (!responseCache) {
+        return "";
+    }
+
+    if (responseCache->isDeterministicOnly()) {
+        const auto temperature = body.find("temperature");
+        if (temperature == body.end() || !temperature->is_number() || temperature->get<double>() != 0.0) {
+            return "";
+        }
+    }
+
+    // ofJson keeps object keys sorted, so dump() is already a canonical form.
+    ofJson canonical = body;
+    canonical.erase("stream");
+    return InferenceResponseCache::fingerprint(
+        getChatCompletionsUrl() + "\n" + (stripReasoning ? "strip\n" : "raw\n") + canonical.dump());
+}
+
+RemoteHttpResult RemoteAPIProvider::performGet(const std::string& url, const InferenceCancellationToken* cancel) const {
+    return performRequest(url, nullptr, LIST_TIMEOUT_SECONDS, cancel);
+}
+
+RemoteHttpResult RemoteAPIProvider::performRequest(const std::string& url, const std::string* payload, long timeoutSeconds,
+                                                   const InferenceCancellationToken* cancel) const {
+    RemoteHttpResult response;
+
+    RemoteHttpConnectionPool::Lease lease = connectionPool->acquire(url);
+    if (!lease) {
+        response.status = -1;
+        response.error = "Failed to create HTTP handle.";
+        return response;
+    }
+
+    CURL* curl = lease.get();
+    curl_slist* headers = toCurlHeaders(buildRequestHeaders(false));
+
+    applyCommonOptions(curl, url, headers);
+    if (payload) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload->c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(payload->size()));
+    } else {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendToString);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, RemoteHttpClient::captureRetryAfter);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response);
+    if (timeoutSeconds > 0) {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeoutSeconds);
+    }
+
+    StreamingRequestState progress;
+    progress.cancel = cancel;
+    if (cancel) {
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abortIfCancelled);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &progress);
+    }
+
+    const CURLcode result = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    curl_slist_free_all(headers);
+
+    if (result != CURLE_OK) {
+        lease.discard();
+        response.status = -1;
+        response.error = isCancelled(cancel) ? "Cancelled." : curl_easy_strerror(result);
+    }
+
+    return response;
+}
+
+std::string RemoteAPIProvider::performStreamingPost(ofJson body, const RemoteTokenCallback& onToken, const InferenceCancellationToken* cancel) const {
+    if (isCancelled(cancel)) {
+        return "";
+    }
+
+    const std::string cacheKey = cacheKeyForBody(body);
+    std::string cached;
+    if (!cacheKey.empty() && responseCache->lookup(cacheKey, cached)) {
+        if (!cached.empty() && onToken) {
+            onToken(cached);
+        }
+        return cached;
+    }
+
+    const RequestAccounting accounting = accountingForBody(body);
+    body["stream"] = true;
+    // Without this, streamed replies carry no usage block.
+    if (!body.contains("stream_options")) {
+        body["stream_options"]["include_usage"] = true;
+    }
+    const std::string payload = body.dump();
+
+    std::string rawContent;
+    ReasoningStreamFilter reasoningFilter;
+    long long promptTokens = -1;
+    long long completionTokens = -1;
+
+    ServerSentEventParser parser([&](const std::string& data) {
+        ChatContentReader reader("delta");
+        ofJson::sax_parse(data.data(), data.data() + data.size(), &reader);
+
+        if (reader.hasUsage()) {
+            promptTokens = reader.promptTokens;
+            completionTokens = reader.completionTokens;
+        }
+
+        if (!reader.hasContent) {
+            // Usage, role-only and keep-alive chunks carry no content.
+            if (!reader.error.empty()) {
+                ofLogWarning("RemoteAPIProvider") << "Skipping malformed stream chunk: " << reader.error;
+            } else if (reader.hasErrorField) {
+                ofLogError("RemoteAPIProvider") << "Stream error: " << data;
+            }
+            return;
+        }
+
+        rawContent += reader.content;
+
+        const std::string visible = stripReasoning ? reasoningFilter.push(reader.content) : reader.content;
+        if (!visible.empty() && onToken && !isCancelled(cancel)) {
+            onToken(visible);
+        }
+    });
+
+    const std::string url = getChatCompletionsUrl();
+    for (int attempt = 0;; ++attempt) {
+        if (!waitForRateLimit(accounting, cancel)) {
+            ofLogNotice("RemoteAPIProvider") << "Streaming request cancelled.";
+            return "";
+        }
+
+        RemoteHttpConnectionPool::Lease lease = connectionPool->acquire(url);
+        if (!lease) {
+            ofLogError("RemoteAPIProvider") << "Failed to create HTTP handle for streaming request.";
+            return "";
+        }
+
+        CURL* curl = lease.get();
+        curl_slist* headers = toCurlHeaders(buildRequestHeaders(true));
+
+        RemoteHttpResult response;
+        StreamingRequestState state;
+        state.curl = curl;
+        state.parser = &parser;
+        state.cancel = cancel;
+
+        applyCommonOptions(curl, url, headers);
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(payload.size()));
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeStreamingChunk);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &state);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, RemoteHttpClient::captureRetryAfter);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response);
+        if (cancel) {
+            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abortIfCancelled);
+            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &state);
+        }
+
+        const CURLcode result = curl_easy_perform(curl);
+        if (state.status == 0) {
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &state.status);
+        }
+        curl_slist_free_all(headers);
+
+        if (result == CURLE_OK && state.status >= 200 && state.status < 300) {
+            break;
+        }
+
+        if (rawContent.empty()) {
+            rateLimiter->settle(accounting.estimatedTokens, 0.0);
+        }
+
+        if (isCancelled(cancel)) {
+            // The connection was cut mid-response and cannot be reused.
+            lease.discard();
+            ofLogNotice("RemoteAPIProvider") << "Streaming request cancelled.";
+            return stripReasoning ? stripReasoningBlocks(rawContent) : rawContent;
+        }
+
+        response.status = result == CURLE_OK ? state.status : -1;
+        response.body = state.errorBody;
+        if (result != CURLE_OK) {
+            lease.discard();
+            response.error = curl_easy_strerror(result);
+        }
+
+        // Tokens already handed to the caller cannot be taken back, so only
+        // failures before the first content delta are retried.
+        if (rawContent.empty() && shouldRetry(response, attempt)) {
+            const std::chrono::milliseconds delay = retryDelay(attempt, response.retryAfterSeconds);
+            if (response.status == 429) {
+                rateLimiter->pause(delay);
+            }
+            ofLogWarning("RemoteAPIProvider")
+                << "Streaming request failed with status " << response.status << ", retrying in " << delay.count() << " ms.";
+            parser.reset();
+            std::this_thread::sleep_for(delay);
+            continue;
+        }
+
+        if (result != CURLE_OK) {
+            ofLogError("RemoteAPIProvider") << "Streaming request failed: " << response.error;
+        } else {
+            ofLogError("RemoteAPIProvider")
+                << "HTTP error " << state.status << " Body: " << state.errorBody;
+        }
+        if (!rawContent.empty()) {
+            // Match what onToken has already shown rather than contradicting it.
+            ofLogWarning("RemoteAPIProvider") << "Returning the partial reply received before the failure.";
+        }
+        return stripReasoning ? stripReasoningBlocks(rawContent) : rawContent;
+    }
+
+    parser.finish();
+    recordUsage(accounting, promptTokens, completionTokens);
+    if (stripReasoning) {
+        const std::string tail = reasoningFilter.finish();
+        if (!tail.empty() && onToken) {
+            onToken(tail);
+        }
+    }
+
+    const std::string content = stripReasoning ? stripReasoningBlocks(rawContent) : rawContent;
+    if (!cacheKey.empty() && !content.empty()) {
+        responseCache->store(cacheKey, content);
+    }
+    return content;
 }
 
-ofHttpResponse RemoteAPIProvider::performGet(const std::string& url) const {
-    ofHttpRequest request;
-    request.url = url;
-    request.method = ofHttpRequest::GET;
-    request.headers["Accept"] = "application/json";
+std::vector<std::string> RemoteAPIProvider::buildRequestHeaders(bool acceptEventStream) const {
+    std::vector<std::string> headers;
+    headers.push_back("Content-Type: application/json");
+    headers.push_back(acceptEventStream ? "Accept: text/event-stream" : "Accept: application/json");
 
     if (!apiKey.empty()) {
         if (isAzureOpenAI()) {
-            request.headers["api-key"] = apiKey;
+            headers.push_back("api-key: " + apiKey);
         } else {
-            request.headers["Authorization"] = buildAuthorizationHeader(apiKey);
+            headers.push_back("Authorization: " + buildAuthorizationHeader(apiKey));
         }
     }
 
-    ofURLFileLoader loader;
-    return loader.handleRequest(request);
+    return headers;
 }
 
 std::string RemoteAPIProvider::getChatCompletionsUrl() const {
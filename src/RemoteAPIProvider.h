@@ -1,17 +1,61 @@
 #pragma once
 
 #include "IInferenceProvider.h"
+#include "RemoteHttpClient.h"
+#include "RemoteHttpConnectionPool.h"
+#include "RemoteRateLimiter.h"
 
 #include "ofMain.h"
 #include "ofJson.h"
 
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
-// Represents a single chat message in the OpenAI-compatible "messages" array.
-struct RemoteChatMessage {
-    std::string role;
-    std::string content;
+// Kept for existing code; the message and callback types now live in IInferenceProvider.h.
+using RemoteChatMessage = InferenceChatMessage;
+using RemoteTokenCallback = InferenceTokenCallback;
+
+// Controls how failed requests are retried. Rate limits (429), server errors
+// (500/502/503/504) and transport failures are retried with exponential backoff
+// and full jitter; a Retry-After header from the server takes precedence.
+struct RemoteRetryPolicy {
+    int maxAttempts = 3;
+    double initialBackoffSeconds = 0.5;
+    double maxBackoffSeconds = 8.0;
+    double backoffMultiplier = 2.0;
+    bool respectRetryAfter = true;
+    // Upper bound for server-requested delays, so a bad header cannot stall a request.
+    double maxRetryAfterSeconds = 30.0;
+};
+
+// Hedged requests: when a non-streaming request has not answered within the
+// observed latency percentile, a duplicate is sent and the first reply wins.
+// The slower request is cancelled. This trims tail latency at the cost of a
+// small amount of extra load.
+struct RemoteHedgingPolicy {
+    bool enabled = false;
+    double percentile = 0.95;
+    double minDelaySeconds = 0.05;
+    // Used until minSamples successful requests have been observed.
+    double fallbackDelaySeconds = 2.0;
+    std::size_t minSamples = 10;
+};
+
+// Cumulative usage for one model (or Azure deployment), taken from the usage
+// block of each reply.
+struct RemoteUsageStats {
+    std::uint64_t requests = 0;         // Successful replies.
+    std::uint64_t reportedRequests = 0; // Replies that included a usage block.
+    std::uint64_t promptTokens = 0;
+    std::uint64_t completionTokens = 0;
 };
 
 // Supported HTTP API families.
@@ -32,7 +76,22 @@ public:
     // Sends a plain prompt through the chat-completions API and returns the text reply.
     std::string generate(const std::string& prompt) override;
     // Sends a prebuilt chat history instead of a single user prompt.
-    std::string generateChat(const std::vector<RemoteChatMessage>& messages);
+    std::string generateChat(const std::vector<RemoteChatMessage>& messages) override;
+    // Streaming variants: request "stream": true and forward each content delta
+    // to onToken as the server-sent events arrive. The full reply is returned.
+    // Cancelling aborts the transfer and returns what has arrived so far. While
+    // waiting for the first byte, curl notices the cancel within about a second.
+    std::string generateStream(const std::string& prompt,
+                               RemoteTokenCallback onToken,
+                               std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    std::string generateChatStream(const std::vector<RemoteChatMessage>& messages,
+                                   RemoteTokenCallback onToken,
+                                   std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    // Non-blocking variants. The request is queued on a shared event-driven HTTP
+    // client and the future resolves with the reply (empty on error), so many
+    // prompts can be in flight without spawning a thread per request.
+    std::future<std::string> generateAsync(const std::string& prompt);
+    std::future<std::string> generateChatAsync(const std::vector<RemoteChatMessage>& messages);
     bool isRemote() const override;
 
     // Configuration setters used by the examples before setup()/generate().
@@ -46,8 +105,35 @@ public:
     void setSystemPromptAsSystemMessage(bool enabled);
     void setExtraBody(const ofJson& extraBody);
     void setStripReasoning(bool enabled);
-    // Queries the endpoint's model listing endpoint when available.
+    // Keep-alive settings for the HTTP handles reused between requests.
+    void setConnectionPoolSize(std::size_t maxIdleConnectionsPerHost);
+    void setConnectionIdleTimeout(float seconds);
+    // Shares one pool between several providers that talk to the same gateway.
+    void setConnectionPool(std::shared_ptr<RemoteHttpConnectionPool> pool);
+    // Maximum number of asynchronous requests running at once against the endpoint host.
+    void setMaxConcurrentRequests(std::size_t count);
+    // Retry and hedging behaviour for chat-completion requests.
+    void setRetryPolicy(const RemoteRetryPolicy& policy);
+    void setHedgingPolicy(const RemoteHedgingPolicy& policy);
+    // Client-side quota on requests/min and tokens/min. Requests wait locally
+    // until they fit instead of being answered with 429.
+    void setRateLimits(const RemoteRateLimits& limits);
+    // Shares one limiter between several providers that use the same API key.
+    void setRateLimiter(std::shared_ptr<RemoteRateLimiter> limiter);
+    std::shared_ptr<RemoteRateLimiter> getRateLimiter() const;
+    // Token usage reported by the server, per model and summed over all models.
+    std::map<std::string, RemoteUsageStats> getUsageByModel() const;
+    RemoteUsageStats getTotalUsage() const;
+    // Completion tokens from the usage blocks, or -1 while replies arrive
+    // without one. Replies served from the response cache are not counted.
+    long long getCompletionTokenCount() const override;
+    void resetUsage();
+    // Queries the endpoint's model listing endpoint when available. This blocks
+    // on the network; RemoteModelCatalog caches the result off the UI thread.
     std::vector<std::string> listModels() const;
+    // Same, but reports whether the endpoint answered with a valid listing.
+    // Listing requests time out after a few seconds; cancel aborts one early.
+    bool listModels(std::vector<std::string>& models, std::shared_ptr<InferenceCancellationToken> cancel = nullptr) const;
 
 private:
     // Connection and request configuration.
@@ -61,14 +147,54 @@ private:
     bool systemPromptAsSystemMessage = false;
     ofJson extraBody;
     bool stripReasoning = false;
+    std::shared_ptr<RemoteHttpConnectionPool> connectionPool;
+    std::size_t maxConcurrentRequests = 8;
+    RemoteRetryPolicy retryPolicy;
+    RemoteHedgingPolicy hedgingPolicy;
+    std::shared_ptr<RemoteRateLimiter> rateLimiter;
+
+    mutable std::mutex usageMutex;
+    mutable std::map<std::string, RemoteUsageStats> usageByModel;
+
+    // Recent successful request latencies in seconds, used for the hedge delay.
+    mutable std::mutex latencyMutex;
+    std::deque<double> recentLatencies;
+
+    struct AsyncRequest;
+
+    // Model and estimated token cost of one request, for the rate limiter and
+    // usage counters.
+    struct RequestAccounting {
+        std::string model;
+        double estimatedTokens = 0.0;
+    };
 
     // Request/response helpers.
     ofJson buildRequestBody(const std::string& prompt) const;
     ofJson buildChatRequestBody(const std::vector<RemoteChatMessage>& messages) const;
-    std::string parseResponseContent(const ofJson& response) const;
     std::string stripReasoningBlocks(const std::string& text) const;
-    ofHttpResponse performPost(const ofJson& body) const;
-    ofHttpResponse performGet(const std::string& url) const;
+    RemoteHttpResult performPost(const std::string& payload) const;
+    RemoteHttpResult performGet(const std::string& url, const InferenceCancellationToken* cancel) const;
+    // A timeout of 0 only aborts stalled transfers.
+    RemoteHttpResult performRequest(const std::string& url, const std::string* payload, long timeoutSeconds = 0,
+                                    const InferenceCancellationToken* cancel = nullptr) const;
+    std::string postForContent(const ofJson& body);
+    std::future<std::string> submitAsync(const ofJson& body);
+    void startAsyncAttempt(const std::shared_ptr<AsyncRequest>& request, std::chrono::milliseconds delay);
+    void finishAsyncAttempt(const std::shared_ptr<AsyncRequest>& request, int attempt, int slot, RemoteHttpResult& result);
+    RemoteHttpClient& getAsyncClient();
+    bool shouldRetry(const RemoteHttpResult& result, int attempt) const;
+    std::chrono::milliseconds retryDelay(int attempt, double retryAfterSeconds) const;
+    std::chrono::milliseconds hedgeDelay() const;
+    void recordLatency(double seconds);
+    std::string cacheKeyForBody(const ofJson& body) const;
+    RequestAccounting accountingForBody(const ofJson& body) const;
+    bool waitForRateLimit(const RequestAccounting& accounting, const InferenceCancellationToken* cancel) const;
+    void recordUsage(const RequestAccounting& accounting, long long promptTokens, long long completionTokens) const;
+    std::string parseResponseText(long status, const std::string& responseText, const std::string& error,
+                                  const RequestAccounting& accounting) const;
+    std::string performStreamingPost(ofJson body, const RemoteTokenCallback& onToken, const InferenceCancellationToken* cancel) const;
+    std::vector<std::string> buildRequestHeaders(bool acceptEventStream) const;
     std::string getChatCompletionsUrl() const;
     bool isAzureOpenAI() const;
 
@@ -76,4 +202,9 @@ private:
     static std::string normalizeEndpointUrl(const std::string& url);
     static std::string normalizeAzureEndpointUrl(const std::string& url);
     static std::string modelsUrlFromEndpointUrl(const std::string& endpointUrl);
+
+    // Created on first async request. Declared last so it shuts down, and fails
+    // any pending futures, before the configuration above is destroyed.
+    std::mutex asyncClientMutex;
+    std::unique_ptr<RemoteHttpClient> asyncClient;
 };
@@ -0,0 +1,449 @@
+#include "RemoteHttpClient.h"
+
+#include "RemoteHttpConnectionPool.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+
+namespace {
+    const long CONNECT_TIMEOUT_SECONDS = 30;
+    const long STALL_TIMEOUT_SECONDS = 120;
+    const int POLL_TIMEOUT_MS = 1000;
+
+    std::size_t appendToString(char* data, std::size_t size, std::size_t count, void* userData) {
+        static_cast<std::string*>(userData)->append(data, size * count);
+        return size * count;
+    }
+}
+
+RemoteHttpClient::RemoteHttpClient(std::size_t maxConcurrentPerHost)
+: maxConcurrentPerHost(std::max<std::size_t>(1, maxConcurrentPerHost)) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    multi = curl_multi_init();
+    loop = std::thread(&RemoteHttpClient::run, this);
+}
+
+RemoteHttpClient::~RemoteHttpClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    curl_multi_wakeup(multi);
+
+    if (loop.joinable()) {
+        loop.join();
+    }
+
+    for (CURL* handle : spareHandles) {
+        curl_easy_cleanup(handle);
+    }
+    curl_multi_cleanup(multi);
+    curl_global_cleanup();
+}
+
+RemoteHttpClient::RequestId RemoteHttpClient::submit(const std::string& url,
+                                                     const std::vector<std::string>& headers,
+                                                     std::string payload,
+                                                     Completion onComplete) {
+    return submitAfter(std::chrono::milliseconds(0), url, headers, std::move(payload), std::move(onComplete));
+}
+
+RemoteHttpClient::RequestId RemoteHttpClient::submitAfter(std::chrono::milliseconds delay,
+                                                          const std::string& url,
+                                                          const std::vector<std::string>& headers,
+                                                          std::string payload,
+                                                          Completion onComplete) {
+    std::unique_ptr<Transfer> transfer(new Transfer());
+    transfer->url = url;
+    transfer->hostKey = RemoteHttpConnectionPool::hostKeyFromUrl(url);
+    transfer->headers = headers;
+    transfer->payload = std::move(payload);
+    transfer->onComplete = std::move(onComplete);
+    transfer->notBefore = Clock::now() + delay;
+
+    RequestId id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopping) {
+            id = nextId++;
+            transfer->id = id;
+            incoming.push_back(std::move(transfer));
+            ++outstanding;
+        }
+    }
+
+    if (transfer) {
+        // Rejected because the client is shutting down.
+        transfer->result.status = -1;
+        transfer->result.error = "HTTP client is shutting down.";
+        transfer->result.aborted = true;
+        if (transfer->onComplete) {
+            transfer->onComplete(transfer->result);
+        }
+        return 0;
+    }
+
+    curl_multi_wakeup(multi);
+    return id;
+}
+
+void RemoteHttpClient::cancel(RequestId id) {
+    if (id == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelRequests.insert(id);
+    }
+    curl_multi_wakeup(multi);
+}
+
+void RemoteHttpClient::setMaxConcurrentPerHost(std::size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxConcurrentPerHost = std::max<std::size_t>(1, count);
+    }
+    curl_multi_wakeup(multi);
+}
+
+std::size_t RemoteHttpClient::getMaxConcurrentPerHost() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxConcurrentPerHost;
+}
+
+std::size_t RemoteHttpClient::getOutstandingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return outstanding;
+}
+
+bool RemoteHttpClient::parseRetryAfterHeader(const std::string& line, double& seconds) {
+    const std::string name = "retry-after:";
+    if (line.size() <= name.size()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(line[i])) != name[i]) {
+            return false;
+        }
+    }
+
+    std::string value = line.substr(name.size());
+    const std::size_t first = value.find_first_not_of(" \t");
+    const std::size_t last = value.find_last_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return false;
+    }
+    value = value.substr(first, last - first + 1);
+
+    // Either delta-seconds or an HTTP-date.
+    char* end = nullptr;
+    const double delta = std::strtod(value.c_str(), &end);
+    if (end && *end == '\0') {
+        seconds = std::max(0.0, delta);
+        return true;
+    }
+
+    const time_t date = curl_getdate(value.c_str(), nullptr);
+    if (date < 0) {
+        return false;
+    }
+
+    seconds = std::max(0.0, std::difftime(date, std::time(nullptr)));
+    return true;
+}
+
+std::size_t RemoteHttpClient::captureRetryAfter(char* data, std::size_t size, std::size_t count, void* result) {
+    double seconds = 0.0;
+    if (parseRetryAfterHeader(std::string(data, size * count), seconds)) {
+        static_cast<RemoteHttpResult*>(result)->retryAfterSeconds = seconds;
+    }
+    return size * count;
+}
+
+void RemoteHttpClient::run() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                break;
+            }
+        }
+
+        takeIncoming();
+        processCancellations();
+        startWaitingTransfers();
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        int remaining = 0;
+        bool finishedAny = false;
+        while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+            if (message->msg == CURLMSG_DONE) {
+                // Copy out before removing the handle; the message is invalid afterwards.
+                CURL* handle = message->easy_handle;
+                const CURLcode code = message->data.result;
+                finishTransfer(handle, static_cast<int>(code));
+                finishedAny = true;
+            }
+        }
+
+        // A freed slot may let a queued request start right away.
+        if (!finishedAny) {
+            curl_multi_poll(multi, nullptr, 0, nextPollTimeoutMs(), nullptr);
+        }
+    }
+
+    failAll("HTTP client is shutting down.");
+}
+
+void RemoteHttpClient::takeIncoming() {
+    std::deque<std::unique_ptr<Transfer>> taken;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        taken.swap(incoming);
+    }
+
+    for (auto& transfer : taken) {
+        delayed.push_back(std::move(transfer));
+    }
+
+    // Promote due requests into their host queue, keeping submission order.
+    const Clock::time_point now = Clock::now();
+    auto due = std::stable_partition(delayed.begin(), delayed.end(), [&](const std::unique_ptr<Transfer>& transfer) {
+        return transfer->notBefore <= now;
+    });
+    for (auto it = delayed.begin(); it != due; ++it) {
+        const std::string hostKey = (*it)->hostKey;
+        waiting[hostKey].push_back(std::move(*it));
+    }
+    delayed.erase(delayed.begin(), due);
+}
+
+void RemoteHttpClient::processCancellations() {
+    std::set<RequestId> ids;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.swap(cancelRequests);
+    }
+
+    if (ids.empty()) {
+        return;
+    }
+
+    for (auto it = delayed.begin(); it != delayed.end();) {
+        if (ids.count((*it)->id)) {
+            std::unique_ptr<Transfer> transfer = std::move(*it);
+            it = delayed.erase(it);
+            complete(std::move(transfer), "Request cancelled.", true);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto& entry : waiting) {
+        auto& queue = entry.second;
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (ids.count((*it)->id)) {
+                std::unique_ptr<Transfer> transfer = std::move(*it);
+                it = queue.erase(it);
+                complete(std::move(transfer), "Request cancelled.", true);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto it = active.begin(); it != active.end();) {
+        if (!ids.count(it->second->id)) {
+            ++it;
+            continue;
+        }
+
+        CURL* handle = it->first;
+        std::unique_ptr<Transfer> transfer = std::move(it->second);
+        it = active.erase(it);
+
+        curl_multi_remove_handle(multi, handle);
+        curl_easy_cleanup(handle);
+        curl_slist_free_all(transfer->headerList);
+        transfer->headerList = nullptr;
+
+        std::size_t& running = inFlight[transfer->hostKey];
+        if (running > 0) {
+            --running;
+        }
+        complete(std::move(transfer), "Request cancelled.", true);
+    }
+}
+
+void RemoteHttpClient::startWaitingTransfers() {
+    std::size_t limit = 1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        limit = maxConcurrentPerHost;
+    }
+
+    for (auto& entry : waiting) {
+        auto& queue = entry.second;
+        std::size_t& running = inFlight[entry.first];
+
+        while (!queue.empty() && running < limit) {
+            std::unique_ptr<Transfer> transfer = std::move(queue.front());
+            queue.pop_front();
+
+            if (startTransfer(std::move(transfer))) {
+                ++running;
+            }
+        }
+    }
+}
+
+bool RemoteHttpClient::startTransfer(std::unique_ptr<Transfer> transfer) {
+    CURL* handle = nullptr;
+    if (!spareHandles.empty()) {
+        handle = spareHandles.back();
+        spareHandles.pop_back();
+        curl_easy_reset(handle);
+    } else {
+        handle = curl_easy_init();
+    }
+
+    if (!handle) {
+        complete(std::move(transfer), "Failed to create HTTP handle.");
+        return false;
+    }
+
+    for (const auto& header : transfer->headers) {
+        transfer->headerList = curl_slist_append(transfer->headerList, header.c_str());
+    }
+
+    curl_easy_setopt(handle, CURLOPT_URL, transfer->url.c_str());
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, transfer->headerList);
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT_SECONDS);
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, STALL_TIMEOUT_SECONDS);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, appendToString);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer->result.body);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, captureRetryAfter);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, &transfer->result);
+
+    if (!transfer->payload.empty()) {
+        curl_easy_setopt(handle, CURLOPT_POST, 1L);
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDS, transfer->payload.c_str());
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->payload.size()));
+    } else {
+        curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+    }
+
+    transfer->handle = handle;
+    curl_multi_add_handle(multi, handle);
+    active[handle] = std::move(transfer);
+    return true;
+}
+
+void RemoteHttpClient::finishTransfer(CURL* handle, int code) {
+    auto it = active.find(handle);
+    if (it == active.end()) {
+        return;
+    }
+
+    std::unique_ptr<Transfer> transfer = std::move(it->second);
+    active.erase(it);
+    curl_multi_remove_handle(multi, handle);
+
+    std::string error;
+    if (code == CURLE_OK) {
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &transfer->result.status);
+        spareHandles.push_back(handle);
+    } else {
+        error = curl_easy_strerror(static_cast<CURLcode>(code));
+        curl_easy_cleanup(handle);
+    }
+
+    curl_slist_free_all(transfer->headerList);
+    transfer->headerList = nullptr;
+
+    std::size_t& running = inFlight[transfer->hostKey];
+    if (running > 0) {
+        --running;
+    }
+
+    complete(std::move(transfer), error);
+}
+
+void RemoteHttpClient::complete(std::unique_ptr<Transfer> transfer, const std::string& error, bool aborted) {
+    if (!error.empty()) {
+        transfer->result.status = -1;
+        transfer->result.error = error;
+    }
+    transfer->result.aborted = aborted;
+
+    if (transfer->onComplete) {
+        transfer->onComplete(transfer->result);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outstanding > 0) {
+        --outstanding;
+    }
+}
+
+void RemoteHttpClient::failAll(const std::string& error) {
+    std::vector<std::unique_ptr<Transfer>> failed;
+
+    for (auto& entry : active) {
+        curl_multi_remove_handle(multi, entry.first);
+        curl_easy_cleanup(entry.first);
+        curl_slist_free_all(entry.second->headerList);
+        entry.second->headerList = nullptr;
+        failed.push_back(std::move(entry.second));
+    }
+    active.clear();
+
+    for (auto& entry : waiting) {
+        for (auto& transfer : entry.second) {
+            failed.push_back(std::move(transfer));
+        }
+    }
+    waiting.clear();
+    inFlight.clear();
+
+    for (auto& transfer : delayed) {
+        failed.push_back(std::move(transfer));
+    }
+    delayed.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& transfer : incoming) {
+            failed.push_back(std::move(transfer));
+        }
+        incoming.clear();
+    }
+
+    for (auto& transfer : failed) {
+        complete(std::move(transfer), error, true);
+    }
+}
+
+int RemoteHttpClient::nextPollTimeoutMs() const {
+    int timeout = POLL_TIMEOUT_MS;
+    const Clock::time_point now = Clock::now();
+
+    for (const auto& transfer : delayed) {
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(transfer->notBefore - now).count();
+        timeout = std::min(timeout, static_cast<int>(std::max<long long>(0, wait)));
+    }
+
+    return timeout;
+}
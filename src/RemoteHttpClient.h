@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef void CURL;
+typedef void CURLM;
+struct curl_slist;
+
+// Outcome of one request executed by RemoteHttpClient. status is -1 when the
+// transfer itself failed (DNS, connect, TLS, shutdown, cancel) and error says why.
+struct RemoteHttpResult {
+    long status = 0;
+    std::string body;
+    std::string error;
+    // Server-requested delay from a Retry-After header, or -1 when absent.
+    double retryAfterSeconds = -1.0;
+    // True when the request was cancelled or dropped at shutdown rather than failing.
+    bool aborted = false;
+};
+
+// Event-driven HTTP client for many concurrent requests. A single background
+// thread drives every transfer through curl's multi interface, so dozens of
+// in-flight requests cost no extra threads. Requests beyond the per-host limit
+// wait in a FIFO queue until a slot frees up. Connections are kept alive and
+// reused across requests by the multi handle's connection cache.
+class RemoteHttpClient {
+public:
+    // Invoked on the client's thread once the request has completed or failed.
+    using Completion = std::function<void(RemoteHttpResult&)>;
+    using RequestId = std::uint64_t;
+
+    explicit RemoteHttpClient(std::size_t maxConcurrentPerHost = 8);
+    ~RemoteHttpClient();
+
+    RemoteHttpClient(const RemoteHttpClient&) = delete;
+    RemoteHttpClient& operator=(const RemoteHttpClient&) = delete;
+
+    // Queues a POST (non-empty payload) or GET (empty payload). Never blocks on the network.
+    RequestId submit(const std::string& url,
+                     const std::vector<std::string>& headers,
+                     std::string payload,
+                     Completion onComplete);
+    // Same as submit(), but the request is not started before delay has elapsed.
+    RequestId submitAfter(std::chrono::milliseconds delay,
+                          const std::string& url,
+                          const std::vector<std::string>& headers,
+                          std::string payload,
+                          Completion onComplete);
+    // Aborts a queued or running request; its completion runs with status -1.
+    void cancel(RequestId id);
+
+    // Upper bound of simultaneously running requests per scheme/host/port.
+    void setMaxConcurrentPerHost(std::size_t count);
+    std::size_t getMaxConcurrentPerHost() const;
+    // Requests submitted but not yet completed, including queued ones.
+    std::size_t getOutstandingCount() const;
+
+    // Parses one raw header line; returns true and sets seconds for Retry-After.
+    static bool parseRetryAfterHeader(const std::string& line, double& seconds);
+    // curl CURLOPT_HEADERFUNCTION that fills RemoteHttpResult::retryAfterSeconds.
+    static std::size_t captureRetryAfter(char* data, std::size_t size, std::size_t count, void* result);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Transfer {
+        RequestId id = 0;
+        std::string url;
+        std::string hostKey;
+        std::vector<std::string> headers;
+        std::string payload;
+        Completion onComplete;
+        Clock::time_point notBefore;
+        CURL* handle = nullptr;
+        curl_slist* headerList = nullptr;
+        RemoteHttpResult result;
+    };
+
+    void run();
+    void takeIncoming();
+    void processCancellations();
+    void startWaitingTransfers();
+    bool startTransfer(std::unique_ptr<Transfer> transfer);
+    void finishTransfer(CURL* handle, int code);
+    void complete(std::unique_ptr<Transfer> transfer, const std::string& error, bool aborted = false);
+    void failAll(const std::string& error);
+    int nextPollTimeoutMs() const;
+
+    CURLM* multi = nullptr;
+    std::thread loop;
+
+    mutable std::mutex mutex;
+    std::deque<std::unique_ptr<Transfer>> incoming;
+    std::set<RequestId> cancelRequests;
+    std::size_t maxConcurrentPerHost;
+    std::size_t outstanding = 0;
+    RequestId nextId = 1;
+    bool stopping = false;
+
+    // Owned by the loop thread only.
+    std::vector<std::unique_ptr<Transfer>> delayed;
+    std::map<std::string, std::deque<std::unique_ptr<Transfer>>> waiting;
+    std::map<std::string, std::size_t> inFlight;
+    std::map<CURL*, std::unique_ptr<Transfer>> active;
+    std::vector<CURL*> spareHandles;
+};
@@ -0,0 +1,228 @@
+#include "RemoteHttpConnectionPool.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    void ensureCurlInitialized() {
+        static std::once_flag flag;
+        std::call_once(flag, []() {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+        });
+    }
+
+    void closeHandles(const std::vector<CURL*>& handles) {
+        for (CURL* handle : handles) {
+            curl_easy_cleanup(handle);
+        }
+    }
+}
+
+RemoteHttpConnectionPool::Lease::Lease(RemoteHttpConnectionPool* pool, std::string hostKey, CURL* handle)
+: pool(pool)
+, hostKey(std::move(hostKey))
+, handle(handle) {
+}
+
+RemoteHttpConnectionPool::Lease::Lease(Lease&& other) noexcept
+: pool(other.pool)
+, hostKey(std::move(other.hostKey))
+, handle(other.handle) {
+    other.pool = nullptr;
+    other.handle = nullptr;
+}
+
+RemoteHttpConnectionPool::Lease& RemoteHttpConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        hostKey = std::move(other.hostKey);
+        handle = other.handle;
+        other.pool = nullptr;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+RemoteHttpConnectionPool::Lease::~Lease() {
+    release();
+}
+
+CURL* RemoteHttpConnectionPool::Lease::get() const {
+    return handle;
+}
+
+RemoteHttpConnectionPool::Lease::operator bool() const {
+    return handle != nullptr;
+}
+
+void RemoteHttpConnectionPool::Lease::discard() {
+    if (handle) {
+        curl_easy_cleanup(handle);
+        handle = nullptr;
+    }
+    pool = nullptr;
+}
+
+void RemoteHttpConnectionPool::Lease::release() {
+    if (pool && handle) {
+        pool->release(hostKey, handle);
+    } else if (handle) {
+        curl_easy_cleanup(handle);
+    }
+    pool = nullptr;
+    handle = nullptr;
+}
+
+RemoteHttpConnectionPool::RemoteHttpConnectionPool(std::size_t maxIdleHandlesPerHost, std::chrono::seconds idleTimeout)
+: maxIdleHandlesPerHost(maxIdleHandlesPerHost)
+, idleTimeout(idleTimeout) {
+    ensureCurlInitialized();
+}
+
+RemoteHttpConnectionPool::~RemoteHttpConnectionPool() {
+    clear();
+}
+
+RemoteHttpConnectionPool::Lease RemoteHttpConnectionPool::acquire(const std::string& url) {
+    const std::string hostKey = hostKeyFromUrl(url);
+    CURL* handle = nullptr;
+    std::vector<CURL*> expired;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = std::chrono::steady_clock::now();
+
+        auto it = idleHandles.find(hostKey);
+        if (it != idleHandles.end()) {
+            auto& handles = it->second;
+            // Most recently used handles sit at the back and are the most likely to be warm.
+            while (!handles.empty() && !handle) {
+                IdleHandle idle = handles.back();
+                handles.pop_back();
+
+                if (now - idle.lastUsed > idleTimeout) {
+                    expired.push_back(idle.handle);
+                } else {
+                    handle = idle.handle;
+                }
+            }
+        }
+    }
+
+    closeHandles(expired);
+
+    if (handle) {
+        // Resets options only; the connection cache, DNS cache and TLS sessions survive.
+        curl_easy_reset(handle);
+    } else {
+        handle = curl_easy_init();
+        if (!handle) {
+            return Lease();
+        }
+    }
+
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, static_cast<long>(getIdleTimeout().count()));
+
+    return Lease(this, hostKey, handle);
+}
+
+void RemoteHttpConnectionPool::setMaxIdleHandlesPerHost(std::size_t count) {
+    std::vector<CURL*> excess;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxIdleHandlesPerHost = count;
+
+        for (auto& entry : idleHandles) {
+            auto& handles = entry.second;
+            while (handles.size() > maxIdleHandlesPerHost) {
+                excess.push_back(handles.front().handle);
+                handles.erase(handles.begin());
+            }
+        }
+    }
+
+    closeHandles(excess);
+}
+
+void RemoteHttpConnectionPool::setIdleTimeout(std::chrono::seconds timeout) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idleTimeout = timeout;
+}
+
+std::chrono::seconds RemoteHttpConnectionPool::getIdleTimeout() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return idleTimeout;
+}
+
+void RemoteHttpConnectionPool::clear() {
+    std::vector<CURL*> handles;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : idleHandles) {
+            for (const auto& idle : entry.second) {
+                handles.push_back(idle.handle);
+            }
+        }
+        idleHandles.clear();
+    }
+
+    closeHandles(handles);
+}
+
+void RemoteHttpConnectionPool::release(const std::string& hostKey, CURL* handle) {
+    std::vector<CURL*> toClose;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = std::chrono::steady_clock::now();
+        auto& handles = idleHandles[hostKey];
+
+        if (handles.size() < maxIdleHandlesPerHost) {
+            handles.push_back({handle, now});
+        } else {
+            toClose.push_back(handle);
+        }
+
+        // Opportunistically close handles that have been idle too long.
+        for (auto& entry : idleHandles) {
+            auto& list = entry.second;
+            auto expiredEnd = std::find_if(list.begin(), list.end(), [&](const IdleHandle& idle) {
+                return now - idle.lastUsed <= idleTimeout;
+            });
+            for (auto it = list.begin(); it != expiredEnd; ++it) {
+                toClose.push_back(it->handle);
+            }
+            list.erase(list.begin(), expiredEnd);
+        }
+    }
+
+    closeHandles(toClose);
+}
+
+std::string RemoteHttpConnectionPool::hostKeyFromUrl(const std::string& url) {
+    // scheme://[user@]host[:port]/path -> scheme://host:port (lowercase).
+    const std::size_t schemeEnd = url.find("://");
+    const std::string scheme = schemeEnd == std::string::npos ? "http" : url.substr(0, schemeEnd);
+    const std::size_t authorityStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+    const std::size_t authorityEnd = url.find_first_of("/?#", authorityStart);
+
+    std::string authority = url.substr(authorityStart,
+        authorityEnd == std::string::npos ? std::string::npos : authorityEnd - authorityStart);
+
+    const std::size_t at = authority.rfind('@');
+    if (at != std::string::npos) {
+        authority.erase(0, at + 1);
+    }
+
+    std::string key = scheme + "://" + authority;
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return key;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+typedef void CURL;
+
+// Keeps libcurl easy handles alive between requests. A reused handle keeps its
+// open connection, DNS entry and TLS session, so back-to-back requests to the
+// same host skip the TCP and TLS handshakes.
+class RemoteHttpConnectionPool {
+public:
+    // Borrowed handle that returns itself to the pool when it goes out of scope.
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(RemoteHttpConnectionPool* pool, std::string hostKey, CURL* handle);
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        CURL* get() const;
+        explicit operator bool() const;
+        // Drops the handle instead of returning it, e.g. after a transport error.
+        void discard();
+
+    private:
+        void release();
+
+        RemoteHttpConnectionPool* pool = nullptr;
+        std::string hostKey;
+        CURL* handle = nullptr;
+    };
+
+    explicit RemoteHttpConnectionPool(std::size_t maxIdleHandlesPerHost = 4,
+                                      std::chrono::seconds idleTimeout = std::chrono::seconds(60));
+    ~RemoteHttpConnectionPool();
+
+    RemoteHttpConnectionPool(const RemoteHttpConnectionPool&) = delete;
+    RemoteHttpConnectionPool& operator=(const RemoteHttpConnectionPool&) = delete;
+
+    // Returns a reset handle for the URL's scheme/host/port, reusing a warm one when available.
+    Lease acquire(const std::string& url);
+
+    // Number of idle handles kept per host. Extra handles are closed on release.
+    void setMaxIdleHandlesPerHost(std::size_t count);
+    // Idle handles older than this are closed instead of reused.
+    void setIdleTimeout(std::chrono::seconds timeout);
+    std::chrono::seconds getIdleTimeout() const;
+    // Closes every idle handle.
+    void clear();
+
+    static std::string hostKeyFromUrl(const std::string& url);
+
+private:
+    struct IdleHandle {
+        CURL* handle;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    void release(const std::string& hostKey, CURL* handle);
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::vector<IdleHandle>> idleHandles;
+    std::size_t maxIdleHandlesPerHost;
+    std::chrono::seconds idleTimeout;
+};
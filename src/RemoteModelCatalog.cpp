@@ -0,0 +1,164 @@
+#include "RemoteModelCatalog.h"
+
+#include "ofMain.h"
+
+#include <algorithm>
+#include <thread>
+
+RemoteModelCatalog::RemoteModelCatalog(float timeToLiveSeconds) {
+    setTimeToLive(timeToLiveSeconds);
+}
+
+RemoteModelCatalog::~RemoteModelCatalog() {
+    shutdown->cancel();
+    std::unique_lock<std::mutex> lock(mutex);
+    refreshesDone.wait(lock, [this]() { return activeRefreshes == 0; });
+}
+
+void RemoteModelCatalog::addEndpoint(const std::string& name, std::shared_ptr<RemoteAPIProvider> provider) {
+    if (!provider) {
+        ofLogError("RemoteModelCatalog") << "Cannot add endpoint " << name << " without a provider.";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Endpoint& endpoint = endpoints[name];
+    endpoint.provider = provider;
+    endpoint.generation = nextGeneration++;
+    endpoint.stale = true;
+    // A probe still running for the old configuration is ignored when it ends.
+    endpoint.refreshing = false;
+    refreshLocked(name, endpoint);
+}
+
+void RemoteModelCatalog::removeEndpoint(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    endpoints.erase(name);
+}
+
+void RemoteModelCatalog::setTimeToLive(float seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    timeToLive = std::chrono::milliseconds(static_cast<long long>(std::max(0.0f, seconds) * 1000.0f));
+}
+
+std::vector<std::string> RemoteModelCatalog::getModels(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto found = endpoints.find(name);
+    if (found == endpoints.end()) {
+        return std::vector<std::string>();
+    }
+
+    Endpoint& endpoint = found->second;
+    if (isExpiredLocked(endpoint, Clock::now())) {
+        refreshLocked(name, endpoint);
+    }
+    return endpoint.models;
+}
+
+void RemoteModelCatalog::refresh(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto found = endpoints.find(name);
+    if (found != endpoints.end()) {
+        refreshLocked(name, found->second);
+    }
+}
+
+void RemoteModelCatalog::refreshAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : endpoints) {
+        refreshLocked(entry.first, entry.second);
+    }
+}
+
+bool RemoteModelCatalog::waitForRefresh(float timeoutSeconds) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return refreshesDone.wait_for(lock, std::chrono::duration<float>(std::max(0.0f, timeoutSeconds)), [this]() {
+        return activeRefreshes == 0;
+    });
+}
+
+bool RemoteModelCatalog::isRefreshing(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto found = endpoints.find(name);
+    return found != endpoints.end() && found->second.refreshing;
+}
+
+std::vector<RemoteEndpointStatus> RemoteModelCatalog::getStatus() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point now = Clock::now();
+
+    std::vector<RemoteEndpointStatus> result;
+    for (const auto& entry : endpoints) {
+        const Endpoint& endpoint = entry.second;
+        RemoteEndpointStatus status;
+        status.name = entry.first;
+        status.models = endpoint.models;
+        status.hasListing = endpoint.hasListing;
+        status.healthy = endpoint.healthy;
+        status.refreshing = endpoint.refreshing;
+        status.latencySeconds = endpoint.latencySeconds;
+        if (endpoint.hasListing) {
+            status.ageSeconds = std::chrono::duration<double>(now - endpoint.fetchedAt).count();
+        }
+        result.push_back(status);
+    }
+    return result;
+}
+
+std::uint64_t RemoteModelCatalog::getVersion() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return version;
+}
+
+void RemoteModelCatalog::refreshLocked(const std::string& name, Endpoint& endpoint) {
+    if (endpoint.refreshing) {
+        return;
+    }
+
+    endpoint.refreshing = true;
+    ++activeRefreshes;
+    // One thread per endpoint, so a slow or unreachable host delays only its own listing.
+    std::thread(&RemoteModelCatalog::runRefresh, this, name, endpoint.provider, endpoint.generation).detach();
+}
+
+void RemoteModelCatalog::runRefresh(std::string name, std::shared_ptr<RemoteAPIProvider> provider, std::uint64_t generation) {
+    const Clock::time_point startedAt = Clock::now();
+    std::vector<std::string> models;
+    const bool ok = provider->listModels(models, shutdown);
+    const Clock::time_point finishedAt = Clock::now();
+
+    // Listings can repeat ids, e.g. one model served in several regions.
+    std::vector<std::string> unique;
+    unique.reserve(models.size());
+    for (const auto& model : models) {
+        if (std::find(unique.begin(), unique.end(), model) == unique.end()) {
+            unique.push_back(model);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto found = endpoints.find(name);
+    if (found != endpoints.end() && found->second.generation == generation) {
+        Endpoint& endpoint = found->second;
+        endpoint.refreshing = false;
+        endpoint.healthy = ok;
+        endpoint.latencySeconds = std::chrono::duration<double>(finishedAt - startedAt).count();
+        // A failed probe keeps the last good list; retry after another TTL.
+        if (ok) {
+            endpoint.models = std::move(unique);
+            endpoint.hasListing = true;
+            endpoint.fetchedAt = finishedAt;
+        }
+        endpoint.stale = false;
+        endpoint.probedAt = finishedAt;
+        ++version;
+    }
+
+    // Last access to this object: the destructor waits for the count to drop.
+    --activeRefreshes;
+    refreshesDone.notify_all();
+}
+
+bool RemoteModelCatalog::isExpiredLocked(const Endpoint& endpoint, Clock::time_point now) const {
+    return endpoint.stale || now - endpoint.probedAt >= timeToLive;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "RemoteAPIProvider.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What the catalog knows about one endpoint.
+struct RemoteEndpointStatus {
+    std::string name;
+    std::vector<std::string> models;
+    // At least one listing has been fetched; models may be stale.
+    bool hasListing = false;
+    // The most recent probe got a valid listing.
+    bool healthy = false;
+    bool refreshing = false;
+    // Duration of the most recent probe, and age of the models, in seconds.
+    double latencySeconds = -1.0;
+    double ageSeconds = -1.0;
+};
+
+// Cached model listings for one or more endpoints. getModels() never touches
+// the network: it returns the cached list at once, even when it is stale or
+// still empty, and starts a background refresh when the list is older than
+// the time to live. refreshAll() probes every endpoint in parallel, which also
+// serves as a health check. Poll getVersion() from update() to notice new data.
+class RemoteModelCatalog {
+public:
+    explicit RemoteModelCatalog(float timeToLiveSeconds = 300.0f);
+    // Cancels running refreshes and waits for their threads to exit.
+    ~RemoteModelCatalog();
+
+    // The provider is used only for listing; give it its own instance so the
+    // background thread never races configuration changes on a chat provider.
+    // Replacing an endpoint keeps its cached list but marks it stale.
+    void addEndpoint(const std::string& name, std::shared_ptr<RemoteAPIProvider> provider);
+    void removeEndpoint(const std::string& name);
+
+    void setTimeToLive(float seconds);
+
+    std::vector<std::string> getModels(const std::string& name);
+    // Starts a background refresh unless one is already running.
+    void refresh(const std::string& name);
+    void refreshAll();
+    // Blocks until no refresh is running or the timeout passes, for tools
+    // without a frame loop. Returns false on timeout.
+    bool waitForRefresh(float timeoutSeconds);
+
+    bool isRefreshing(const std::string& name) const;
+    std::vector<RemoteEndpointStatus> getStatus() const;
+    // Incremented each time a refresh finishes.
+    std::uint64_t getVersion() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Endpoint {
+        std::shared_ptr<RemoteAPIProvider> provider;
+        std::vector<std::string> models;
+        bool hasListing = false;
+        bool healthy = false;
+        bool stale = true;
+        bool refreshing = false;
+        // Changes when the endpoint is replaced, so an old probe cannot
+        // overwrite the listing of the new configuration.
+        std::uint64_t generation = 0;
+        double latencySeconds = -1.0;
+        Clock::time_point fetchedAt; // Last good listing.
+        Clock::time_point probedAt;  // Last probe, successful or not.
+    };
+
+    void refreshLocked(const std::string& name, Endpoint& endpoint);
+    void runRefresh(std::string name, std::shared_ptr<RemoteAPIProvider> provider, std::uint64_t generation);
+    bool isExpiredLocked(const Endpoint& endpoint, Clock::time_point now) const;
+
+    mutable std::mutex mutex;
+    std::condition_variable refreshesDone;
+    std::map<std::string, Endpoint> endpoints;
+    std::chrono::milliseconds timeToLive;
+    std::uint64_t nextGeneration = 1;
+    std::uint64_t version = 0;
+    std::size_t activeRefreshes = 0;
+    // Aborts in-flight listings so destruction does not wait on the network.
+    std::shared_ptr<InferenceCancellationToken> shutdown = std::make_shared<InferenceCancellationToken>();
+};
@@ -0,0 +1,92 @@
+#include "RemoteRateLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+RemoteRateLimiter::RemoteRateLimiter(const RemoteRateLimits& limits) {
+    setLimits(limits);
+}
+
+void RemoteRateLimiter::setLimits(const RemoteRateLimits& limits) {
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.capacity = std::max(0.0, limits.requestsPerMinute);
+    requests.level = requests.capacity;
+    tokens.capacity = std::max(0.0, limits.tokensPerMinute);
+    tokens.level = tokens.capacity;
+    lastRefill = Clock::now();
+}
+
+RemoteRateLimits RemoteRateLimiter::getLimits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    RemoteRateLimits limits;
+    limits.requestsPerMinute = requests.capacity;
+    limits.tokensPerMinute = tokens.capacity;
+    return limits;
+}
+
+std::chrono::milliseconds RemoteRateLimiter::reserve(double estimatedTokens) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point now = Clock::now();
+    refillLocked(now);
+
+    double waitSeconds = std::max(takeLocked(requests, 1.0), takeLocked(tokens, estimatedTokens));
+    if (pausedUntil > now) {
+        waitSeconds = std::max(waitSeconds, std::chrono::duration<double>(pausedUntil - now).count());
+    }
+
+    if (waitSeconds <= 0.0) {
+        return std::chrono::milliseconds(0);
+    }
+
+    ++throttledCount;
+    throttledSeconds += waitSeconds;
+    return std::chrono::milliseconds(static_cast<long long>(std::ceil(waitSeconds * 1000.0)));
+}
+
+void RemoteRateLimiter::settle(double estimatedTokens, double actualTokens) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tokens.capacity <= 0.0) {
+        return;
+    }
+
+    refillLocked(Clock::now());
+    const double estimate = std::min(std::max(0.0, estimatedTokens), tokens.capacity);
+    tokens.level = std::min(tokens.capacity, tokens.level + estimate - std::max(0.0, actualTokens));
+}
+
+void RemoteRateLimiter::pause(std::chrono::milliseconds duration) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pausedUntil = std::max(pausedUntil, Clock::now() + duration);
+}
+
+std::size_t RemoteRateLimiter::getThrottledCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return throttledCount;
+}
+
+double RemoteRateLimiter::getThrottledSeconds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return throttledSeconds;
+}
+
+void RemoteRateLimiter::refillLocked(Clock::time_point now) {
+    const double elapsedMinutes = std::chrono::duration<double, std::ratio<60>>(now - lastRefill).count();
+    lastRefill = now;
+
+    for (Bucket* bucket : {&requests, &tokens}) {
+        if (bucket->capacity > 0.0) {
+            bucket->level = std::min(bucket->capacity, bucket->level + elapsedMinutes * bucket->capacity);
+        }
+    }
+}
+
+// Returns the seconds until the bucket is out of debt again.
+double RemoteRateLimiter::takeLocked(Bucket& bucket, double amount) const {
+    if (bucket.capacity <= 0.0) {
+        return 0.0;
+    }
+
+    // A single request larger than the whole quota would otherwise never fit.
+    bucket.level -= std::min(std::max(0.0, amount), bucket.capacity);
+    return bucket.level >= 0.0 ? 0.0 : -bucket.level / bucket.capacity * 60.0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+// Quotas to stay under, usually those of the gateway's API key. 0 means no limit.
+struct RemoteRateLimits {
+    double requestsPerMinute = 0.0;
+    double tokensPerMinute = 0.0;
+};
+
+// Client-side token buckets for requests/min and tokens/min. Each bucket holds
+// one minute of quota and refills continuously. Callers reserve capacity before
+// sending and are told how long to wait; a bucket may go into debt, so waiting
+// callers are served in the order they reserved instead of racing each other.
+// Throttling here is cheaper than a round trip that ends in a 429.
+//
+// One limiter can be shared between providers that use the same API key.
+class RemoteRateLimiter {
+public:
+    explicit RemoteRateLimiter(const RemoteRateLimits& limits = RemoteRateLimits());
+
+    // Buckets start full after a change of limits.
+    void setLimits(const RemoteRateLimits& limits);
+    RemoteRateLimits getLimits() const;
+
+    // Takes one request and estimatedTokens from the buckets and returns how
+    // long to wait before sending. Zero when the request may go now.
+    std::chrono::milliseconds reserve(double estimatedTokens);
+    // Corrects the token bucket once the server reports actual usage. Pass 0 as
+    // actualTokens to give back a reservation that was never sent.
+    void settle(double estimatedTokens, double actualTokens);
+    // Holds back every reservation until the given time has passed, e.g. after
+    // the server answered 429 with Retry-After.
+    void pause(std::chrono::milliseconds duration);
+
+    // Reservations that had to wait, and the total time they were told to wait.
+    std::size_t getThrottledCount() const;
+    double getThrottledSeconds() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Bucket {
+        double capacity = 0.0; // 0 disables the bucket.
+        double level = 0.0;
+    };
+
+    void refillLocked(Clock::time_point now);
+    double takeLocked(Bucket& bucket, double amount) const;
+
+    mutable std::mutex mutex;
+    Bucket requests;
+    Bucket tokens;
+    Clock::time_point lastRefill;
+    Clock::time_point pausedUntil;
+    std::size_t throttledCount = 0;
+    double throttledSeconds = 0.0;
+};
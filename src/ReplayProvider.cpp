@@ -0,0 +1,227 @@
+#include "ReplayProvider.h"
+
+#include "ofMain.h"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace {
+    // Bounds how long a cancelled replay keeps sleeping.
+    const std::chrono::milliseconds CANCEL_POLL_INTERVAL(20);
+}
+
+ReplayProvider::ReplayProvider() = default;
+
+bool ReplayProvider::setup(const std::string& logPath) {
+    std::vector<InferenceLogRecord> loaded;
+    bool loadedRemote = false;
+    if (!readInferenceLog(logPath, loaded, &loadedRemote)) {
+        return false;
+    }
+
+    if (loaded.empty()) {
+        ofLogError("ReplayProvider") << logPath << " contains no requests.";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    records = std::move(loaded);
+    remote = loadedRemote;
+    recordsByKey.clear();
+    keyCursors.clear();
+    nextIndex = 0;
+
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const InferenceLogRecord& record = records[i];
+        recordsByKey[record.chat ? keyForMessages(record.messages) : keyForPrompt(record.prompt)].push_back(i);
+    }
+
+    ofLogNotice("ReplayProvider") << "Loaded " << records.size() << " requests from " << logPath;
+    return true;
+}
+
+std::string ReplayProvider::generate(const std::string& prompt) {
+    return play(nextRecord(keyForPrompt(prompt)), nullptr, nullptr);
+}
+
+std::string ReplayProvider::generateChat(const std::vector<InferenceChatMessage>& messages) {
+    return play(nextRecord(keyForMessages(messages)), nullptr, nullptr);
+}
+
+std::string ReplayProvider::generateStream(const std::string& prompt,
+                                           InferenceTokenCallback onToken,
+                                           std::shared_ptr<InferenceCancellationToken> cancel) {
+    return play(nextRecord(keyForPrompt(prompt)), onToken, cancel);
+}
+
+std::string ReplayProvider::generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                               InferenceTokenCallback onToken,
+                                               std::shared_ptr<InferenceCancellationToken> cancel) {
+    return play(nextRecord(keyForMessages(messages)), onToken, cancel);
+}
+
+bool ReplayProvider::isRemote() const {
+    return remote;
+}
+
+void ReplayProvider::setTimeScale(double scale) {
+    timeScale = std::max(0.0, scale);
+}
+
+void ReplayProvider::setMatchRequests(bool enabled) {
+    matchRequests = enabled;
+}
+
+std::size_t ReplayProvider::replayTraffic(std::shared_ptr<IInferenceProvider> target,
+                                         std::function<void(std::size_t, const std::string&)> onReply,
+                                         std::shared_ptr<InferenceCancellationToken> cancel) {
+    if (!target) {
+        ofLogError("ReplayProvider") << "No provider to replay the traffic to.";
+        return 0;
+    }
+    if (records.empty()) {
+        ofLogError("ReplayProvider") << "No log loaded. Call setup() with a log path first.";
+        return 0;
+    }
+
+    // Records are written as requests finish, so they are sent by start time.
+    std::vector<std::size_t> order(records.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return records[a].startMicros < records[b].startMicros;
+    });
+
+    std::atomic<std::size_t> answered{0};
+    std::vector<std::thread> requests;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t index : order) {
+        const InferenceLogRecord& record = records[index];
+        // Measured from the start, so a slow request does not delay later arrivals.
+        if (!waitUntil(start + scaled(record.startMicros), cancel)) {
+            break;
+        }
+
+        requests.emplace_back([&record, index, target, onReply, cancel, &answered]() {
+            std::string reply;
+            if (record.chat) {
+                reply = record.streamed ? target->generateChatStream(record.messages, nullptr, cancel)
+                                        : target->generateChat(record.messages);
+            } else {
+                reply = record.streamed ? target->generateStream(record.prompt, nullptr, cancel)
+                                        : target->generate(record.prompt);
+            }
+            if (!reply.empty()) {
+                ++answered;
+            }
+            if (onReply) {
+                onReply(index, reply);
+            }
+        });
+    }
+
+    for (auto& request : requests) {
+        request.join();
+    }
+    return answered;
+}
+
+std::size_t ReplayProvider::getRecordCount() const {
+    return records.size();
+}
+
+const std::vector<InferenceLogRecord>& ReplayProvider::getRecords() const {
+    return records;
+}
+
+const InferenceLogRecord* ReplayProvider::nextRecord(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (records.empty()) {
+        ofLogError("ReplayProvider") << "No log loaded. Call setup() with a log path first.";
+        return nullptr;
+    }
+
+    if (matchRequests) {
+        const auto found = recordsByKey.find(key);
+        if (found != recordsByKey.end()) {
+            // Repeated requests replay their recordings in order, then wrap.
+            std::size_t& cursor = keyCursors[key];
+            const std::size_t index = found->second[cursor % found->second.size()];
+            ++cursor;
+            return &records[index];
+        }
+    }
+
+    const std::size_t index = nextIndex++ % records.size();
+    return &records[index];
+}
+
+std::string ReplayProvider::play(const InferenceLogRecord* record, const InferenceTokenCallback& onToken,
+                                 const std::shared_ptr<InferenceCancellationToken>& cancel) {
+    if (!record) {
+        return "";
+    }
+
+    std::string delivered;
+    std::uint64_t elapsed = 0;
+    for (const auto& token : record->tokens) {
+        if (!waitMicros(token.delayMicros, cancel)) {
+            return delivered;
+        }
+        elapsed += token.delayMicros;
+        delivered += token.text;
+        if (onToken) {
+            onToken(token.text);
+        }
+    }
+
+    if (record->durationMicros > elapsed && !waitMicros(record->durationMicros - elapsed, cancel)) {
+        return delivered;
+    }
+
+    // A reply recorded without streaming still reaches a streaming caller once.
+    if (record->tokens.empty() && !record->response.empty() && onToken) {
+        onToken(record->response);
+    }
+    return record->response;
+}
+
+bool ReplayProvider::waitMicros(std::uint64_t micros, const std::shared_ptr<InferenceCancellationToken>& cancel) const {
+    return waitUntil(std::chrono::steady_clock::now() + scaled(micros), cancel);
+}
+
+std::chrono::steady_clock::duration ReplayProvider::scaled(std::uint64_t micros) const {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::micro>(micros * timeScale.load()));
+}
+
+bool ReplayProvider::waitUntil(std::chrono::steady_clock::time_point until,
+                               const std::shared_ptr<InferenceCancellationToken>& cancel) const {
+    while (true) {
+        if (cancel && cancel->isCancelled()) {
+            return false;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= until) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(until - now, CANCEL_POLL_INTERVAL));
+    }
+}
+
+std::string ReplayProvider::keyForPrompt(const std::string& prompt) {
+    return "p" + prompt;
+}
+
+std::string ReplayProvider::keyForMessages(const std::vector<InferenceChatMessage>& messages) {
+    std::string key = "c";
+    for (const auto& message : messages) {
+        key += message.role;
+        key.push_back('\0');
+        key += message.content;
+        key.push_back('\0');
+    }
+    return key;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+#include "InferenceLog.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Plays back a log written by RecordingProvider. A request that matches a
+// recorded one gets that reply, with the same time to first token, gaps between
+// tokens and failures. Requests without a match take the recorded ones in turn,
+// so any traffic can be driven through the UI or RoutingProvider offline.
+// replayTraffic() re-sends the recorded requests themselves, at their
+// recorded arrival times, to reproduce the load on another provider.
+class ReplayProvider : public IInferenceProvider {
+public:
+    ReplayProvider();
+
+    // Loads the log at logPath.
+    bool setup(const std::string& logPath) override;
+    std::string generate(const std::string& prompt) override;
+    std::string generateChat(const std::vector<InferenceChatMessage>& messages) override;
+    std::string generateStream(const std::string& prompt,
+                               InferenceTokenCallback onToken,
+                               std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    std::string generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                   InferenceTokenCallback onToken,
+                                   std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    // As recorded: true for logs taken from a remote provider.
+    bool isRemote() const override;
+
+    // Multiplies every recorded delay: 1 plays back in real time, 0.5 twice as
+    // fast, 0 without any waiting.
+    void setTimeScale(double scale);
+    // When false, requests always take the next record in turn.
+    void setMatchRequests(bool enabled);
+
+    // Sends every recorded request to target at its recorded start time,
+    // scaled by the time scale, each on its own thread and streamed if it was
+    // recorded streamed. onReply, if set, gets the record index and reply on
+    // that thread. Blocks until every request has returned; cancel stops
+    // sending and is passed on to the requests. Returns the non-empty replies.
+    std::size_t replayTraffic(std::shared_ptr<IInferenceProvider> target,
+                              std::function<void(std::size_t, const std::string&)> onReply = nullptr,
+                              std::shared_ptr<InferenceCancellationToken> cancel = nullptr);
+
+    std::size_t getRecordCount() const;
+    const std::vector<InferenceLogRecord>& getRecords() const;
+
+private:
+    const InferenceLogRecord* nextRecord(const std::string& key);
+    std::string play(const InferenceLogRecord* record, const InferenceTokenCallback& onToken,
+                     const std::shared_ptr<InferenceCancellationToken>& cancel);
+    bool waitMicros(std::uint64_t micros, const std::shared_ptr<InferenceCancellationToken>& cancel) const;
+    bool waitUntil(std::chrono::steady_clock::time_point until, const std::shared_ptr<InferenceCancellationToken>& cancel) const;
+    std::chrono::steady_clock::duration scaled(std::uint64_t micros) const;
+
+    static std::string keyForPrompt(const std::string& prompt);
+    static std::string keyForMessages(const std::vector<InferenceChatMessage>& messages);
+
+    std::vector<InferenceLogRecord> records;
+    bool remote = false;
+    // Read by request threads, so they may change while requests run.
+    std::atomic<double> timeScale{1.0};
+    std::atomic<bool> matchRequests{true};
+
+    std::mutex mutex;
+    // Records by request, and how many of each have been replayed.
+    std::map<std::string, std::vector<std::size_t>> recordsByKey;
+    std::map<std::string, std::size_t> keyCursors;
+    std::size_t nextIndex = 0;
+};
@@ -0,0 +1,450 @@
+#include "RoutingProvider.h"
+
+#include "ofMain.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <thread>
+
+namespace {
+    // Bounds how long a cancelled request can sit in a backend's queue unnoticed.
+    const std::chrono::milliseconds CANCEL_POLL_INTERVAL(20);
+
+    std::size_t chatLength(const std::vector<InferenceChatMessage>& messages) {
+        std::size_t length = 0;
+        for (const auto& message : messages) {
+            length += message.content.size();
+        }
+        return length;
+    }
+}
+
+// Shared between a racing request and its contender threads. Losers may still
+// be winding down after the request has returned.
+struct RoutingProvider::RaceState {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::shared_ptr<InferenceCancellationToken>> cancels;
+    std::deque<std::string> pending;
+    int winner = -1;
+    bool winnerDone = false;
+    std::string winnerReply;
+    std::size_t finished = 0;
+};
+
+RoutingProvider::RoutingProvider() = default;
+
+RoutingProvider::~RoutingProvider() {
+    std::unique_lock<std::mutex> lock(mutex);
+    contendersDone.wait(lock, [this]() { return activeContenders == 0; });
+}
+
+void RoutingProvider::addProvider(const std::string& name, std::shared_ptr<IInferenceProvider> provider, std::size_t maxConcurrent) {
+    if (!provider) {
+        ofLogError("RoutingProvider") << "Cannot add empty provider " << name;
+        return;
+    }
+
+    std::unique_ptr<Route> route(new Route());
+    route->name = name;
+    route->provider = provider;
+    route->maxConcurrent = std::max<std::size_t>(1, maxConcurrent);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    routes.push_back(std::move(route));
+}
+
+bool RoutingProvider::setup(const std::string&) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (routes.empty()) {
+        ofLogError("RoutingProvider") << "No providers added. Call addProvider() first.";
+        return false;
+    }
+    return true;
+}
+
+std::string RoutingProvider::generate(const std::string& prompt) {
+    return dispatch([prompt](IInferenceProvider& provider, InferenceTokenCallback onToken, std::shared_ptr<InferenceCancellationToken> cancel) {
+        return provider.generateStream(prompt, onToken, cancel);
+    }, prompt.size(), false, nullptr, nullptr);
+}
+
+std::string RoutingProvider::generateChat(const std::vector<InferenceChatMessage>& messages) {
+    return dispatch([messages](IInferenceProvider& provider, InferenceTokenCallback onToken, std::shared_ptr<InferenceCancellationToken> cancel) {
+        return provider.generateChatStream(messages, onToken, cancel);
+    }, chatLength(messages), false, nullptr, nullptr);
+}
+
+std::string RoutingProvider::generateStream(const std::string& prompt,
+                                            InferenceTokenCallback onToken,
+                                            std::shared_ptr<InferenceCancellationToken> cancel) {
+    return dispatch([prompt](IInferenceProvider& provider, InferenceTokenCallback routeToken, std::shared_ptr<InferenceCancellationToken> routeCancel) {
+        return provider.generateStream(prompt, routeToken, routeCancel);
+    }, prompt.size(), true, onToken, cancel);
+}
+
+std::string RoutingProvider::generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                                InferenceTokenCallback onToken,
+                                                std::shared_ptr<InferenceCancellationToken> cancel) {
+    return dispatch([messages](IInferenceProvider& provider, InferenceTokenCallback routeToken, std::shared_ptr<InferenceCancellationToken> routeCancel) {
+        return provider.generateChatStream(messages, routeToken, routeCancel);
+    }, chatLength(messages), true, onToken, cancel);
+}
+
+bool RoutingProvider::isRemote() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (routes.empty()) {
+        return false;
+    }
+
+    for (const auto& route : routes) {
+        if (!route->provider->isRemote()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+long long RoutingProvider::getCompletionTokenCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    long long total = -1;
+    for (const auto& route : routes) {
+        const long long count = route->provider->getCompletionTokenCount();
+        if (count >= 0) {
+            total = std::max(0LL, total) + count;
+        }
+    }
+    return total;
+}
+
+void RoutingProvider::setSmoothing(double alpha) {
+    std::lock_guard<std::mutex> lock(mutex);
+    smoothing = std::min(1.0, std::max(0.01, alpha));
+}
+
+void RoutingProvider::setFailureCooldown(float seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    failureCooldown = std::chrono::milliseconds(static_cast<long long>(std::max(0.0f, seconds) * 1000.0f));
+}
+
+void RoutingProvider::setRaceMode(bool enabled, std::size_t maxPromptLength) {
+    std::lock_guard<std::mutex> lock(mutex);
+    raceMode = enabled;
+    maxRacePromptLength = maxPromptLength;
+}
+
+std::vector<RoutingRouteStats> RoutingProvider::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point now = Clock::now();
+
+    std::vector<RoutingRouteStats> stats;
+    for (const auto& route : routes) {
+        RoutingRouteStats entry;
+        entry.name = route->name;
+        entry.remote = route->provider->isRemote();
+        entry.timeToFirstTokenSeconds = route->timeToFirstToken;
+        entry.serviceSeconds = route->service;
+        entry.tokensPerSecond = route->tokensPerSecond;
+        entry.running = route->running;
+        entry.waiting = route->waiting;
+        entry.completed = route->completed;
+        entry.failures = route->failures;
+        entry.healthy = isHealthyLocked(*route, now);
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+std::string RoutingProvider::getLastRouteName() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastRouteName;
+}
+
+std::string RoutingProvider::dispatch(const Runner& runner, std::size_t promptLength, bool streaming,
+                                      const InferenceTokenCallback& onToken,
+                                      const std::shared_ptr<InferenceCancellationToken>& cancel) {
+    std::vector<Route*> tried;
+
+    std::vector<Route*> contenders;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        contenders = raceContendersLocked(promptLength);
+    }
+    if (!contenders.empty()) {
+        bool settled = false;
+        const std::string reply = race(contenders, runner, onToken, cancel, settled);
+        if (settled) {
+            return reply;
+        }
+        // Every contender failed; fall back to the backends that were busy.
+        tried = contenders;
+    }
+
+    while (true) {
+        Route* route = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            route = chooseRouteLocked(tried, streaming);
+            if (!route) {
+                ofLogError("RoutingProvider") << (routes.empty() ? "No providers added." : "All providers failed.");
+                return "";
+            }
+
+            // Wait for a free slot on the chosen backend.
+            ++route->waiting;
+            while (route->running >= route->maxConcurrent) {
+                if (cancel && cancel->isCancelled()) {
+                    --route->waiting;
+                    return "";
+                }
+                slotFreed.wait_for(lock, CANCEL_POLL_INTERVAL);
+            }
+            --route->waiting;
+            ++route->running;
+        }
+
+        Attempt attempt;
+        attempt.start = Clock::now();
+
+        const std::string reply = runner(*route->provider, [&](const std::string& piece) {
+            if (attempt.pieces++ == 0) {
+                attempt.firstToken = Clock::now();
+            }
+            if (onToken) {
+                onToken(piece);
+            }
+        }, cancel);
+
+        attempt.end = Clock::now();
+        const bool cancelled = cancel && cancel->isCancelled();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --route->running;
+            slotFreed.notify_all();
+
+            if (finishAttemptLocked(*route, attempt, reply, cancelled) || cancelled) {
+                return reply;
+            }
+        }
+
+        tried.push_back(route);
+
+        // Pieces the caller has already seen cannot be replayed from another backend.
+        if (attempt.pieces > 0) {
+            return reply;
+        }
+
+        ofLogWarning("RoutingProvider") << "Provider " << route->name << " failed, trying the next one.";
+    }
+}
+
+std::string RoutingProvider::race(const std::vector<Route*>& contenders, const Runner& runner,
+                                  const InferenceTokenCallback& onToken,
+                                  const std::shared_ptr<InferenceCancellationToken>& cancel, bool& settled) {
+    auto state = std::make_shared<RaceState>();
+    for (std::size_t i = 0; i < contenders.size(); ++i) {
+        state->cancels.push_back(std::make_shared<InferenceCancellationToken>());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        activeContenders += contenders.size();
+    }
+    for (std::size_t i = 0; i < contenders.size(); ++i) {
+        std::thread(&RoutingProvider::runContender, this, state, i, contenders[i], runner).detach();
+    }
+
+    // Tokens are handed over to the calling thread so callbacks run where the
+    // caller expects them, whichever backend wins.
+    std::unique_lock<std::mutex> lock(state->mutex);
+    bool cancelForwarded = false;
+    while (true) {
+        while (!state->pending.empty()) {
+            const std::string piece = std::move(state->pending.front());
+            state->pending.pop_front();
+            lock.unlock();
+            if (onToken) {
+                onToken(piece);
+            }
+            lock.lock();
+        }
+
+        if (state->winnerDone || state->finished == contenders.size()) {
+            break;
+        }
+
+        if (!cancelForwarded && cancel && cancel->isCancelled()) {
+            for (const auto& contenderCancel : state->cancels) {
+                contenderCancel->cancel();
+            }
+            cancelForwarded = true;
+        }
+
+        state->changed.wait_for(lock, CANCEL_POLL_INTERVAL);
+    }
+
+    // Once a winner has delivered tokens, or the caller gave up, there is
+    // nothing left to fail over.
+    settled = state->winner >= 0 || cancelForwarded;
+    if (!settled) {
+        ofLogWarning("RoutingProvider") << "Every racing provider failed.";
+    }
+    return state->winnerReply;
+}
+
+void RoutingProvider::runContender(std::shared_ptr<RaceState> state, std::size_t index, Route* route, Runner runner) {
+    const std::shared_ptr<InferenceCancellationToken> cancel = state->cancels[index];
+
+    Attempt attempt;
+    attempt.start = Clock::now();
+
+    const std::string reply = runner(*route->provider, [&](const std::string& piece) {
+        if (attempt.pieces++ == 0) {
+            attempt.firstToken = Clock::now();
+        }
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->winner < 0) {
+            state->winner = static_cast<int>(index);
+            for (std::size_t i = 0; i < state->cancels.size(); ++i) {
+                if (i != index) {
+                    state->cancels[i]->cancel();
+                }
+            }
+        }
+        if (state->winner == static_cast<int>(index)) {
+            state->pending.push_back(piece);
+            state->changed.notify_all();
+        }
+    }, cancel);
+
+    attempt.end = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --route->running;
+        slotFreed.notify_all();
+        finishAttemptLocked(*route, attempt, reply, cancel->isCancelled());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        ++state->finished;
+        if (state->winner == static_cast<int>(index)) {
+            state->winnerDone = true;
+            state->winnerReply = reply;
+        }
+        state->changed.notify_all();
+    }
+
+    // Last access to this object: the destructor waits for the count to drop.
+    std::lock_guard<std::mutex> lock(mutex);
+    --activeContenders;
+    contendersDone.notify_all();
+}
+
+std::vector<RoutingProvider::Route*> RoutingProvider::raceContendersLocked(std::size_t promptLength) {
+    std::vector<Route*> contenders;
+    if (!raceMode || (maxRacePromptLength > 0 && promptLength > maxRacePromptLength)) {
+        return contenders;
+    }
+
+    const Clock::time_point now = Clock::now();
+    for (const auto& route : routes) {
+        if (route->running < route->maxConcurrent && isHealthyLocked(*route, now)) {
+            contenders.push_back(route.get());
+        }
+    }
+
+    // A race needs at least two runners; otherwise route normally.
+    if (contenders.size() < 2) {
+        contenders.clear();
+        return contenders;
+    }
+
+    for (Route* route : contenders) {
+        ++route->running;
+    }
+    return contenders;
+}
+
+bool RoutingProvider::finishAttemptLocked(Route& route, const Attempt& attempt, const std::string& reply, bool cancelled) {
+    if (cancelled) {
+        return false;
+    }
+
+    if (reply.empty()) {
+        ++route.failures;
+        route.failing = true;
+        route.lastFailure = attempt.end;
+        return false;
+    }
+
+    const double total = std::chrono::duration<double>(attempt.end - attempt.start).count();
+    const double firstTokenSeconds = attempt.pieces > 0
+        ? std::chrono::duration<double>(attempt.firstToken - attempt.start).count()
+        : total;
+    blend(route.timeToFirstToken, firstTokenSeconds);
+    blend(route.service, total);
+
+    const double generationSeconds = std::chrono::duration<double>(attempt.end - attempt.firstToken).count();
+    if (attempt.pieces > 1 && generationSeconds > 0.0) {
+        blend(route.tokensPerSecond, static_cast<double>(attempt.pieces - 1) / generationSeconds);
+    }
+
+    ++route.completed;
+    route.failing = false;
+    lastRouteName = route.name;
+    return true;
+}
+
+RoutingProvider::Route* RoutingProvider::chooseRouteLocked(const std::vector<Route*>& tried, bool streaming) {
+    const Clock::time_point now = Clock::now();
+    Route* best = nullptr;
+    double bestPrediction = std::numeric_limits<double>::max();
+    bool bestHealthy = false;
+
+    for (const auto& entry : routes) {
+        Route* route = entry.get();
+        if (std::find(tried.begin(), tried.end(), route) != tried.end()) {
+            continue;
+        }
+
+        // Healthy backends always win over ones still cooling down after a failure.
+        const bool healthy = isHealthyLocked(*route, now);
+        const double prediction = predictLocked(*route, streaming);
+        if (!best || (healthy && !bestHealthy) || (healthy == bestHealthy && prediction < bestPrediction)) {
+            best = route;
+            bestPrediction = prediction;
+            bestHealthy = healthy;
+        }
+    }
+
+    return best;
+}
+
+double RoutingProvider::predictLocked(const Route& route, bool streaming) const {
+    if (route.service < 0.0) {
+        return 0.0; // Untried backends go first so every one gets measured.
+    }
+
+    // Requests already admitted drain maxConcurrent at a time.
+    const std::size_t ahead = route.running + route.waiting;
+    double queueWait = 0.0;
+    if (ahead >= route.maxConcurrent) {
+        queueWait = static_cast<double>(ahead - route.maxConcurrent + 1) / route.maxConcurrent * route.service;
+    }
+
+    // Streaming callers care about the first token, blocking ones about the whole reply.
+    return queueWait + (streaming ? route.timeToFirstToken : route.service);
+}
+
+bool RoutingProvider::isHealthyLocked(const Route& route, Clock::time_point now) const {
+    return !route.failing || now - route.lastFailure >= failureCooldown;
+}
+
+void RoutingProvider::blend(double& average, double sample) const {
+    average = average < 0.0 ? sample : average + smoothing * (sample - average);
+}
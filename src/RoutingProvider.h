@@ -0,0 +1,128 @@
+#pragma once
+
+#include "IInferenceProvider.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Snapshot of what the router has learned about one backend.
+struct RoutingRouteStats {
+    std::string name;
+    bool remote = false;
+    // Moving averages; -1 until the backend has answered at least once.
+    double timeToFirstTokenSeconds = -1.0;
+    double serviceSeconds = -1.0;
+    double tokensPerSecond = -1.0;
+    std::size_t running = 0;
+    std::size_t waiting = 0;
+    std::size_t completed = 0;
+    std::size_t failures = 0;
+    bool healthy = true;
+};
+
+// Provider that spreads requests over several backends, e.g. a local model and
+// one or more remote gateways. It keeps exponentially weighted averages of each
+// backend's time to first token, total service time and token throughput. Each
+// request goes to the backend predicted to answer first, given the work already
+// queued there. A backend that fails is skipped for a cooldown period and the
+// request fails over to the next best one.
+//
+// In race mode a request is started on every healthy backend with a free slot.
+// The first backend to produce a token wins; the others are cancelled.
+class RoutingProvider : public IInferenceProvider {
+public:
+    RoutingProvider();
+    // Waits for cancelled race losers to wind down.
+    ~RoutingProvider();
+
+    // Adds a backend that is already set up. maxConcurrent is how many requests
+    // it may run at once; use 1 for a local model, more for remote gateways.
+    void addProvider(const std::string& name, std::shared_ptr<IInferenceProvider> provider, std::size_t maxConcurrent = 1);
+
+    // Backends are set up individually before addProvider(); this only checks
+    // that at least one has been added.
+    bool setup(const std::string& modelOrUrl) override;
+    std::string generate(const std::string& prompt) override;
+    std::string generateChat(const std::vector<InferenceChatMessage>& messages) override;
+    std::string generateStream(const std::string& prompt,
+                               InferenceTokenCallback onToken,
+                               std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    std::string generateChatStream(const std::vector<InferenceChatMessage>& messages,
+                                   InferenceTokenCallback onToken,
+                                   std::shared_ptr<InferenceCancellationToken> cancel = nullptr) override;
+    // True only when every backend is remote.
+    bool isRemote() const override;
+    // Sum over the backends that can count tokens; -1 if none can.
+    long long getCompletionTokenCount() const override;
+
+    // Weight of the newest sample in the moving averages (0..1, default 0.2).
+    void setSmoothing(double alpha);
+    // How long a failed backend is avoided while others are available.
+    void setFailureCooldown(float seconds);
+    // Races backends against each other for prompts up to maxPromptLength
+    // characters (0 = any length). Longer prompts are routed normally.
+    void setRaceMode(bool enabled, std::size_t maxPromptLength = 0);
+
+    std::vector<RoutingRouteStats> getStats() const;
+    // Name of the backend that served the most recent successful request.
+    std::string getLastRouteName() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using Runner = std::function<std::string(IInferenceProvider&, InferenceTokenCallback, std::shared_ptr<InferenceCancellationToken>)>;
+
+    struct Route {
+        std::string name;
+        std::shared_ptr<IInferenceProvider> provider;
+        std::size_t maxConcurrent = 1;
+        std::size_t running = 0;
+        std::size_t waiting = 0;
+        double timeToFirstToken = -1.0;
+        double service = -1.0;
+        double tokensPerSecond = -1.0;
+        std::size_t completed = 0;
+        std::size_t failures = 0;
+        bool failing = false;
+        Clock::time_point lastFailure;
+    };
+
+    struct Attempt {
+        Clock::time_point start;
+        Clock::time_point firstToken;
+        Clock::time_point end;
+        std::size_t pieces = 0;
+    };
+
+    struct RaceState;
+
+    std::string dispatch(const Runner& runner, std::size_t promptLength, bool streaming,
+                         const InferenceTokenCallback& onToken,
+                         const std::shared_ptr<InferenceCancellationToken>& cancel);
+    std::string race(const std::vector<Route*>& contenders, const Runner& runner,
+                     const InferenceTokenCallback& onToken,
+                     const std::shared_ptr<InferenceCancellationToken>& cancel, bool& settled);
+    void runContender(std::shared_ptr<RaceState> state, std::size_t index, Route* route, Runner runner);
+    std::vector<Route*> raceContendersLocked(std::size_t promptLength);
+    bool finishAttemptLocked(Route& route, const Attempt& attempt, const std::string& reply, bool cancelled);
+    Route* chooseRouteLocked(const std::vector<Route*>& tried, bool streaming);
+    double predictLocked(const Route& route, bool streaming) const;
+    bool isHealthyLocked(const Route& route, Clock::time_point now) const;
+    void blend(double& average, double sample) const;
+
+    mutable std::mutex mutex;
+    std::condition_variable slotFreed;
+    std::vector<std::unique_ptr<Route>> routes;
+    double smoothing = 0.2;
+    std::chrono::milliseconds failureCooldown{30000};
+    bool raceMode = false;
+    std::size_t maxRacePromptLength = 0;
+    std::size_t activeContenders = 0;
+    std::condition_variable contendersDone;
+    std::string lastRouteName;
+};
@@ -0,0 +1,246 @@
+#include "SharedTokenRing.h"
+
+#include "ofMain.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const std::uint32_t RING_MAGIC = 0x4F4C5252; // "ORRL"
+    // Length, request id and type in front of every record.
+    const std::size_t RECORD_HEADER_SIZE = 9;
+    const std::size_t CACHE_LINE = 64;
+}
+
+// Lives at the start of the mapping. The two positions sit on separate cache
+// lines so producer and consumer do not invalidate each other's line.
+struct SharedTokenRing::Header {
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> writePosition;
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> readPosition;
+    alignas(CACHE_LINE) std::uint32_t magic;
+    std::uint32_t capacity;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared ring positions must be lock-free atomics.");
+
+SharedTokenRing::SharedTokenRing() = default;
+
+SharedTokenRing::~SharedTokenRing() {
+    close();
+}
+
+#ifndef _WIN32
+
+bool SharedTokenRing::create(const std::string& ringName, std::size_t requestedCapacity) {
+    close();
+
+    // A power of two lets positions wrap with a mask.
+    std::size_t ringCapacity = 4096;
+    while (ringCapacity < requestedCapacity && ringCapacity < (std::size_t(1) << 30)) {
+        ringCapacity <<= 1;
+    }
+
+    const int fd = shm_open(ringName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        ofLogError("SharedTokenRing") << "Cannot create shared memory " << ringName << ": " << std::strerror(errno);
+        return false;
+    }
+
+    const std::size_t size = sizeof(Header) + ringCapacity;
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        ofLogError("SharedTokenRing") << "Cannot map shared memory " << ringName << ": " << std::strerror(errno);
+        shm_unlink(ringName.c_str());
+        return false;
+    }
+
+    header = new (mapping) Header();
+    header->writePosition.store(0);
+    header->readPosition.store(0);
+    header->capacity = static_cast<std::uint32_t>(ringCapacity);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = RING_MAGIC;
+
+    data = static_cast<unsigned char*>(mapping) + sizeof(Header);
+    mappedSize = size;
+    capacity = ringCapacity;
+    name = ringName;
+    owner = true;
+    return true;
+}
+
+bool SharedTokenRing::open(const std::string& ringName) {
+    close();
+
+    const int fd = shm_open(ringName.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        ofLogError("SharedTokenRing") << "Cannot open shared memory " << ringName << ": " << std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) > sizeof(Header)) {
+        mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        ofLogError("SharedTokenRing") << "Cannot map shared memory " << ringName;
+        return false;
+    }
+
+    Header* mappedHeader = static_cast<Header*>(mapping);
+    if (mappedHeader->magic != RING_MAGIC || sizeof(Header) + mappedHeader->capacity > static_cast<std::size_t>(info.st_size)) {
+        ofLogError("SharedTokenRing") << ringName << " is not a token ring.";
+        munmap(mapping, static_cast<std::size_t>(info.st_size));
+        return false;
+    }
+
+    header = mappedHeader;
+    data = static_cast<unsigned char*>(mapping) + sizeof(Header);
+    mappedSize = static_cast<std::size_t>(info.st_size);
+    capacity = header->capacity;
+    name = ringName;
+    owner = false;
+    return true;
+}
+
+void SharedTokenRing::close() {
+    if (header) {
+        munmap(header, mappedSize);
+        if (owner) {
+            shm_unlink(name.c_str());
+        }
+    }
+    header = nullptr;
+    data = nullptr;
+    mappedSize = 0;
+    capacity = 0;
+    owner = false;
+}
+
+std::string SharedTokenRing::makeUniqueName() {
+    static std::atomic<unsigned int> counter{0};
+    // Short enough for the 31-character limit on macOS.
+    return "/ofxllama-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+}
+
+#else
+
+bool SharedTokenRing::create(const std::string&, std::size_t) {
+    ofLogError("SharedTokenRing") << "Shared memory rings are not supported on Windows.";
+    return false;
+}
+
+bool SharedTokenRing::open(const std::string&) {
+    ofLogError("SharedTokenRing") << "Shared memory rings are not supported on Windows.";
+    return false;
+}
+
+void SharedTokenRing::close() {
+}
+
+std::string SharedTokenRing::makeUniqueName() {
+    return "";
+}
+
+#endif
+
+bool SharedTokenRing::isOpen() const {
+    return header != nullptr;
+}
+
+const std::string& SharedTokenRing::getName() const {
+    return name;
+}
+
+std::size_t SharedTokenRing::getCapacity() const {
+    return capacity;
+}
+
+std::size_t SharedTokenRing::getMaxTextSize() const {
+    return capacity > RECORD_HEADER_SIZE ? capacity - RECORD_HEADER_SIZE : 0;
+}
+
+bool SharedTokenRing::tryWrite(std::uint32_t requestId, RecordType type, const std::string& text) {
+    if (!header) {
+        return false;
+    }
+
+    const std::size_t length = RECORD_HEADER_SIZE + text.size();
+    if (length > capacity) {
+        ofLogError("SharedTokenRing") << "Record of " << length << " bytes does not fit a ring of " << capacity;
+        return false;
+    }
+
+    const std::uint64_t write = header->writePosition.load(std::memory_order_relaxed);
+    const std::uint64_t read = header->readPosition.load(std::memory_order_acquire);
+    if (capacity - static_cast<std::size_t>(write - read) < length) {
+        return false;
+    }
+
+    const std::uint32_t textLength = static_cast<std::uint32_t>(text.size());
+    const std::uint8_t recordType = type;
+    copyIn(write, &textLength, 4);
+    copyIn(write + 4, &requestId, 4);
+    copyIn(write + 8, &recordType, 1);
+    copyIn(write + RECORD_HEADER_SIZE, text.data(), text.size());
+
+    header->writePosition.store(write + length, std::memory_order_release);
+    return true;
+}
+
+bool SharedTokenRing::tryRead(Record& record) {
+    if (!header) {
+        return false;
+    }
+
+    const std::uint64_t read = header->readPosition.load(std::memory_order_relaxed);
+    const std::uint64_t write = header->writePosition.load(std::memory_order_acquire);
+    if (write - read < RECORD_HEADER_SIZE) {
+        return false;
+    }
+
+    std::uint32_t textLength = 0;
+    std::uint8_t recordType = 0;
+    copyOut(read, &textLength, 4);
+    copyOut(read + 4, &record.requestId, 4);
+    copyOut(read + 8, &recordType, 1);
+    if (RECORD_HEADER_SIZE + textLength > write - read) {
+        return false; // Cannot happen with a well-behaved producer.
+    }
+
+    record.type = static_cast<RecordType>(recordType);
+    record.text.resize(textLength);
+    copyOut(read + RECORD_HEADER_SIZE, &record.text[0], textLength);
+
+    header->readPosition.store(read + RECORD_HEADER_SIZE + textLength, std::memory_order_release);
+    return true;
+}
+
+void SharedTokenRing::copyIn(std::uint64_t position, const void* source, std::size_t length) {
+    const std::size_t offset = static_cast<std::size_t>(position & (capacity - 1));
+    const std::size_t first = std::min(length, capacity - offset);
+    std::memcpy(data + offset, source, first);
+    std::memcpy(data, static_cast<const unsigned char*>(source) + first, length - first);
+}
+
+void SharedTokenRing::copyOut(std::uint64_t position, void* destination, std::size_t length) const {
+    const std::size_t offset = static_cast<std::size_t>(position & (capacity - 1));
+    const std::size_t first = std::min(length, capacity - offset);
+    std::memcpy(destination, data + offset, first);
+    std::memcpy(static_cast<unsigned char*>(destination) + first, data, length - first);
+}
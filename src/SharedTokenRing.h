@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Single-producer, single-consumer ring of token records in POSIX shared
+// memory. The producer copies each piece of text straight into the mapping
+// and the consumer reads it from there, so streaming a token costs no system
+// call. Positions are advanced with atomics only. Not available on Windows.
+class SharedTokenRing {
+public:
+    enum RecordType : std::uint8_t {
+        TOKEN = 1,  // A piece of the reply.
+        END = 2,    // The request finished; text is empty.
+        FAILED = 3  // The request failed; text is the reason.
+    };
+
+    struct Record {
+        std::uint32_t requestId = 0;
+        RecordType type = TOKEN;
+        std::string text;
+    };
+
+    SharedTokenRing();
+    ~SharedTokenRing();
+
+    SharedTokenRing(const SharedTokenRing&) = delete;
+    SharedTokenRing& operator=(const SharedTokenRing&) = delete;
+
+    // Creates a ring of at least capacity bytes under name (e.g. "/myring").
+    // The creator removes the name again on close().
+    bool create(const std::string& name, std::size_t capacity = 1 << 20);
+    // Maps a ring created by another process.
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const;
+
+    const std::string& getName() const;
+    std::size_t getCapacity() const;
+    // Longest text a single record can carry.
+    std::size_t getMaxTextSize() const;
+
+    // Producer side. False when the ring has no room for the record yet.
+    bool tryWrite(std::uint32_t requestId, RecordType type, const std::string& text = std::string());
+    // Consumer side. False when no complete record is waiting.
+    bool tryRead(Record& record);
+
+    // Unique name for a new ring owned by this process.
+    static std::string makeUniqueName();
+
+private:
+    struct Header;
+
+    void copyIn(std::uint64_t position, const void* data, std::size_t length);
+    void copyOut(std::uint64_t position, void* data, std::size_t length) const;
+
+    std::string name;
+    bool owner = false;
+    Header* header = nullptr;
+    unsigned char* data = nullptr;
+    std::size_t mappedSize = 0;
+    std::size_t capacity = 0;
+};
@@ -0,0 +1,343 @@
+#include "TokenBroadcastReceiver.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "ofMain.h"
+
+namespace {
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    const SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+
+    void closeSocket(SocketHandle socket) {
+        closesocket(socket);
+    }
+#else
+    using SocketHandle = int;
+    const SocketHandle INVALID_SOCKET_HANDLE = -1;
+
+    void closeSocket(SocketHandle socket) {
+        ::close(socket);
+    }
+#endif
+
+    // Bounds how late a gap is noticed and how long stop() waits.
+    const long POLL_INTERVAL_MICROSECONDS = 5000;
+    const std::size_t MAX_DATAGRAM_BYTES = 64 * 1024;
+
+    SocketHandle toHandle(std::intptr_t socket) {
+        return static_cast<SocketHandle>(socket);
+    }
+}
+
+TokenBroadcastReceiver::TokenBroadcastReceiver()
+: socket(static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE))
+, running(false) {
+}
+
+TokenBroadcastReceiver::~TokenBroadcastReceiver() {
+    stop();
+}
+
+bool TokenBroadcastReceiver::start(const std::string& address, int port, const std::string& interfaceAddress) {
+    if (running) {
+        ofLogWarning("TokenBroadcastReceiver") << "Receiver is already running.";
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        ofLogError("TokenBroadcastReceiver") << "WSAStartup failed.";
+        return false;
+    }
+#endif
+
+    in_addr group = {};
+    if (inet_pton(AF_INET, address.c_str(), &group) != 1 || port <= 0 || port > 65535) {
+        ofLogError("TokenBroadcastReceiver") << "Invalid address " << address << ":" << port;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    SocketHandle handle = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET_HANDLE) {
+        ofLogError("TokenBroadcastReceiver") << "Cannot create UDP socket.";
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    // Several receivers on one machine, e.g. one per projector output, can
+    // share the port. Each gets every multicast packet; unicast reaches one.
+    int reuse = 1;
+    setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(handle, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+#endif
+
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (::bind(handle, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0) {
+        ofLogError("TokenBroadcastReceiver") << "Cannot listen on port " << port;
+        closeSocket(handle);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    const bool multicast = (ntohl(group.s_addr) >> 28) == 0xE;
+    if (multicast) {
+        ip_mreq membership = {};
+        membership.imr_multiaddr = group;
+        membership.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (!interfaceAddress.empty() && inet_pton(AF_INET, interfaceAddress.c_str(), &membership.imr_interface) != 1) {
+            ofLogWarning("TokenBroadcastReceiver") << "Invalid interface " << interfaceAddress << ", using the default.";
+            membership.imr_interface.s_addr = htonl(INADDR_ANY);
+        }
+        if (setsockopt(handle, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char*>(&membership), sizeof(membership)) != 0) {
+            ofLogError("TokenBroadcastReceiver") << "Cannot join multicast group " << address;
+            closeSocket(handle);
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return false;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hasSession = false;
+        pending.clear();
+        ready.clear();
+        text.clear();
+        pieces.clear();
+        generating = false;
+        lastLostSequence = 0;
+        stats = TokenBroadcastStats();
+    }
+
+    socket = static_cast<std::intptr_t>(handle);
+    running = true;
+    receiveThread = std::thread(&TokenBroadcastReceiver::receiveLoop, this);
+
+    ofLogNotice("TokenBroadcastReceiver") << "Receiving tokens on " << address << ":" << port;
+    return true;
+}
+
+void TokenBroadcastReceiver::stop() {
+    if (!running) {
+        return;
+    }
+
+    running = false;
+    if (receiveThread.joinable()) {
+        receiveThread.join();
+    }
+    closeSocket(toHandle(socket));
+    socket = static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE);
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool TokenBroadcastReceiver::isRunning() const {
+    return running;
+}
+
+void TokenBroadcastReceiver::setReorderWindow(float seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    reorderWindow = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(std::max(0.0f, seconds)));
+}
+
+std::vector<TokenBroadcastEvent> TokenBroadcastReceiver::poll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<TokenBroadcastEvent> events;
+    events.swap(ready);
+    return events;
+}
+
+std::string TokenBroadcastReceiver::getText() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return text;
+}
+
+bool TokenBroadcastReceiver::isGenerating() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return generating;
+}
+
+TokenBroadcastStats TokenBroadcastReceiver::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void TokenBroadcastReceiver::receiveLoop() {
+    std::vector<char> buffer(MAX_DATAGRAM_BYTES);
+    std::vector<TokenBroadcastEvent> events;
+    const SocketHandle handle = toHandle(socket);
+
+    while (running) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(handle, &readable);
+        timeval timeout = {0, POLL_INTERVAL_MICROSECONDS};
+        const int result = ::select(static_cast<int>(handle) + 1, &readable, nullptr, nullptr, &timeout);
+
+        events.clear();
+        std::int32_t eventSession = 0;
+        bool decoded = false;
+        if (result > 0) {
+            const auto received = ::recvfrom(handle, buffer.data(), static_cast<int>(buffer.size()), 0, nullptr, nullptr);
+            if (received > 0) {
+                decoded = TokenBroadcaster::decodePacket(buffer.data(), static_cast<std::size_t>(received), eventSession, events);
+            }
+        }
+
+        const Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (decoded) {
+            ++stats.packets;
+            for (TokenBroadcastEvent& event : events) {
+                acceptLocked(eventSession, event, now);
+            }
+        }
+        expireLocked(now);
+    }
+}
+
+void TokenBroadcastReceiver::acceptLocked(std::int32_t eventSession, TokenBroadcastEvent& event, Clock::time_point now) {
+    if (!hasSession || eventSession != session) {
+        // A new or restarted sender. Whatever came before it is no longer coming.
+        hasSession = true;
+        session = eventSession;
+        nextSequence = event.type == TokenBroadcastEvent::SYNC ? event.sequence + 1 : event.sequence;
+        pending.clear();
+        if (event.type != TokenBroadcastEvent::BEGIN) {
+            // Joined mid-generation: the start is missing until a sync arrives.
+            generating = true;
+            text.clear();
+            pieces.clear();
+            lastLostSequence = nextSequence - 1;
+        }
+    }
+
+    if (event.type == TokenBroadcastEvent::SYNC) {
+        applySyncLocked(event);
+        return;
+    }
+
+    if (event.sequence < nextSequence || pending.count(event.sequence)) {
+        ++stats.duplicates;
+        return;
+    }
+
+    if (event.sequence == nextSequence) {
+        deliverLocked(event);
+        drainLocked();
+        return;
+    }
+
+    if (pending.empty()) {
+        waitingSince = now;
+    }
+    ++stats.reordered;
+    pending.emplace(event.sequence, std::move(event));
+}
+
+void TokenBroadcastReceiver::applySyncLocked(TokenBroadcastEvent& event) {
+    const std::uint32_t covered = event.sequence;
+
+    if (covered >= nextSequence) {
+        // The sync is ahead of us: everything up to it is in its text.
+        text = event.text;
+        pieces.clear();
+        nextSequence = covered + 1;
+        pending.erase(pending.begin(), pending.upper_bound(covered));
+    } else if (lastLostSequence != 0 && lastLostSequence <= covered) {
+        // Something before the sync point was lost; rebuild on top of it.
+        text = event.text;
+        for (const auto& piece : pieces) {
+            if (piece.first > covered) {
+                text += piece.second;
+            }
+        }
+    } else {
+        return;
+    }
+
+    lastLostSequence = 0;
+    ++stats.repaired;
+
+    TokenBroadcastEvent repaired;
+    repaired.type = TokenBroadcastEvent::SYNC;
+    repaired.sequence = covered;
+    repaired.text = text;
+    ready.push_back(std::move(repaired));
+    drainLocked();
+}
+
+void TokenBroadcastReceiver::deliverLocked(TokenBroadcastEvent& event) {
+    switch (event.type) {
+    case TokenBroadcastEvent::BEGIN:
+        generating = true;
+        text.clear();
+        pieces.clear();
+        lastLostSequence = 0;
+        break;
+    case TokenBroadcastEvent::TOKEN:
+        text += event.text;
+        pieces.emplace_back(event.sequence, event.text);
+        break;
+    case TokenBroadcastEvent::END:
+        generating = false;
+        break;
+    case TokenBroadcastEvent::SYNC:
+        break;
+    }
+
+    nextSequence = event.sequence + 1;
+    ready.push_back(std::move(event));
+}
+
+void TokenBroadcastReceiver::drainLocked() {
+    auto next = pending.begin();
+    while (next != pending.end() && next->first <= nextSequence) {
+        if (next->first == nextSequence) {
+            deliverLocked(next->second);
+        }
+        next = pending.erase(next);
+    }
+}
+
+void TokenBroadcastReceiver::expireLocked(Clock::time_point now) {
+    if (pending.empty() || now - waitingSince < reorderWindow) {
+        return;
+    }
+
+    // Give up on the missing events and continue with what we have. A later
+    // sync message restores their text.
+    const std::uint32_t resume = pending.begin()->first;
+    stats.lost += resume - nextSequence;
+    lastLostSequence = resume - 1;
+    nextSequence = resume;
+    drainLocked();
+    waitingSince = now;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "TokenBroadcaster.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct TokenBroadcastStats {
+    std::size_t packets = 0;
+    std::size_t duplicates = 0; // Events seen before, mostly the repeated ones in each packet.
+    std::size_t reordered = 0;  // Events that arrived ahead of a missing one.
+    std::size_t lost = 0;       // Events given up on after the reorder window.
+    std::size_t repaired = 0;   // Times a sync message fixed the text.
+};
+
+// Render-node side of TokenBroadcaster. A background thread receives the
+// multicast stream, drops repeated events, holds back events that overtook a
+// missing one for up to the reorder window, and replaces the text from sync
+// messages when something was lost. In-order events are handed on as soon as
+// they arrive.
+class TokenBroadcastReceiver {
+public:
+    TokenBroadcastReceiver();
+    ~TokenBroadcastReceiver();
+
+    TokenBroadcastReceiver(const TokenBroadcastReceiver&) = delete;
+    TokenBroadcastReceiver& operator=(const TokenBroadcastReceiver&) = delete;
+
+    // Joins the multicast group (or listens for unicast/broadcast) on port.
+    // interfaceAddress picks the network card to join on, empty for the default.
+    bool start(const std::string& address = "239.255.42.99", int port = 9099,
+               const std::string& interfaceAddress = "");
+    void stop();
+    bool isRunning() const;
+
+    // How long to wait for a missing event before skipping it.
+    void setReorderWindow(float seconds);
+
+    // Events ready since the last call, in sender order. Call from update().
+    std::vector<TokenBroadcastEvent> poll();
+    // Text of the current or last generation, including any repairs.
+    std::string getText() const;
+    bool isGenerating() const;
+    TokenBroadcastStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void receiveLoop();
+    void acceptLocked(std::int32_t eventSession, TokenBroadcastEvent& event, Clock::time_point now);
+    void applySyncLocked(TokenBroadcastEvent& event);
+    void deliverLocked(TokenBroadcastEvent& event);
+    void drainLocked();
+    void expireLocked(Clock::time_point now);
+
+    std::intptr_t socket;
+    std::atomic<bool> running;
+    std::thread receiveThread;
+
+    mutable std::mutex mutex;
+    Clock::duration reorderWindow = std::chrono::milliseconds(50);
+    bool hasSession = false;
+    std::int32_t session = 0;
+    std::uint32_t nextSequence = 0;
+    std::map<std::uint32_t, TokenBroadcastEvent> pending;
+    Clock::time_point waitingSince;
+    std::vector<TokenBroadcastEvent> ready;
+
+    std::string text;
+    bool generating = false;
+    // Pieces of the current generation, so a sync can be applied under them.
+    std::vector<std::pair<std::uint32_t, std::string>> pieces;
+    // Highest sequence skipped in this generation, 0 when nothing is missing.
+    std::uint32_t lastLostSequence = 0;
+    TokenBroadcastStats stats;
+};
@@ -0,0 +1,394 @@
+#include "TokenBroadcaster.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "ofMain.h"
+#include "ofxLlamaCpp.h"
+
+#include <cstring>
+#include <random>
+
+namespace {
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    const SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+
+    void closeSocket(SocketHandle socket) {
+        closesocket(socket);
+    }
+#else
+    using SocketHandle = int;
+    const SocketHandle INVALID_SOCKET_HANDLE = -1;
+
+    void closeSocket(SocketHandle socket) {
+        ::close(socket);
+    }
+#endif
+
+    const char* const BEGIN_ADDRESS = "/ofxllama/begin";
+    const char* const TOKEN_ADDRESS = "/ofxllama/token";
+    const char* const END_ADDRESS = "/ofxllama/end";
+    const char* const SYNC_ADDRESS = "/ofxllama/sync";
+    const char BUNDLE_TAG[] = "#bundle";
+
+    // Larger datagrams are fragmented by IP and lost as a whole when any
+    // fragment is, so the periodic full-text sync stops at this size.
+    const std::size_t MAX_SYNC_BYTES = 16 * 1024;
+
+    SocketHandle toHandle(std::intptr_t socket) {
+        return static_cast<SocketHandle>(socket);
+    }
+
+    void appendInt32(std::string& out, std::uint32_t value) {
+        out.push_back(static_cast<char>((value >> 24) & 0xFF));
+        out.push_back(static_cast<char>((value >> 16) & 0xFF));
+        out.push_back(static_cast<char>((value >> 8) & 0xFF));
+        out.push_back(static_cast<char>(value & 0xFF));
+    }
+
+    // OSC strings end with at least one NUL and are padded to four bytes.
+    void appendString(std::string& out, const std::string& value) {
+        out += value;
+        out.append(4 - value.size() % 4, '\0');
+    }
+
+    bool readInt32(const char* data, std::size_t size, std::size_t& offset, std::uint32_t& value) {
+        if (offset + 4 > size) {
+            return false;
+        }
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data + offset);
+        value = (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) | (std::uint32_t(bytes[2]) << 8) | bytes[3];
+        offset += 4;
+        return true;
+    }
+
+    bool readString(const char* data, std::size_t size, std::size_t& offset, std::string& value) {
+        if (offset >= size) {
+            return false;
+        }
+        const void* end = std::memchr(data + offset, '\0', size - offset);
+        if (!end) {
+            return false;
+        }
+        const std::size_t length = static_cast<const char*>(end) - (data + offset);
+        value.assign(data + offset, length);
+        offset += length + (4 - length % 4);
+        return offset <= size;
+    }
+
+    bool decodeMessage(const char* data, std::size_t size, std::int32_t& session, std::vector<TokenBroadcastEvent>& events) {
+        std::size_t offset = 0;
+        std::string address;
+        std::string tags;
+        if (!readString(data, size, offset, address) || !readString(data, size, offset, tags)) {
+            return false;
+        }
+
+        TokenBroadcastEvent event;
+        bool hasText = false;
+        if (address == BEGIN_ADDRESS) {
+            event.type = TokenBroadcastEvent::BEGIN;
+        } else if (address == TOKEN_ADDRESS) {
+            event.type = TokenBroadcastEvent::TOKEN;
+            hasText = true;
+        } else if (address == END_ADDRESS) {
+            event.type = TokenBroadcastEvent::END;
+        } else if (address == SYNC_ADDRESS) {
+            event.type = TokenBroadcastEvent::SYNC;
+            hasText = true;
+        } else {
+            return false;
+        }
+
+        if (tags != (hasText ? ",iis" : ",ii")) {
+            return false;
+        }
+
+        std::uint32_t sessionValue = 0;
+        if (!readInt32(data, size, offset, sessionValue) || !readInt32(data, size, offset, event.sequence)) {
+            return false;
+        }
+        if (hasText && !readString(data, size, offset, event.text)) {
+            return false;
+        }
+
+        session = static_cast<std::int32_t>(sessionValue);
+        events.push_back(std::move(event));
+        return true;
+    }
+}
+
+TokenBroadcaster::TokenBroadcaster()
+: socket(static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE)) {
+}
+
+TokenBroadcaster::~TokenBroadcaster() {
+    close();
+}
+
+bool TokenBroadcaster::open(const std::string& address, int port, int ttl, const std::string& interfaceAddress) {
+    close();
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        ofLogError("TokenBroadcaster") << "WSAStartup failed.";
+        return false;
+    }
+#endif
+
+    in_addr target = {};
+    if (inet_pton(AF_INET, address.c_str(), &target) != 1 || port <= 0 || port > 65535) {
+        ofLogError("TokenBroadcaster") << "Invalid destination " << address << ":" << port;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    SocketHandle handle = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET_HANDLE) {
+        ofLogError("TokenBroadcaster") << "Cannot create UDP socket.";
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    const bool multicast = (ntohl(target.s_addr) >> 28) == 0xE;
+    if (multicast) {
+        const unsigned char hops = static_cast<unsigned char>(std::max(1, std::min(ttl, 255)));
+        setsockopt(handle, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char*>(&hops), sizeof(hops));
+        // Lets a receiver on the sending machine see the stream too.
+        const unsigned char loop = 1;
+        setsockopt(handle, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char*>(&loop), sizeof(loop));
+
+        if (!interfaceAddress.empty()) {
+            in_addr source = {};
+            if (inet_pton(AF_INET, interfaceAddress.c_str(), &source) != 1 ||
+                setsockopt(handle, IPPROTO_IP, IP_MULTICAST_IF, reinterpret_cast<const char*>(&source), sizeof(source)) != 0) {
+                ofLogWarning("TokenBroadcaster") << "Cannot send from interface " << interfaceAddress << ", using the default.";
+            }
+        }
+    } else {
+        // Needed for subnet broadcast addresses, harmless for unicast.
+        int enable = 1;
+        setsockopt(handle, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<const char*>(&enable), sizeof(enable));
+    }
+
+    std::random_device random;
+    std::lock_guard<std::mutex> lock(mutex);
+    socket = static_cast<std::intptr_t>(handle);
+    destinationAddress = target.s_addr;
+    destinationPort = htons(static_cast<std::uint16_t>(port));
+    // Lets receivers tell a restarted sender from late packets of the old one.
+    session = static_cast<std::int32_t>(random() & 0x7FFFFFFF);
+    nextSequence = 1;
+    generating = false;
+    reply.clear();
+    recentMessages.clear();
+    packetsSent = 0;
+
+    ofLogNotice("TokenBroadcaster") << "Broadcasting tokens to " << address << ":" << port;
+    return true;
+}
+
+void TokenBroadcaster::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (socket == static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE)) {
+        return;
+    }
+
+    closeSocket(toHandle(socket));
+    socket = static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE);
+    generating = false;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool TokenBroadcaster::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return socket != static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE);
+}
+
+void TokenBroadcaster::attach(ofxLlamaCpp& llama) {
+    const std::function<void(const std::string&)> previousToken = llama.getTokenCallback();
+    const std::function<void()> previousFinish = llama.getFinishCallback();
+
+    // Sending first keeps the fan-out ahead of whatever the app does per token.
+    llama.setTokenCallback([this, previousToken](const std::string& piece) {
+        sendToken(piece);
+        if (previousToken) {
+            previousToken(piece);
+        }
+    });
+    llama.setFinishCallback([this, previousFinish]() {
+        end();
+        if (previousFinish) {
+            previousFinish();
+        }
+    });
+}
+
+void TokenBroadcaster::begin() {
+    std::lock_guard<std::mutex> lock(mutex);
+    sendEventLocked(TokenBroadcastEvent::BEGIN, "");
+}
+
+void TokenBroadcaster::sendToken(const std::string& piece) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sendEventLocked(TokenBroadcastEvent::TOKEN, piece);
+}
+
+void TokenBroadcaster::end() {
+    std::lock_guard<std::mutex> lock(mutex);
+    sendEventLocked(TokenBroadcastEvent::END, "");
+}
+
+void TokenBroadcaster::setRedundancy(std::size_t events) {
+    std::lock_guard<std::mutex> lock(mutex);
+    redundancy = events;
+    while (recentMessages.size() > redundancy) {
+        recentMessages.pop_front();
+    }
+}
+
+void TokenBroadcaster::setSyncInterval(float seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    syncInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>(std::max(0.0f, seconds)));
+}
+
+std::size_t TokenBroadcaster::getPacketsSent() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return packetsSent;
+}
+
+std::string TokenBroadcaster::encodeMessage(const std::string& address, std::int32_t session, std::uint32_t sequence,
+                                            const std::string* text) {
+    std::string message;
+    appendString(message, address);
+    appendString(message, text ? ",iis" : ",ii");
+    appendInt32(message, static_cast<std::uint32_t>(session));
+    appendInt32(message, sequence);
+    if (text) {
+        appendString(message, *text);
+    }
+    return message;
+}
+
+std::string TokenBroadcaster::encodeBundle(const std::vector<std::string>& messages) {
+    std::string bundle;
+    appendString(bundle, BUNDLE_TAG);
+    // OSC time tag 1 means "immediately".
+    appendInt32(bundle, 0);
+    appendInt32(bundle, 1);
+    for (const std::string& message : messages) {
+        appendInt32(bundle, static_cast<std::uint32_t>(message.size()));
+        bundle += message;
+    }
+    return bundle;
+}
+
+bool TokenBroadcaster::decodePacket(const char* data, std::size_t size, std::int32_t& session,
+                                    std::vector<TokenBroadcastEvent>& events) {
+    if (size >= 16 && std::memcmp(data, BUNDLE_TAG, sizeof(BUNDLE_TAG)) == 0) {
+        bool decoded = false;
+        std::size_t offset = 16;
+        std::uint32_t length = 0;
+        while (readInt32(data, size, offset, length) && length <= size - offset) {
+            decoded = decodeMessage(data + offset, length, session, events) || decoded;
+            offset += length;
+        }
+        return decoded;
+    }
+    return decodeMessage(data, size, session, events);
+}
+
+void TokenBroadcaster::sendEventLocked(TokenBroadcastEvent::Type type, const std::string& piece) {
+    if (socket == static_cast<std::intptr_t>(INVALID_SOCKET_HANDLE)) {
+        return;
+    }
+
+    if (type == TokenBroadcastEvent::END && !generating) {
+        return;
+    }
+    if (type == TokenBroadcastEvent::TOKEN && !generating) {
+        // Receivers need a BEGIN to clear the previous reply.
+        sendEventLocked(TokenBroadcastEvent::BEGIN, "");
+    }
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::string message;
+    switch (type) {
+    case TokenBroadcastEvent::BEGIN:
+        generating = true;
+        reply.clear();
+        lastSync = now;
+        message = encodeMessage(BEGIN_ADDRESS, session, nextSequence++, nullptr);
+        break;
+    case TokenBroadcastEvent::TOKEN:
+        reply += piece;
+        message = encodeMessage(TOKEN_ADDRESS, session, nextSequence++, &piece);
+        break;
+    case TokenBroadcastEvent::END:
+        generating = false;
+        message = encodeMessage(END_ADDRESS, session, nextSequence++, nullptr);
+        break;
+    case TokenBroadcastEvent::SYNC:
+        return;
+    }
+
+    std::vector<std::string> messages(recentMessages.begin(), recentMessages.end());
+    messages.push_back(message);
+    sendDatagram(encodeBundle(messages));
+
+    recentMessages.push_back(message);
+    while (recentMessages.size() > redundancy) {
+        recentMessages.pop_front();
+    }
+
+    // The final sync lets nodes that missed the tail settle on the full reply.
+    if (type == TokenBroadcastEvent::END || (type == TokenBroadcastEvent::TOKEN && now - lastSync >= syncInterval)) {
+        lastSync = now;
+        sendSync();
+    }
+}
+
+void TokenBroadcaster::sendSync() {
+    const std::string message = encodeMessage(SYNC_ADDRESS, session, nextSequence - 1, &reply);
+    if (message.size() > MAX_SYNC_BYTES) {
+        if (!warnedSyncTooLarge) {
+            ofLogWarning("TokenBroadcaster") << "Reply is too long to resend in one packet; receivers that lose tokens now keep a gap.";
+            warnedSyncTooLarge = true;
+        }
+        return;
+    }
+    sendDatagram(message);
+}
+
+bool TokenBroadcaster::sendDatagram(const std::string& datagram) {
+    sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_addr.s_addr = destinationAddress;
+    target.sin_port = destinationPort;
+
+    const auto sent = ::sendto(toHandle(socket), datagram.data(), static_cast<int>(datagram.size()), 0,
+                               reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+    if (sent < 0) {
+        ofLogVerbose("TokenBroadcaster") << "Dropped a packet of " << datagram.size() << " bytes.";
+        return false;
+    }
+    ++packetsSent;
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ofxLlamaCpp;
+
+// One event of a broadcast generation, in sender order.
+struct TokenBroadcastEvent {
+    enum Type {
+        BEGIN, // A new generation starts; text is empty.
+        TOKEN, // text is the next piece.
+        END,   // The generation is complete.
+        SYNC   // text is the whole reply so far and replaces what was shown.
+    };
+
+    Type type = TOKEN;
+    std::uint32_t sequence = 0;
+    std::string text;
+};
+
+// Multicasts generated tokens to render nodes as OSC over UDP, so several
+// projector machines show the same text without one HTTP stream per client.
+// Every packet is an OSC bundle holding the new event plus the previous few
+// (setRedundancy), so a single lost packet is filled by the next one.
+// A periodic /ofxllama/sync message carries the full reply so far, which lets
+// TokenBroadcastReceiver repair longer gaps and nodes join mid-generation.
+//
+// OSC addresses, all arguments int32 except the string:
+//   /ofxllama/begin ,ii  session sequence
+//   /ofxllama/token ,iis session sequence piece
+//   /ofxllama/end   ,ii  session sequence
+//   /ofxllama/sync  ,iis session lastSequence text
+class TokenBroadcaster {
+public:
+    TokenBroadcaster();
+    ~TokenBroadcaster();
+
+    TokenBroadcaster(const TokenBroadcaster&) = delete;
+    TokenBroadcaster& operator=(const TokenBroadcaster&) = delete;
+
+    // address is a multicast group (239.0.0.0/8 stays inside the site) or a
+    // unicast/broadcast IPv4 address. ttl limits how many routers multicast
+    // crosses; 1 keeps it on the local network. interfaceAddress picks the
+    // network card to send from, empty for the system default.
+    bool open(const std::string& address = "239.255.42.99", int port = 9099, int ttl = 1,
+              const std::string& interfaceAddress = "");
+    void close();
+    bool isOpen() const;
+
+    // Chains onto llama's token and finish callbacks, keeping any that are
+    // already set, so every generation is broadcast. Call after setting the
+    // app's own callbacks, and before generating.
+    void attach(ofxLlamaCpp& llama);
+
+    // Manual use, e.g. with a remote provider. sendToken() begins a
+    // generation by itself when none is running.
+    void begin();
+    void sendToken(const std::string& piece);
+    void end();
+
+    // Previous events repeated in every packet. 0 disables the repetition.
+    void setRedundancy(std::size_t events);
+    // How often the full reply is resent during a generation.
+    void setSyncInterval(float seconds);
+
+    std::size_t getPacketsSent() const;
+
+    // OSC encoding shared with TokenBroadcastReceiver.
+    static std::string encodeMessage(const std::string& address, std::int32_t session, std::uint32_t sequence,
+                                     const std::string* text);
+    static std::string encodeBundle(const std::vector<std::string>& messages);
+    // Appends the events of one datagram; false if it is not ours.
+    static bool decodePacket(const char* data, std::size_t size, std::int32_t& session,
+                             std::vector<TokenBroadcastEvent>& events);
+
+private:
+    void sendEventLocked(TokenBroadcastEvent::Type type, const std::string& piece);
+    void sendSync();
+    bool sendDatagram(const std::string& datagram);
+
+    mutable std::mutex mutex;
+    std::intptr_t socket;
+    std::uint32_t destinationAddress = 0; // IPv4, network byte order
+    std::uint16_t destinationPort = 0;    // Network byte order
+    std::int32_t session = 0;
+    std::uint32_t nextSequence = 1;
+    bool generating = false;
+    std::string reply;
+    std::deque<std::string> recentMessages;
+    std::size_t redundancy = 2;
+    std::chrono::steady_clock::duration syncInterval = std::chrono::milliseconds(500);
+    std::chrono::steady_clock::time_point lastSync;
+    std::size_t packetsSent = 0;
+    bool warnedSyncTooLarge = false;
+};
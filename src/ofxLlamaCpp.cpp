@@ -20,6 +20,33 @@
 #include "../libs/llama.cpp/ggml/include/ggml-cuda.h"
 #endif
 
+#ifdef OFX_LLAMACPP_USE_RPC
+#include "../libs/llama.cpp/ggml/include/ggml-rpc.h"
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/qos.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+namespace {
+    // Bounds how long a stop request goes unnoticed in generateBlocking().
+    const std::chrono::milliseconds BLOCKING_POLL_INTERVAL(20);
+}
+
 
 // --------------------------------------------------------------
 // Constructor for ofxLlamaCpp.
@@ -44,6 +71,7 @@ ofxLlamaCpp::ofxLlamaCpp() {
 // Ensures any ongoing generation is stopped, the model is unloaded,
 // and the Llama.cpp backend resources are freed.
 ofxLlamaCpp::~ofxLlamaCpp() {
+    setEventDelivery(false); // Stop listening to ofEvents().update
     stopGeneration();    // Stop any active generation thread
     unload();            // Unload the model and free its resources
     llama_backend_free(); // Free Llama.cpp backend resources
@@ -61,20 +89,59 @@ bool ofxLlamaCpp::loadModel(const std::string& path, int n_ctx_req) {
     llama_model_params mp = llama_model_default_params();
     mp.n_gpu_layers = this->n_gpu_layers;
 
+    // Devices the layers are split across. llama.cpp copies the list while loading.
+    std::vector<ggml_backend_dev_t> devices_list;
+
+    if (!rpcServers.empty()) {
+        if (!addRpcDevices(devices_list)) {
+            return false;
+        }
+
+        // Local GPUs take their share next to the workers.
+        for (size_t i = 0; i < ggml_backend_dev_count(); ++i) {
+            ggml_backend_dev_t dev = ggml_backend_dev_get(i);
+            if (ggml_backend_dev_type(dev) == GGML_BACKEND_DEVICE_TYPE_GPU) {
+                devices_list.push_back(dev);
+            }
+        }
+
+        // Layers that are not offloaded stay in this machine's RAM, which is
+        // what the workers are there to avoid.
+        if (mp.n_gpu_layers <= 0) {
+            mp.n_gpu_layers = 999;
+            ofLogNotice("ofxLlamaCpp") << "Offloading all layers to " << devices_list.size() << " devices.";
+        }
+        mp.split_mode = LLAMA_SPLIT_MODE_LAYER;
+    }
 #ifdef __APPLE__
-    ggml_backend_dev_t cuda_dev = ggml_backend_dev_by_type(GGML_BACKEND_DEVICE_TYPE_GPU);
-    if (cuda_dev != nullptr) {
-        static std::vector<ggml_backend_dev_t> devices_list;
-        devices_list.clear();
-        devices_list.push_back(cuda_dev);
+    else {
+        ggml_backend_dev_t cuda_dev = ggml_backend_dev_by_type(GGML_BACKEND_DEVICE_TYPE_GPU);
+        if (cuda_dev != nullptr) {
+            devices_list.push_back(cuda_dev);
+        } else {
+            if (this->n_gpu_layers > 0) {
+                ofLogWarning("ofxLlamaCpp") << "GPU offloading requested but no CUDA device found. Falling back to CPU.";
+            }
+        }
+    }
+#endif
+
+    const size_t device_count = devices_list.size();
+    if (device_count > 0) {
         devices_list.push_back(nullptr); // Null-terminate the list
         mp.devices = devices_list.data();
-    } else {
-        if (this->n_gpu_layers > 0) {
-            ofLogWarning("ofxLlamaCpp") << "GPU offloading requested but no CUDA device found. Falling back to CPU.";
+    }
+
+    // llama.cpp reads one share per possible device.
+    std::vector<float> split;
+    if (!tensorSplit.empty()) {
+        if (tensorSplit.size() != device_count) {
+            ofLogWarning("ofxLlamaCpp") << "Tensor split has " << tensorSplit.size() << " entries for " << device_count << " devices.";
         }
+        split.assign(llama_max_devices(), 0.0f);
+        std::copy_n(tensorSplit.begin(), std::min(tensorSplit.size(), split.size()), split.begin());
+        mp.tensor_split = split.data();
     }
-#endif
 
     model = llama_model_load_from_file(path.c_str(), mp);
     if (!model) {
@@ -97,7 +164,7 @@ bool ofxLlamaCpp::loadVisionModel(const std::string& modelPath, const std::strin
     mtmd_context_params mparams = mtmd_context_params_default();
     mparams.use_gpu = n_gpu_layers > 0;
     mparams.print_timings = false;
-    mparams.n_threads = std::max(1u, std::thread::hardware_concurrency());
+    mparams.n_threads = getThreadCount();
     mparams.flash_attn_type = LLAMA_FLASH_ATTN_TYPE_AUTO;
     mparams.warmup = false;
 
@@ -169,6 +236,79 @@ void ofxLlamaCpp::setN_GpuLayers(int n_gpu_layers_val) {
     ofLogNotice("ofxLlamaCpp") << "n_gpu_layers set to: " << n_gpu_layers;
 }
 
+// --------------------------------------------------------------
+// Sets the ggml RPC workers the next loadModel() distributes layers to.
+void ofxLlamaCpp::setRpcServers(const std::vector<std::string>& servers) {
+    rpcServers = servers;
+}
+
+// --------------------------------------------------------------
+// Returns the ggml RPC workers used by loadModel().
+const std::vector<std::string>& ofxLlamaCpp::getRpcServers() const {
+    return rpcServers;
+}
+
+// --------------------------------------------------------------
+// Sets the relative share of layers per device for the next loadModel().
+void ofxLlamaCpp::setTensorSplit(const std::vector<float>& split) {
+    tensorSplit = split;
+}
+
+// --------------------------------------------------------------
+// Connects to every RPC worker and adds its devices. Fails if a worker
+// cannot be reached, since the model would not fit without it.
+bool ofxLlamaCpp::addRpcDevices(std::vector<ggml_backend_dev_t>& devices) {
+#ifdef OFX_LLAMACPP_USE_RPC
+    // The entry point changed between llama.cpp versions, so look up whichever
+    // this build provides.
+    typedef ggml_backend_reg_t (*AddServerFn)(const char* endpoint);
+    typedef ggml_backend_dev_t (*AddDeviceFn)(const char* endpoint);
+    ggml_backend_reg_t rpc_reg = ggml_backend_rpc_reg();
+    AddServerFn add_server = (AddServerFn) ggml_backend_reg_get_proc_address(rpc_reg, "ggml_backend_rpc_add_server");
+    AddDeviceFn add_device = (AddDeviceFn) ggml_backend_reg_get_proc_address(rpc_reg, "ggml_backend_rpc_add_device");
+
+    for (const std::string& server : rpcServers) {
+        std::vector<ggml_backend_dev_t> server_devices;
+        if (add_server) {
+            ggml_backend_reg_t server_reg = add_server(server.c_str());
+            for (size_t i = 0; server_reg && i < ggml_backend_reg_dev_count(server_reg); ++i) {
+                server_devices.push_back(ggml_backend_reg_dev_get(server_reg, i));
+            }
+        } else if (add_device) {
+            ggml_backend_dev_t dev = add_device(server.c_str());
+            if (dev) {
+                server_devices.push_back(dev);
+            }
+        }
+
+        // An unreachable worker reports no memory.
+        size_t free_total = 0;
+        size_t memory_total = 0;
+        for (ggml_backend_dev_t dev : server_devices) {
+            size_t free_mem = 0;
+            size_t total_mem = 0;
+            ggml_backend_dev_memory(dev, &free_mem, &total_mem);
+            free_total += free_mem;
+            memory_total += total_mem;
+        }
+        if (memory_total == 0) {
+            ofLogError("ofxLlamaCpp") << "Cannot reach RPC worker " << server;
+            return false;
+        }
+
+        ofLogNotice("ofxLlamaCpp") << "RPC worker " << server << ": " << server_devices.size() << " device(s), "
+                                   << free_total / (1024 * 1024) << " MiB free of " << memory_total / (1024 * 1024) << " MiB";
+        devices.insert(devices.end(), server_devices.begin(), server_devices.end());
+    }
+    return true;
+#else
+    (void)devices;
+    ofLogError("ofxLlamaCpp") << "RPC workers are set, but llama.cpp was built without RPC support. "
+                              << "Run install_llama.py --enable-rpc.";
+    return false;
+#endif
+}
+
 // --------------------------------------------------------------
 // Sets whether to offload K, Q, V tensors to the GPU.
 void ofxLlamaCpp::setOffloadKqv(bool offload_kqv_val) {
@@ -188,6 +328,108 @@ bool ofxLlamaCpp::getOffloadKqv() const {
     return offload_kqv;
 }
 
+// --------------------------------------------------------------
+// Sets the OS priority of the generation thread and its compute threads.
+// Takes effect with the next startGeneration().
+void ofxLlamaCpp::setThreadPriority(ThreadPriority priority) {
+    threadPriority = priority;
+}
+
+// --------------------------------------------------------------
+// Returns the priority used for generation threads.
+ofxLlamaCpp::ThreadPriority ofxLlamaCpp::getThreadPriority() const {
+    return threadPriority;
+}
+
+// --------------------------------------------------------------
+// Keeps the first cores free for the app. Takes effect with the next generation.
+void ofxLlamaCpp::setReservedCores(int cores) {
+    reservedCores = std::max(0, cores);
+}
+
+// --------------------------------------------------------------
+// Returns the number of cores kept free of inference threads.
+int ofxLlamaCpp::getReservedCores() const {
+    return reservedCores;
+}
+
+// --------------------------------------------------------------
+// Sets the number of compute threads; 0 uses every core that is not reserved.
+void ofxLlamaCpp::setThreadCount(int threads) {
+    threadCount = std::max(0, threads);
+}
+
+// --------------------------------------------------------------
+// Returns the number of compute threads decoding will use, never more than
+// the cores left after the reserved ones.
+int ofxLlamaCpp::getThreadCount() const {
+    const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int available = std::max(1, cores - reservedCores);
+    return threadCount > 0 ? std::min(threadCount, available) : available;
+}
+
+// --------------------------------------------------------------
+// Passes the current thread count to the context. Prompt processing keeps
+// llama.cpp's default thread count unless that is more than the decode threads.
+void ofxLlamaCpp::updateContextThreads() {
+    if (!ctx) return;
+    const int threads = getThreadCount();
+    const int batchThreads = std::min(static_cast<int>(llama_context_default_params().n_threads_batch), threads);
+    llama_set_n_threads(ctx, threads, batchThreads);
+}
+
+// --------------------------------------------------------------
+// Lowers the priority of the calling thread and keeps it off the reserved
+// cores. On Linux and macOS the compute threads that llama.cpp starts from
+// this thread inherit both; on Windows only this thread is affected.
+void ofxLlamaCpp::applyThreadPolicy() {
+    const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    if (reservedCores >= cores) {
+        ofLogWarning("ofxLlamaCpp") << "Cannot reserve " << reservedCores << " of " << cores << " cores, using all of them.";
+    }
+
+#if defined(__linux__)
+    if (threadPriority == ThreadPriority::IDLE) {
+        sched_param param = {};
+        if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+            ofLogWarning("ofxLlamaCpp") << "Cannot switch the generation thread to SCHED_IDLE.";
+        }
+    } else if (threadPriority == ThreadPriority::LOW) {
+        // Linux keeps a nice value per thread; threads started later inherit it.
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10) != 0) {
+            ofLogWarning("ofxLlamaCpp") << "Cannot lower the priority of the generation thread.";
+        }
+    }
+
+    if (reservedCores > 0 && reservedCores < cores) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int core = reservedCores; core < cores; ++core) {
+            CPU_SET(core, &set);
+        }
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            ofLogWarning("ofxLlamaCpp") << "Cannot keep the generation thread off the reserved cores.";
+        }
+    }
+#elif defined(__APPLE__)
+    // macOS cannot pin threads to cores, so reserved cores only lower the thread count.
+    if (threadPriority != ThreadPriority::NORMAL) {
+        pthread_set_qos_class_self_np(threadPriority == ThreadPriority::IDLE ? QOS_CLASS_BACKGROUND : QOS_CLASS_UTILITY, 0);
+    }
+#elif defined(_WIN32)
+    if (threadPriority != ThreadPriority::NORMAL) {
+        SetThreadPriority(GetCurrentThread(), threadPriority == ThreadPriority::IDLE ? THREAD_PRIORITY_IDLE : THREAD_PRIORITY_BELOW_NORMAL);
+    }
+    if (reservedCores > 0 && reservedCores < cores) {
+        DWORD_PTR mask = 0;
+        for (int core = reservedCores; core < std::min(cores, 64); ++core) {
+            mask |= DWORD_PTR(1) << core;
+        }
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+#endif
+}
+
 // --------------------------------------------------------------
 // Sampler Settings: These functions update parameters for text generation
 // and then rebuild the sampler to apply the changes.
@@ -301,6 +543,90 @@ std::string ofxLlamaCpp::detokenize(const std::vector<llama_token>& toks) const
     return out;
 }
 
+// --------------------------------------------------------------
+// Computes an embedding for the given text.
+// The context is switched to embedding output for one decode and cleared
+// before and after, so it does not disturb the next generation.
+bool ofxLlamaCpp::getEmbedding(const std::string& text, std::vector<float>& embedding) {
+    embedding.clear();
+
+    if (!ctx) {
+        ofLogError("ofxLlamaCpp") << "No model loaded.";
+        return false;
+    }
+    if (isGenerating()) {
+        ofLogError("ofxLlamaCpp") << "Cannot compute embeddings while generating.";
+        return false;
+    }
+    stopGeneration(); // Join a finished generation thread before using the context
+
+    std::vector<llama_token> tokens = tokenize(text);
+    if (tokens.empty()) {
+        ofLogError("ofxLlamaCpp") << "Cannot embed empty text.";
+        return false;
+    }
+
+    // Pooled embeddings need the whole input in one micro-batch.
+    const int maxTokens = static_cast<int>(std::min(llama_n_ubatch(ctx), llama_n_ctx(ctx)));
+    if (static_cast<int>(tokens.size()) > maxTokens) {
+        ofLogWarning("ofxLlamaCpp") << "Embedding input truncated from " << tokens.size() << " to " << maxTokens << " tokens.";
+        tokens.resize(maxTokens);
+    }
+
+    const int n_tokens = static_cast<int>(tokens.size());
+    const int n_embd = llama_model_n_embd(model);
+    const bool pooled = llama_pooling_type(ctx) != LLAMA_POOLING_TYPE_NONE;
+
+    resetContext();
+    llama_set_embeddings(ctx, true);
+
+    llama_batch batch = llama_batch_init(n_tokens, 0, 1);
+    for (int i = 0; i < n_tokens; ++i) {
+        batch.token[i] = tokens[i];
+        batch.pos[i] = i;
+        batch.n_seq_id[i] = 1;
+        batch.seq_id[i][0] = 0;
+        batch.logits[i] = true; // Every token contributes to the embedding
+    }
+    batch.n_tokens = n_tokens;
+
+    bool ok = llama_decode(ctx, batch) == 0;
+    if (!ok) {
+        ofLogError("ofxLlamaCpp") << "llama_decode failed while computing embeddings";
+    } else if (pooled) {
+        const float* pooledEmbedding = llama_get_embeddings_seq(ctx, 0);
+        ok = pooledEmbedding != nullptr;
+        if (ok) embedding.assign(pooledEmbedding, pooledEmbedding + n_embd);
+    } else {
+        // Mean-pool the per-token embeddings of generative models.
+        embedding.assign(n_embd, 0.0f);
+        for (int i = 0; i < n_tokens && ok; ++i) {
+            const float* tokenEmbedding = llama_get_embeddings_ith(ctx, i);
+            ok = tokenEmbedding != nullptr;
+            for (int j = 0; ok && j < n_embd; ++j) {
+                embedding[j] += tokenEmbedding[j] / n_tokens;
+            }
+        }
+    }
+
+    llama_batch_free(batch);
+    llama_set_embeddings(ctx, false);
+    resetContext();
+
+    if (!ok) {
+        embedding.clear();
+        return false;
+    }
+
+    double norm = 0.0;
+    for (float value : embedding) norm += double(value) * value;
+    norm = std::sqrt(norm);
+    if (norm > 0.0) {
+        for (float& value : embedding) value = float(value / norm);
+    }
+    return true;
+}
+
 // --------------------------------------------------------------
 // Resets the model's context. This is crucial for starting new conversations
 // without interference from previous ones.
@@ -333,6 +659,84 @@ void ofxLlamaCpp::setFinishCallback(std::function<void()> fn) {
     finishCallback = fn;
 }
 
+// --------------------------------------------------------------
+// Returns the token callback, e.g. to wrap it in another one.
+std::function<void(const std::string&)> ofxLlamaCpp::getTokenCallback() const {
+    return tokenCallback;
+}
+
+// --------------------------------------------------------------
+// Returns the finish callback, e.g. to wrap it in another one.
+std::function<void()> ofxLlamaCpp::getFinishCallback() const {
+    return finishCallback;
+}
+
+// --------------------------------------------------------------
+// Switches token delivery through tokenEvent and finishEvent on or off.
+// Pieces still queued when it is switched off are dropped.
+void ofxLlamaCpp::setEventDelivery(bool enabled) {
+    if (enabled == getEventDelivery()) return;
+
+    if (enabled) {
+        ofAddListener(ofEvents().update, this, &ofxLlamaCpp::deliverEvents, OF_EVENT_ORDER_BEFORE_APP);
+    } else {
+        ofRemoveListener(ofEvents().update, this, &ofxLlamaCpp::deliverEvents, OF_EVENT_ORDER_BEFORE_APP);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    eventDelivery = enabled;
+    eventQueue.clear();
+}
+
+// --------------------------------------------------------------
+// Returns true if tokens are delivered through tokenEvent and finishEvent.
+bool ofxLlamaCpp::getEventDelivery() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return eventDelivery;
+}
+
+// --------------------------------------------------------------
+// Sets how long tokenEvent listeners may run per frame before the remaining
+// pieces are coalesced.
+void ofxLlamaCpp::setEventFrameBudget(float milliseconds) {
+    eventFrameBudget = std::max(0.0f, milliseconds);
+}
+
+// --------------------------------------------------------------
+// Runs on the main thread before ofApp::update() and hands the pieces that
+// arrived since the last frame to the listeners, in generation order.
+void ofxLlamaCpp::deliverEvents(ofEventArgs&) {
+    std::vector<QueuedEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        events.swap(eventQueue);
+    }
+    if (events.empty()) return;
+
+    const uint64_t start = ofGetElapsedTimeMicros();
+    const uint64_t budget = static_cast<uint64_t>(eventFrameBudget * 1000.0f);
+    std::string coalesced;
+
+    for (QueuedEvent& event : events) {
+        if (event.finished) {
+            if (!coalesced.empty()) {
+                ofNotifyEvent(tokenEvent, coalesced, this);
+                coalesced.clear();
+            }
+            ofNotifyEvent(finishEvent, this);
+        } else if (coalesced.empty() && ofGetElapsedTimeMicros() - start < budget) {
+            ofNotifyEvent(tokenEvent, event.text, this);
+        } else {
+            // Over budget: the rest of this frame's pieces go out together.
+            coalesced += event.text;
+        }
+    }
+
+    if (!coalesced.empty()) {
+        ofNotifyEvent(tokenEvent, coalesced, this);
+    }
+}
+
 // --------------------------------------------------------------
 // Builds or rebuilds the Llama sampler with the current generation parameters.
 // This defines how tokens are selected during the generation process (e.g., top-k, top-p, temperature).
@@ -380,7 +784,7 @@ bool ofxLlamaCpp::checkStopSequences(const std::string& s) {
 // --------------------------------------------------------------
 // Initiates asynchronous text generation in a separate thread.
 // The generated text will be available via getNewOutput() or through callbacks.
-void ofxLlamaCpp::startGeneration(const std::string& prompt, int maxTokens) {
+void ofxLlamaCpp::startGeneration(const std::string& prompt, int maxTokens, float deadlineSeconds) {
     if (!ctx) return; // Cannot generate if no context is loaded
 
     stopGeneration(); // Stop any existing generation before starting a new one
@@ -394,6 +798,9 @@ void ofxLlamaCpp::startGeneration(const std::string& prompt, int maxTokens) {
         generating = true;                   // Mark generation as active
         requestStop = false;                 // Reset stop request flag
     }
+    setDeadline(deadlineSeconds);            // Counted from here, so it includes the prompt
+
+    updateContextThreads(); // Thread settings may have changed since the last run
 
     // Launch the generation loop in a new thread.
     worker = std::thread(&ofxLlamaCpp::generationLoop, this);
@@ -401,7 +808,8 @@ void ofxLlamaCpp::startGeneration(const std::string& prompt, int maxTokens) {
 
 // --------------------------------------------------------------
 // Initiates asynchronous multimodal generation using a single image.
-void ofxLlamaCpp::startVisionGeneration(const std::string& prompt, const std::string& imagePath, int maxTokens) {
+void ofxLlamaCpp::startVisionGeneration(const std::string& prompt, const std::string& imagePath, int maxTokens,
+                                        float deadlineSeconds) {
     if (!ctx || !visionCtx) return;
 
     stopGeneration();
@@ -415,7 +823,9 @@ void ofxLlamaCpp::startVisionGeneration(const std::string& prompt, const std::st
         generating = true;
         requestStop = false;
     }
+    setDeadline(deadlineSeconds);
 
+    updateContextThreads();
     worker = std::thread(&ofxLlamaCpp::generationLoop, this);
 }
 
@@ -428,6 +838,9 @@ void ofxLlamaCpp::stopGeneration() {
     if (worker.joinable()) {
         worker.join(); // Wait for the worker thread to complete its current task and terminate
     }
+
+    // A cooperative generation has no thread to notice the flag, so it ends here.
+    if (cooperative) finishGeneration();
 }
 
 // --------------------------------------------------------------
@@ -446,6 +859,154 @@ std::string ofxLlamaCpp::getNewOutput() {
     return out;                           // Return the copied output
 }
 
+// --------------------------------------------------------------
+// Returns the token limit of the current or last generation. Without a
+// deadline this is maxTokens; with one it drops to what still fits in time.
+int ofxLlamaCpp::getAdaptiveTokenLimit() const {
+    return adaptiveTokenLimit;
+}
+
+// --------------------------------------------------------------
+// Returns the smoothed decode speed of the current or last generation,
+// measured from the second token on. 0 until then.
+float ofxLlamaCpp::getDecodeTokensPerSecond() const {
+    return decodeTokensPerSecond;
+}
+
+// --------------------------------------------------------------
+// Returns true if the last generation was ended early by its deadline.
+bool ofxLlamaCpp::wasStoppedByDeadline() const {
+    return stoppedByDeadline;
+}
+
+// --------------------------------------------------------------
+// Prepares a text generation that is advanced by step() or stepFor() on the
+// caller's thread. The prompt is tokenized here and decoded in later steps.
+bool ofxLlamaCpp::beginGeneration(const std::string& prompt, int maxTokens, float deadlineSeconds) {
+    if (!ctx) return false; // Cannot generate if no context is loaded
+
+    stopGeneration(); // Stop any existing generation before starting a new one
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        currentPrompt = prompt;
+        currentImagePath.clear();
+        pendingOut.clear();
+        max_gen_tokens = maxTokens;
+        generating = true;
+        requestStop = false;
+    }
+    setDeadline(deadlineSeconds);
+
+    updateContextThreads();
+    resetContext();
+    resetGenerationState();
+    promptTokens = tokenize(prompt);
+    cooperative = true;
+    return true;
+}
+
+// --------------------------------------------------------------
+// Runs up to maxSteps steps of the cooperative generation and returns the
+// text they produced. Returns an empty string once the generation has ended.
+std::string ofxLlamaCpp::step(int maxSteps) {
+    std::string out;
+    for (int i = 0; i < maxSteps && cooperative; ++i) {
+        if (!advanceGeneration(out)) break;
+    }
+    return out;
+}
+
+// --------------------------------------------------------------
+// Runs steps of the cooperative generation until the time budget is spent.
+// The step that crosses the budget still completes, and at least one step runs.
+std::string ofxLlamaCpp::stepFor(float milliseconds) {
+    std::string out;
+    const uint64_t start = ofGetElapsedTimeMicros();
+    const uint64_t budget = static_cast<uint64_t>(std::max(0.0f, milliseconds) * 1000.0f);
+    while (cooperative) {
+        if (!advanceGeneration(out)) break;
+        if (ofGetElapsedTimeMicros() - start >= budget) break;
+    }
+    return out;
+}
+
+// --------------------------------------------------------------
+// Generates on the worker thread and hands the text to the calling thread.
+ofxLlamaCpp::BlockingResult ofxLlamaCpp::generateBlocking(const std::string& prompt, int maxTokens,
+                                                          const std::function<bool(const std::string&)>& onPiece,
+                                                          const std::function<bool()>& shouldStop) {
+    BlockingResult result;
+
+    // Pieces arrive on the generation thread and are collected here until the
+    // calling thread wakes up, so onPiece never runs concurrently with it.
+    std::mutex pieceMutex;
+    std::condition_variable pieceReady;
+    std::string pending;
+    bool finished = false;
+
+    stopGeneration();
+    setTokenCallback([&](const std::string& piece) {
+        std::lock_guard<std::mutex> lock(pieceMutex);
+        pending += piece;
+        pieceReady.notify_one();
+    });
+    setFinishCallback([&]() {
+        std::lock_guard<std::mutex> lock(pieceMutex);
+        finished = true;
+        pieceReady.notify_one();
+    });
+    startGeneration(prompt, maxTokens);
+
+    bool done = false;
+    while (!done) {
+        std::string chunk;
+        {
+            std::unique_lock<std::mutex> lock(pieceMutex);
+            // The timeout only bounds how long a stop request can go unnoticed.
+            pieceReady.wait_for(lock, BLOCKING_POLL_INTERVAL, [&]() {
+                return !pending.empty() || finished;
+            });
+            chunk.swap(pending);
+            done = finished || !isGenerating();
+        }
+
+        if (shouldStop && shouldStop()) {
+            result.interrupted = true;
+            break;
+        }
+
+        if (!chunk.empty()) {
+            result.text += chunk;
+            if (onPiece && !onPiece(chunk)) {
+                result.interrupted = true;
+                break;
+            }
+        }
+    }
+
+    // Joins the generation thread, so the callbacks above are done with our locals.
+    stopGeneration();
+    setTokenCallback(nullptr);
+    setFinishCallback(nullptr);
+    getNewOutput(); // Already delivered through the token callback.
+
+    if (!result.interrupted && !pending.empty()) {
+        result.text += pending;
+        result.interrupted = onPiece && !onPiece(pending);
+    }
+
+    result.tokens = tokensGenerated;
+    return result;
+}
+
+// --------------------------------------------------------------
+// Sets how many prompt tokens one step decodes. Smaller chunks spread a long
+// prompt over more frames; 0 uses the context's batch size.
+void ofxLlamaCpp::setPrefillChunkSize(int tokens) {
+    prefillChunkSize = std::max(0, tokens);
+}
+
 // --------------------------------------------------------------
 // Creates the llama context with the current runtime parameters.
 bool ofxLlamaCpp::initializeContext(int n_ctx_req) {
@@ -454,7 +1015,8 @@ bool ofxLlamaCpp::initializeContext(int n_ctx_req) {
     cp.flash_attn_type = LLAMA_FLASH_ATTN_TYPE_AUTO;
     cp.n_batch = 512;
     cp.n_ubatch = 512;
-    cp.n_threads = std::max(1u, std::thread::hardware_concurrency());
+    cp.n_threads = getThreadCount();
+    cp.n_threads_batch = std::min(cp.n_threads_batch, cp.n_threads); // Stay off reserved cores
     cp.offload_kqv = this->offload_kqv;
 
     ctx = llama_init_from_model(model, cp);
@@ -494,34 +1056,33 @@ std::string ofxLlamaCpp::formatVisionPrompt(const std::string& prompt) const {
 }
 
 // --------------------------------------------------------------
-// Evaluates a plain text prompt into the llama context.
-bool ofxLlamaCpp::processTextPrompt(const std::string& prompt, int& n_past) {
-    auto tokens = tokenize(prompt);
-    n_past = 0;
-
-    while (n_past < static_cast<int>(tokens.size())) {
-        int n_eval = std::min(static_cast<int>(tokens.size()) - n_past, static_cast<int>(llama_n_batch(ctx)));
-        llama_batch batch = llama_batch_init(n_eval, 0, 1);
-
-        for (int i = 0; i < n_eval; ++i) {
-            batch.token[i] = tokens[n_past + i];
-            batch.pos[i] = n_past + i;
-            batch.n_seq_id[i] = 1;
-            batch.seq_id[i][0] = 0;
-            batch.logits[i] = (n_past + i == static_cast<int>(tokens.size()) - 1);
-        }
-        batch.n_tokens = n_eval;
-
-        if (llama_decode(ctx, batch) != 0) {
-            ofLogError("ofxLlamaCpp") << "llama_decode failed during prompt processing";
-            llama_batch_free(batch);
-            return false;
-        }
+// Decodes the next chunk of the text prompt into the llama context.
+// Logits are only requested for the last prompt token.
+bool ofxLlamaCpp::decodePromptChunk() {
+    int chunk = static_cast<int>(llama_n_batch(ctx));
+    if (prefillChunkSize > 0) chunk = std::min(chunk, prefillChunkSize);
+
+    const int total = static_cast<int>(promptTokens.size());
+    const int n_eval = std::min(total - n_past, chunk);
+    llama_batch batch = llama_batch_init(n_eval, 0, 1);
+
+    for (int i = 0; i < n_eval; ++i) {
+        batch.token[i] = promptTokens[n_past + i];
+        batch.pos[i] = n_past + i;
+        batch.n_seq_id[i] = 1;
+        batch.seq_id[i][0] = 0;
+        batch.logits[i] = (n_past + i == total - 1);
+    }
+    batch.n_tokens = n_eval;
 
+    if (llama_decode(ctx, batch) != 0) {
+        ofLogError("ofxLlamaCpp") << "llama_decode failed during prompt processing";
         llama_batch_free(batch);
-        n_past += n_eval;
+        return false;
     }
 
+    llama_batch_free(batch);
+    n_past += n_eval;
     return true;
 }
 
@@ -577,12 +1138,16 @@ bool ofxLlamaCpp::processVisionPrompt(const std::string& prompt, const std::stri
 
 // --------------------------------------------------------------
 // The main generation loop, executed in a separate thread.
-// This function handles tokenizing the prompt, processing it, and then
-// iteratively generating new tokens until maxTokens is reached or a stop word is encountered.
+// This function prepares the prompt and then advances the generation step by
+// step until maxTokens is reached, a stop word is encountered or it is stopped.
 void ofxLlamaCpp::generationLoop() {
 
+    // Runs before any compute thread is started, so they all inherit it.
+    applyThreadPolicy();
+
     // Reset the context to clear previous conversation state.
     resetContext();
+    resetGenerationState();
 
     std::string prompt;
     std::string imagePath;
@@ -592,74 +1157,214 @@ void ofxLlamaCpp::generationLoop() {
         imagePath = currentImagePath;
     }
 
-    int n_past = 0;
-    const bool isVisionRun = !imagePath.empty();
-    const bool promptOk = isVisionRun
-        ? processVisionPrompt(prompt, imagePath, n_past)
-        : processTextPrompt(prompt, n_past);
+    if (!imagePath.empty()) {
+        // Image prompts are evaluated in one go by mtmd.
+        if (!processVisionPrompt(prompt, imagePath, n_past)) {
+            finishGeneration(); // Waiters must learn that nothing will arrive
+            return;
+        }
+    } else {
+        promptTokens = tokenize(prompt); // Decoded in chunks by advanceGeneration()
+    }
 
-    if (!promptOk) {
-        generating = false;
-        return;
+    std::string out;
+    while (advanceGeneration(out)) {
+        out.clear(); // Already streamed through pendingOut and the callbacks
     }
+}
 
-    std::string generated; // String to accumulate all generated tokens
+// --------------------------------------------------------------
+// Clears the prompt, position and output of the previous generation.
+void ofxLlamaCpp::resetGenerationState() {
+    promptTokens.clear();
+    n_past = 0;
+    tokensGenerated = 0;
+    generatedText.clear();
+    lastTokenMicros = 0;
+    tokenMicros = 0.0f;
+    sentenceTokens = 0;
+    sentencesFinished = 0;
+    finishedSentenceTokens = 0;
+}
 
-    // Generate new tokens one by one.
-    for (int t = 0; t < max_gen_tokens; t++) {
+// --------------------------------------------------------------
+// Sets the deadline of the generation about to start, counted from now.
+// 0 or less means no deadline.
+void ofxLlamaCpp::setDeadline(float deadlineSeconds) {
+    deadlineMicros = deadlineSeconds > 0.0f
+        ? ofGetElapsedTimeMicros() + static_cast<uint64_t>(deadlineSeconds * 1000000.0f)
+        : 0;
+    adaptiveTokenLimit = max_gen_tokens;
+    decodeTokensPerSecond = 0.0f;
+    stoppedByDeadline = false;
+}
 
-        if (requestStop) break; // Check if a stop request has been made
+// --------------------------------------------------------------
+// Called after each new token. Measures the decode speed and, with a deadline,
+// lowers the token limit to what still fits. At the end of a sentence it
+// stops if another sentence of average length would not fit any more.
+// Returns true if the generation should stop here.
+bool ofxLlamaCpp::checkDeadline() {
+    const uint64_t now = ofGetElapsedTimeMicros();
+
+    // The first interval would include the prompt, so speed is measured from
+    // the second token on.
+    if (lastTokenMicros > 0) {
+        const float interval = static_cast<float>(now - lastTokenMicros);
+        tokenMicros = tokenMicros > 0.0f ? tokenMicros * 0.8f + interval * 0.2f : interval;
+        decodeTokensPerSecond = 1000000.0f / std::max(1.0f, tokenMicros);
+    }
+    lastTokenMicros = now;
+
+    ++sentenceTokens;
+    const bool sentenceEnded = endsSentence(generatedText);
+    if (sentenceEnded) {
+        finishedSentenceTokens += sentenceTokens;
+        ++sentencesFinished;
+        sentenceTokens = 0;
+    }
 
-        // Sample a new token using the configured sampler.
-        llama_token tok = llama_sampler_sample(sampler, ctx, -1);
+    if (deadlineMicros == 0) return false;
+    if (now >= deadlineMicros) return true;
+    if (tokenMicros <= 0.0f) return false; // No speed measured yet
 
-        const llama_vocab* vocab = llama_model_get_vocab(model); // Get vocabulary
-        if (tok == llama_vocab_eos(vocab)) break; // Stop if End-Of-Sentence token is generated
+    // Tokens that still fit, keeping one in reserve for timing noise.
+    const int affordable = static_cast<int>((deadlineMicros - now) / tokenMicros) - 1;
+    adaptiveTokenLimit = std::min(max_gen_tokens, tokensGenerated + std::max(0, affordable));
+    if (affordable <= 0) return true;
 
-        char buf[32]; // Buffer for the token piece
-        int n = llama_token_to_piece(
-            vocab,
-            tok,
-            buf,
-            sizeof(buf),
-            0,
-            false
-        );
+    if (sentenceEnded) {
+        const float averageSentence = static_cast<float>(finishedSentenceTokens) / sentencesFinished;
+        return affordable < averageSentence;
+    }
+    return false;
+}
 
-        std::string piece;
-        if (n > 0) piece.assign(buf, n); // Convert token piece to string
+// --------------------------------------------------------------
+// Returns true if text ends with sentence punctuation or a line break,
+// ignoring closing quotes, brackets and trailing spaces.
+bool ofxLlamaCpp::endsSentence(const std::string& text) {
+    const size_t end = text.find_last_not_of(" \t\r\"')]*");
+    if (end == std::string::npos) return false;
+
+    const char c = text[end];
+    if (c == '.' || c == '!' || c == '?' || c == '\n') return true;
+
+    // Full-width punctuation, e.g. in Chinese and Japanese replies.
+    static const char* wideEnds[] = { "\xE3\x80\x82", "\xEF\xBC\x81", "\xEF\xBC\x9F" }; // 。！？
+    for (const char* wide : wideEnds) {
+        const size_t length = std::strlen(wide);
+        if (end + 1 >= length && text.compare(end + 1 - length, length, wide) == 0) return true;
+    }
+    return false;
+}
 
-        {
-            std::lock_guard<std::mutex> lock(mtx);
-            pendingOut += piece; // Append to pending output (for streaming)
+// --------------------------------------------------------------
+// Runs one step of the current generation: the next chunk of the prompt while
+// it is not fully decoded, afterwards one new token. Returns false when the
+// generation has ended, after telling the listeners.
+bool ofxLlamaCpp::advanceGeneration(std::string& out) {
+    if (requestStop) { // Check if a stop request has been made
+        finishGeneration();
+        return false;
+    }
+
+    if (deadlineMicros > 0 && ofGetElapsedTimeMicros() >= deadlineMicros) {
+        stoppedByDeadline = true;
+        finishGeneration();
+        return false;
+    }
+
+    if (n_past < static_cast<int>(promptTokens.size())) {
+        if (!decodePromptChunk()) {
+            finishGeneration(); // Waiters must learn that nothing will arrive
+            return false;
         }
+        return true;
+    }
 
-        generated += piece; // Append to full generated string
+    if (tokensGenerated >= max_gen_tokens) {
+        finishGeneration();
+        return false;
+    }
 
-        if (checkStopSequences(generated)) break; // Check for stop words
+    // Sample a new token using the configured sampler.
+    llama_token tok = llama_sampler_sample(sampler, ctx, -1);
 
-        // Prepare a new batch for the newly generated token for subsequent decoding.
-        llama_batch bx = llama_batch_init(1, 0, 1);
+    const llama_vocab* vocab = llama_model_get_vocab(model); // Get vocabulary
+    if (tok == llama_vocab_eos(vocab)) { // Stop if End-Of-Sentence token is generated
+        finishGeneration();
+        return false;
+    }
 
-        bx.n_tokens = 1;
-        bx.token[0] = tok;      // The new token
-        bx.pos[0] = n_past;     // Its position in the context
-        bx.n_seq_id[0] = 1;
-        bx.seq_id[0][0] = 0;
-        bx.logits[0] = true;    // Request logits for this token
+    char buf[32]; // Buffer for the token piece
+    int n = llama_token_to_piece(
+        vocab,
+        tok,
+        buf,
+        sizeof(buf),
+        0,
+        false
+    );
 
-        // Decode the new token.
-        if (llama_decode(ctx, bx) != 0) {
-            ofLogError("ofxLlamaCpp") << "llama_decode failed during token processing";
-            llama_batch_free(bx);
-            generating = false;
-            return;
-        }
-        
-        llama_batch_free(bx); // Free batch resources
-        n_past++;             // Increment past token count
+    std::string piece;
+    if (n > 0) piece.assign(buf, n); // Convert token piece to string
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pendingOut += piece; // Append to pending output (for streaming)
+        if (eventDelivery && !piece.empty()) eventQueue.push_back({false, piece}); // For deliverEvents()
+    }
+
+    if (tokenCallback && !piece.empty()) tokenCallback(piece); // Stream the piece to the listener
+
+    out += piece;
+    generatedText += piece; // Append to full generated string
+    tokensGenerated++;
+
+    if (checkStopSequences(generatedText)) { // Check for stop words
+        finishGeneration();
+        return false;
     }
 
-    generating = false; // Mark generation as complete
-    if (finishCallback) finishCallback(); // Call the finish callback if set
+    if (checkDeadline()) { // Stop early to finish within the deadline
+        stoppedByDeadline = true;
+        finishGeneration();
+        return false;
+    }
+
+    // Prepare a new batch for the newly generated token for subsequent decoding.
+    llama_batch bx = llama_batch_init(1, 0, 1);
+
+    bx.n_tokens = 1;
+    bx.token[0] = tok;      // The new token
+    bx.pos[0] = n_past;     // Its position in the context
+    bx.n_seq_id[0] = 1;
+    bx.seq_id[0][0] = 0;
+    bx.logits[0] = true;    // Request logits for this token
+
+    // Decode the new token.
+    if (llama_decode(ctx, bx) != 0) {
+        ofLogError("ofxLlamaCpp") << "llama_decode failed during token processing";
+        llama_batch_free(bx);
+        finishGeneration();
+        return false;
+    }
+
+    llama_batch_free(bx); // Free batch resources
+    n_past++;             // Increment past token count
+    return true;
+}
+
+// --------------------------------------------------------------
+// Ends a generation: clears the generating flags, queues finishEvent if event
+// delivery is on, and calls the finish callback if set.
+void ofxLlamaCpp::finishGeneration() {
+    cooperative = false;
+    generating = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (eventDelivery) eventQueue.push_back({true, std::string()});
+    }
+    if (finishCallback) finishCallback();
 }
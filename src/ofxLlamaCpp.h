@@ -22,6 +22,7 @@
 #include <vector>     // For dynamic arrays
 #include <string>     // For string manipulation
 #include <functional> // For std::function callbacks
+#include <atomic>     // For values read while the generation thread writes them
 
 // The main class for interacting with Llama models in OpenFrameworks.
 class ofxLlamaCpp {
@@ -63,21 +64,104 @@ public:
     // Returns whether K, Q, V tensors are offloaded to the GPU.
     bool getOffloadKqv() const;
 
+    // Distributes the model across ggml RPC workers ("host:port", e.g. rpc-server
+    // started by scripts/start_rpc_workers.sh). Takes effect on the next
+    // loadModel(): layers are split across the workers and any local GPU,
+    // proportionally to their free memory unless setTensorSplit() says otherwise.
+    // Requires the libraries to be built with RPC support (install_llama.py --enable-rpc).
+    void setRpcServers(const std::vector<std::string>& servers);
+    const std::vector<std::string>& getRpcServers() const;
+    // Relative share of the layers per device, in the order workers then local GPU.
+    // Empty (the default) splits by free memory.
+    void setTensorSplit(const std::vector<float>& split);
+
+    // -----------------------------
+    // Thread Priority
+    // -----------------------------
+    // OS scheduling of the generation thread and the compute threads it
+    // starts, so that inference yields the CPU to the render thread.
+    //   NORMAL: like the app (default).
+    //   LOW:    lower priority (nice 10 on Linux, utility QoS on macOS,
+    //           below normal on Windows).
+    //   IDLE:   only runs when a core is otherwise idle (SCHED_IDLE on Linux,
+    //           background QoS on macOS, idle priority on Windows).
+    // Applies from the next startGeneration(); step() runs on the caller's
+    // thread and is not affected. On Windows the compute threads do not
+    // inherit it, so only the generation thread itself is lowered.
+    enum class ThreadPriority { NORMAL, LOW, IDLE };
+    void setThreadPriority(ThreadPriority priority);
+    ThreadPriority getThreadPriority() const;
+    // Keeps the first `cores` CPU cores free of inference: fewer compute threads
+    // are used, and on Linux they are pinned to the other cores.
+    void setReservedCores(int cores);
+    int getReservedCores() const;
+    // Compute threads for decoding; 0 (default) uses every core not reserved.
+    void setThreadCount(int threads);
+    // The number of compute threads that decoding will use.
+    int getThreadCount() const;
+
 
     // -----------------------------
     // Generation Control
     // -----------------------------
     // Starts asynchronous text generation based on the given prompt.
     // maxTokens specifies the maximum number of new tokens to generate.
-    void startGeneration(const std::string &prompt, int maxTokens = 200);
+    // deadlineSeconds, if above 0, is the time from this call by which the
+    // reply must be complete: the token limit shrinks to what the measured
+    // decode speed allows, and near the end the reply stops after the last
+    // sentence that fits, or cut off at the deadline if none does.
+    void startGeneration(const std::string &prompt, int maxTokens = 200, float deadlineSeconds = 0.0f);
     // Starts asynchronous multimodal generation with one image file.
-    void startVisionGeneration(const std::string &prompt, const std::string &imagePath, int maxTokens = 200);
+    void startVisionGeneration(const std::string &prompt, const std::string &imagePath, int maxTokens = 200,
+                               float deadlineSeconds = 0.0f);
     // Requests to stop the current asynchronous generation.
     void stopGeneration();
     // Checks if text generation is currently in progress.
     bool isGenerating() const;
     // Retrieves newly generated output tokens. Useful for streaming results.
     std::string getNewOutput();
+    // Token limit of the current or last generation: maxTokens, lowered as
+    // the deadline approaches.
+    int getAdaptiveTokenLimit() const;
+    // Decode speed measured during the current or last generation.
+    float getDecodeTokensPerSecond() const;
+    // True if the last generation ended early because of its deadline.
+    bool wasStoppedByDeadline() const;
+
+    // -----------------------------
+    // Cooperative Generation
+    // -----------------------------
+    // Prepares a text generation that runs on the caller's thread instead of
+    // a worker thread, so frames stay deterministic and several engines can be
+    // interleaved by hand. Nothing is computed until step() or stepFor().
+    // Returns false if no model is loaded.
+    bool beginGeneration(const std::string &prompt, int maxTokens = 200, float deadlineSeconds = 0.0f);
+    // Runs up to maxSteps steps and returns the text they generated. A step
+    // is one prompt chunk (see setPrefillChunkSize) or one new token.
+    // Callbacks, events and getNewOutput() see the text as well.
+    std::string step(int maxSteps = 1);
+    // Runs steps until the time budget is spent, at least one.
+    std::string stepFor(float milliseconds);
+    // Prompt tokens decoded per step; 0 uses the context's batch size.
+    void setPrefillChunkSize(int tokens);
+
+    // -----------------------------
+    // Blocking Generation
+    // -----------------------------
+    // Result of generateBlocking().
+    struct BlockingResult {
+        std::string text;
+        int tokens = 0;           // Tokens generated, including any not delivered
+        bool interrupted = false; // Ended by onPiece or shouldStop, not by the model
+    };
+    // Runs startGeneration() and waits for it, handing new text to onPiece on
+    // the calling thread, so a slow onPiece never holds up the model. onPiece
+    // returns false to stop early; shouldStop is polled at least every 20 ms.
+    // Takes over the token and finish callbacks until it returns, so calls
+    // must not overlap. For request handlers such as LlamaOpenAIServer.
+    BlockingResult generateBlocking(const std::string &prompt, int maxTokens,
+                                    const std::function<bool(const std::string &)> &onPiece,
+                                    const std::function<bool()> &shouldStop = nullptr);
 
     // -----------------------------
     // Stop Sequences
@@ -97,6 +181,14 @@ public:
     // Converts a vector of Llama tokens back into a string of text.
     std::string detokenize(const std::vector<llama_token> &tokens) const;
 
+    // -----------------------------
+    // Embeddings
+    // -----------------------------
+    // Computes an L2-normalized embedding of text: the model's pooled output, or
+    // the mean of its token embeddings for models without pooling. Text longer
+    // than one batch is truncated. Must not be called while generating.
+    bool getEmbedding(const std::string &text, std::vector<float> &embedding);
+
     // -----------------------------
     // Context Reset (SAFE VERSION)
     // -----------------------------
@@ -131,9 +223,31 @@ public:
     // Callbacks
     // -----------------------------
     // Sets a callback function that is called whenever a new token is generated.
+    // Both callbacks run on the generation thread; set them while no generation is running.
     void setTokenCallback(std::function<void(const std::string &)> fn);
-    // Sets a callback function that is called when text generation finishes.
+    // Sets a callback function that is called when text generation finishes or fails.
     void setFinishCallback(std::function<void()> fn);
+    // Return the callbacks currently set, so helpers can chain onto them.
+    std::function<void(const std::string &)> getTokenCallback() const;
+    std::function<void()> getFinishCallback() const;
+
+    // -----------------------------
+    // Main-Thread Events
+    // -----------------------------
+    // Delivers tokens through tokenEvent and finishEvent on the main thread,
+    // from ofEvents().update just before ofApp::update(). Queued pieces are
+    // notified one at a time until the frame budget is spent; the rest of the
+    // frame's pieces then arrive as one coalesced piece, so a fast model neither
+    // stalls the frame nor builds up a backlog. Call from the main thread.
+    void setEventDelivery(bool enabled);
+    bool getEventDelivery() const;
+    // Time per frame for tokenEvent listeners, in milliseconds (default 2).
+    void setEventFrameBudget(float milliseconds);
+
+    // Notified with each new piece of text while event delivery is enabled.
+    ofEvent<std::string> tokenEvent;
+    // Notified after the last piece when a generation finishes or fails.
+    ofEvent<void> finishEvent;
 
     // -----------------------------
     // Chat API
@@ -155,13 +269,36 @@ private:
     // Internal function to build and configure the Llama sampler.
     void buildSampler();
     bool initializeContext(int n_ctx_req);
+    // Connects to the RPC workers and appends one device per worker device.
+    bool addRpcDevices(std::vector<ggml_backend_dev_t> &devices);
     std::string formatVisionPrompt(const std::string &prompt) const;
-    bool processTextPrompt(const std::string &prompt, int &n_past);
     bool processVisionPrompt(const std::string &prompt, const std::string &imagePath, int &n_past);
+    // Clears the state of the previous generation before a new one.
+    void resetGenerationState();
+    // Runs one step of the current generation: a chunk of the prompt or one
+    // new token, whose text is appended to out. Returns false once it ended.
+    bool advanceGeneration(std::string &out);
+    bool decodePromptChunk();
     // The main loop for asynchronous text generation, run in a separate thread.
     void generationLoop();
     // Checks if any of the defined stop sequences have been generated.
     bool checkStopSequences(const std::string& s);
+    // Applies the thread priority and reserved cores to the calling thread,
+    // which the compute threads it starts inherit.
+    void applyThreadPolicy();
+    // Passes the thread count to the context, if there is one.
+    void updateContextThreads();
+    // Sets the deadline of the next generation, counted from now.
+    void setDeadline(float deadlineSeconds);
+    // Updates the decode speed after a new token and decides whether the
+    // deadline asks to stop here.
+    bool checkDeadline();
+    // Whether text ends a sentence, so stopping there reads as complete.
+    static bool endsSentence(const std::string &text);
+    // Marks the generation as done and tells the callback and event listeners.
+    void finishGeneration();
+    // Drains the event queue on the main thread, see setEventDelivery().
+    void deliverEvents(ofEventArgs &args);
 
 private:
     // Pointers to the Llama model and context, managed by the Llama.cpp library.
@@ -205,6 +342,25 @@ private:
     float presence_penalty = 0.0f;
     float frequency_penalty = 0.0f;
 
+    // State of the current generation, advanced by the worker thread or step().
+    std::vector<llama_token> promptTokens; // Text prompt; the first n_past are decoded
+    int n_past = 0;                        // Tokens in the context
+    int tokensGenerated = 0;
+    std::string generatedText;             // Checked against the stop words
+    bool cooperative = false;              // Started by beginGeneration()
+    int prefillChunkSize = 0;
+
+    // Deadline of the current generation, 0 for none (ofGetElapsedTimeMicros()).
+    uint64_t deadlineMicros = 0;
+    uint64_t lastTokenMicros = 0;
+    float tokenMicros = 0.0f;          // Smoothed time per token, 0 until measured
+    int sentenceTokens = 0;            // Tokens since the last sentence ended
+    int sentencesFinished = 0;
+    int finishedSentenceTokens = 0;
+    std::atomic<int> adaptiveTokenLimit{0};
+    std::atomic<float> decodeTokensPerSecond{0.0f};
+    std::atomic<bool> stoppedByDeadline{false};
+
     // Minimum and maximum tokens to generate in a single call.
     int min_gen_tokens = 0;
     int max_gen_tokens = 200;
@@ -219,9 +375,26 @@ private:
     std::function<void(const std::string&)> tokenCallback;
     std::function<void()> finishCallback;
 
+    // Pieces waiting for the main thread, guarded by mtx. An entry with
+    // finished set marks the end of a generation.
+    struct QueuedEvent {
+        bool finished;
+        std::string text;
+    };
+    std::vector<QueuedEvent> eventQueue;
+    bool eventDelivery = false;
+    float eventFrameBudget = 2.0f; // Milliseconds per frame
+
     int n_gpu_layers = 0; // Number of layers to offload to the GPU
     bool offload_kqv = true; // Offload K, Q, V tensors to the GPU by default
 
     ggml_backend_t cpu_backend = nullptr;
     ggml_backend_t cuda_backend = nullptr;
+
+    std::vector<std::string> rpcServers; // ggml RPC workers used by loadModel()
+    std::vector<float> tensorSplit; // Per-device layer shares, empty for automatic
+
+    ThreadPriority threadPriority = ThreadPriority::NORMAL;
+    int reservedCores = 0;
+    int threadCount = 0; // 0: every core not reserved
 };